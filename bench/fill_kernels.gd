@@ -0,0 +1,52 @@
+# Compares the vertex format specialized kernels against the generic ones that
+# check every attribute of every vertex. Run it from a project with the extension
+# installed:
+#
+#   godot --headless --script res://bench/fill_kernels.gd
+extends SceneTree
+
+const ITERATIONS = 20
+const RADIAL_SEGMENTS = 256
+const RINGS = 128
+
+func make_mesh(with_tangents: bool) -> ArrayMesh:
+	var sphere = SphereMesh.new()
+	sphere.radial_segments = RADIAL_SEGMENTS
+	sphere.rings = RINGS
+
+	var arrays = sphere.get_mesh_arrays()
+	if not with_tangents:
+		arrays[Mesh.ARRAY_TANGENT] = null
+
+	var mesh = ArrayMesh.new()
+	mesh.add_surface_from_arrays(Mesh.PRIMITIVE_TRIANGLES, arrays)
+	return mesh
+
+func time_slices(mesh: ArrayMesh, specialized: bool) -> float:
+	var slicer = Slicer.new()
+	slicer.specialized_kernels = specialized
+
+	var plane = Plane(Vector3(0.3, 1, 0.2).normalized(), 0.1)
+	var start = Time.get_ticks_usec()
+	for i in ITERATIONS:
+		slicer.slice_by_plane(mesh, plane, null)
+
+	return float(Time.get_ticks_usec() - start) / ITERATIONS / 1000.0
+
+func _init():
+	for with_tangents in [false, true]:
+		var mesh = make_mesh(with_tangents)
+		var triangles = mesh.surface_get_array_index_len(0) / 3
+
+		var generic = time_slices(mesh, false)
+		var specialized = time_slices(mesh, true)
+
+		print("%s, %d triangles: generic %.3f ms, specialized %.3f ms (%.2fx)" % [
+			"pos+normal+uv+tangent" if with_tangents else "pos+normal+uv",
+			triangles,
+			generic,
+			specialized,
+			generic / specialized,
+		])
+
+	quit()
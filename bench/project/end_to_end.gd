@@ -0,0 +1,259 @@
+# Slices a handful of typical meshes over and over through the engine, covering
+# everything the native benchmarks can't: add_surface_from_arrays, assigning the
+# cross section material, building collision shapes, adding the halves to the
+# scene and the RefCounted churn of it all. Needs neither a GPU nor the network,
+# build the extension first and run it from the repo root with
+#
+#   godot --headless --path bench/project --script res://end_to_end.gd -- --output "$PWD/e2e.json"
+#
+# Every scenario runs one slice per frame and reports the percentiles of how long
+# that frame's slicing took along with slices per second, as JSON on stdout and in
+# the --output file if given. --iterations changes how many slices each one runs.
+extends SceneTree
+
+const DEFAULT_ITERATIONS = 200
+const WARMUP_ITERATIONS = 5
+
+var iterations = DEFAULT_ITERATIONS
+var output_path = ""
+
+var cross_section_material = StandardMaterial3D.new()
+
+func make_crate() -> ArrayMesh:
+	var box = BoxMesh.new()
+	box.size = Vector3(1, 1, 1)
+	box.subdivide_width = 8
+	box.subdivide_height = 8
+	box.subdivide_depth = 8
+	return to_array_mesh(box.get_mesh_arrays())
+
+# A sphere pushed in and out by noise, always the same one
+func make_rock() -> ArrayMesh:
+	var sphere = SphereMesh.new()
+	sphere.radius = 0.5
+	sphere.height = 1.0
+	sphere.radial_segments = 64
+	sphere.rings = 32
+
+	var noise = FastNoiseLite.new()
+	noise.seed = 1234
+	noise.frequency = 1.5
+
+	var arrays = sphere.get_mesh_arrays()
+	var vertices: PackedVector3Array = arrays[Mesh.ARRAY_VERTEX]
+	var normals: PackedVector3Array = arrays[Mesh.ARRAY_NORMAL]
+	for i in vertices.size():
+		var point = vertices[i]
+		vertices[i] = point + normals[i] * noise.get_noise_3dv(point * 2.0) * 0.15
+	arrays[Mesh.ARRAY_VERTEX] = vertices
+
+	return to_array_mesh(arrays)
+
+func make_torus() -> ArrayMesh:
+	var torus = TorusMesh.new()
+	torus.inner_radius = 0.3
+	torus.outer_radius = 0.5
+	torus.rings = 64
+	torus.ring_segments = 32
+	return to_array_mesh(torus.get_mesh_arrays())
+
+# A capsule standing in for a character, skinned to a spine of four bones and left
+# in its rest pose, so every vertex carries bones and weights
+func make_character() -> ArrayMesh:
+	var capsule = CapsuleMesh.new()
+	capsule.radius = 0.3
+	capsule.height = 1.8
+	capsule.radial_segments = 48
+	capsule.rings = 32
+
+	var arrays = capsule.get_mesh_arrays()
+	var vertices: PackedVector3Array = arrays[Mesh.ARRAY_VERTEX]
+	var bones = PackedInt32Array()
+	var weights = PackedFloat32Array()
+	bones.resize(vertices.size() * 4)
+	weights.resize(vertices.size() * 4)
+
+	for i in vertices.size():
+		# Blends between the two bones nearest the vertex along the spine
+		var along = clamp((vertices[i].y / capsule.height + 0.5) * 3.0, 0.0, 2.999)
+		var bone = int(along)
+		var blend = along - bone
+		bones[i * 4] = bone
+		bones[i * 4 + 1] = bone + 1
+		weights[i * 4] = 1.0 - blend
+		weights[i * 4 + 1] = blend
+
+	arrays[Mesh.ARRAY_BONES] = bones
+	arrays[Mesh.ARRAY_WEIGHTS] = weights
+	return to_array_mesh(arrays)
+
+func to_array_mesh(arrays: Array) -> ArrayMesh:
+	var mesh = ArrayMesh.new()
+	mesh.add_surface_from_arrays(Mesh.PRIMITIVE_TRIANGLES, arrays)
+	mesh.surface_set_material(0, StandardMaterial3D.new())
+	return mesh
+
+func triangle_count(mesh: ArrayMesh) -> int:
+	var count = 0
+	for i in mesh.get_surface_count():
+		var indices = mesh.surface_get_array_index_len(i)
+		count += (indices if indices > 0 else mesh.surface_get_array_len(i)) / 3
+	return count
+
+# A different plane through the middle of the mesh every iteration, the same ones every run
+func plane_for(iteration: int) -> Plane:
+	var angle = iteration * 0.7
+	var normal = Vector3(cos(angle), 1.0, sin(angle)).normalized()
+	return Plane(normal, 0.05 * sin(iteration * 1.3))
+
+# Puts the halves in the scene the way a game would, freeing whatever the last
+# iteration added
+func place_halves(sliced, with_bodies: bool, holder: Node3D) -> void:
+	for child in holder.get_children():
+		child.queue_free()
+
+	if sliced == null:
+		return
+
+	var meshes = [sliced.upper_mesh, sliced.lower_mesh]
+	var shapes = [sliced.upper_shape, sliced.lower_shape] if with_bodies else [null, null]
+	for i in 2:
+		var instance = MeshInstance3D.new()
+		instance.mesh = meshes[i]
+
+		if with_bodies:
+			var body = RigidBody3D.new()
+			var collision = CollisionShape3D.new()
+			collision.shape = shapes[i]
+			body.add_child(collision)
+			body.add_child(instance)
+			holder.add_child(body)
+		else:
+			holder.add_child(instance)
+
+# The extension's classes are only looked up once it's known to have loaded, see _initialize
+func make_slicer(scenario: String) -> RefCounted:
+	var slicer = ClassDB.instantiate("Slicer")
+	if scenario == "physics":
+		slicer.build_collision_hulls = true
+		slicer.hull_vertex_budget = 64
+		slicer.compute_mass_properties = true
+	return slicer
+
+# Slices the mesh once in the given scenario, returning how long it took in usec
+func run_iteration(slicer, mesh: ArrayMesh, scenario: String, iteration: int, holder: Node3D) -> int:
+	var start = Time.get_ticks_usec()
+	var sliced
+
+	if scenario == "async":
+		var job = slicer.slice_async(mesh, plane_for(iteration), cross_section_material)
+		sliced = await job.completed
+	else:
+		sliced = slicer.slice_by_plane(mesh, plane_for(iteration), cross_section_material)
+
+	place_halves(sliced, scenario == "physics", holder)
+	return Time.get_ticks_usec() - start
+
+func percentile(sorted: Array, fraction: float) -> float:
+	var index = clamp(int(ceil(fraction * sorted.size())) - 1, 0, sorted.size() - 1)
+	return sorted[index]
+
+func run_scenario(mesh_name: String, mesh: ArrayMesh, scenario: String) -> Dictionary:
+	var slicer = make_slicer(scenario)
+	var holder = Node3D.new()
+	root.add_child(holder)
+
+	for i in WARMUP_ITERATIONS:
+		await run_iteration(slicer, mesh, scenario, i, holder)
+		await process_frame
+
+	var samples = []
+	var total_usec = 0
+	for i in iterations:
+		var usec = await run_iteration(slicer, mesh, scenario, i, holder)
+		samples.append(usec / 1000.0)
+		total_usec += usec
+
+		# One slice a frame, like a game would, which also lets the freed halves go
+		await process_frame
+
+	holder.queue_free()
+	samples.sort()
+
+	return {
+		"mesh": mesh_name,
+		"scenario": scenario,
+		"triangles": triangle_count(mesh),
+		"iterations": iterations,
+		"p50_msec": percentile(samples, 0.5),
+		"p90_msec": percentile(samples, 0.9),
+		"p99_msec": percentile(samples, 0.99),
+		"max_msec": samples[-1],
+		"mean_msec": total_usec / 1000.0 / iterations,
+		"slices_per_second": iterations * 1000000.0 / max(total_usec, 1),
+	}
+
+func parse_args() -> bool:
+	var args = OS.get_cmdline_user_args()
+	var i = 0
+	while i < args.size():
+		if args[i] == "--iterations" and i + 1 < args.size():
+			iterations = int(args[i + 1])
+			i += 1
+		elif args[i] == "--output" and i + 1 < args.size():
+			output_path = args[i + 1]
+			i += 1
+		else:
+			printerr("usage: godot --headless --path bench/project --script res://end_to_end.gd -- [--iterations n] [--output path]")
+			return false
+		i += 1
+
+	return iterations > 0
+
+func _initialize():
+	if not parse_args():
+		quit(1)
+		return
+
+	if not ClassDB.class_exists("Slicer"):
+		printerr("The Slicer extension didn't load, build it with scons first")
+		quit(1)
+		return
+
+	run()
+
+func run():
+	var meshes = {
+		"crate": make_crate(),
+		"rock": make_rock(),
+		"torus": make_torus(),
+		"character": make_character(),
+	}
+
+	var results = []
+	for mesh_name in meshes:
+		for scenario in ["slice", "physics", "async"]:
+			var result = await run_scenario(mesh_name, meshes[mesh_name], scenario)
+			results.append(result)
+			printerr("%-10s %-8s p50 %.3f ms, p99 %.3f ms, %.0f slices/s" % [
+				mesh_name, scenario, result.p50_msec, result.p99_msec, result.slices_per_second,
+			])
+
+	var report = {
+		"format": 1,
+		"godot_version": Engine.get_version_info().string,
+		"processor_count": OS.get_processor_count(),
+		"results": results,
+	}
+	var json = JSON.stringify(report, "  ")
+	print(json)
+
+	if output_path != "":
+		var file = FileAccess.open(output_path, FileAccess.WRITE)
+		if file == null:
+			printerr("Couldn't open %s for writing" % output_path)
+			quit(1)
+			return
+		file.store_string(json + "\n")
+
+	quit()
@@ -0,0 +1,247 @@
+// Plays back a capture recorded with Slicer::start_recording against whatever the core looks
+// like now, without the game that recorded it, reporting how long each call took and how many
+// triangles it made. Builds against the standalone core alongside slicer_bench:
+//
+//   scons bench=yes
+//   bin/slice_replay capture.slices --output replay.json
+//
+// Running the same capture before and after a change shows which of the game's own slices it
+// sped up or slowed down, and --first/--last narrow a replay down to the calls in question.
+
+#include "core/slicer_core.h"
+#include "utils/slice_capture.h"
+#include "utils/slice_timings.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+    struct Options {
+        std::string capture;
+        std::string output;
+        int repeats = 5;
+        int first = 0;
+        int last = -1;
+    };
+
+    /**
+     * Reusable state for playing back calls, the same as a Slicer's SliceWorkspace holds
+    */
+    struct Pipeline {
+        LocalVector<Intersector::SplitResult> split_results;
+        Intersector::ParallelWorkspace parallel;
+        LocalVector<Vector3> points;
+        LocalVector<Vector3> segments;
+        Triangulator::Workspace triangulator;
+        MeshBuffer cross_section;
+        MeshBuffer halves[4];
+    };
+
+    struct CallResult {
+        std::vector<double> split_usec;
+        std::vector<double> cap_usec;
+        std::vector<double> extract_usec;
+        std::vector<double> total_usec;
+
+        int input_triangles = 0;
+        int output_triangles = 0;
+        int intersection_points = 0;
+    };
+
+    /**
+     * Slices the call's mesh once, the way the Slicer that recorded it would have. Only the
+     * slicing itself is timed, copying the mesh in stands in for parsing it out of the engine
+    */
+    void replay_call(const SliceCapture::Capture &capture, const SliceCapture::Call &call, Pipeline &pipeline, CallResult &r_result) {
+        const LocalVector<MeshBuffer> &surfaces = capture.meshes[call.mesh];
+        bool specialized = call.flags & SliceCapture::FLAG_SPECIALIZED_KERNELS;
+
+        pipeline.split_results.resize(surfaces.size());
+        for (uint32_t i = 0; i < surfaces.size(); i++) {
+            pipeline.split_results[i].reset();
+            pipeline.split_results[i].surface = surfaces[i];
+        }
+
+        SliceTimings timings;
+        uint64_t start = SliceTimings::now_usec();
+
+        // Without Godot there are no BVHs to go through, so captures made with use_bvh on get
+        // split the plain way
+        if (call.flags & SliceCapture::FLAG_PARALLEL) {
+            Intersector::split_surfaces_by_plane_parallel(call.plane, pipeline.split_results.ptr(), surfaces.size(), specialized, &pipeline.parallel, &timings);
+        } else {
+            for (uint32_t i = 0; i < surfaces.size(); i++) {
+                Intersector::split_surface_by_plane(call.plane, pipeline.split_results[i], specialized);
+            }
+        }
+
+        uint64_t split_end = SliceTimings::now_usec();
+
+        pipeline.points.clear();
+        pipeline.segments.clear();
+        for (uint32_t i = 0; i < surfaces.size(); i++) {
+            const Intersector::SplitResult &split = pipeline.split_results[i];
+            for (uint32_t j = 0; j < split.intersection_points.size(); j++) {
+                pipeline.points.push_back(split.intersection_points[j]);
+            }
+            for (uint32_t j = 0; j < split.cut_segments.size(); j++) {
+                pipeline.segments.push_back(split.cut_segments[j]);
+            }
+        }
+
+        pipeline.cross_section.clear();
+        if (pipeline.points.size() > 0 || pipeline.segments.size() > 0) {
+            Triangulator::cap(pipeline.segments, pipeline.points, call.plane.normal, pipeline.triangulator, pipeline.cross_section);
+        }
+
+        uint64_t cap_end = SliceTimings::now_usec();
+
+        // Stands in for SurfaceFiller the same way slicer_bench does
+        int output_triangles = 0;
+        for (uint32_t i = 0; i < surfaces.size(); i++) {
+            const Intersector::SplitResult &split = pipeline.split_results[i];
+            pipeline.halves[0].extract(split.surface, split.upper_indices);
+            pipeline.halves[2].extract(split.surface, split.lower_indices);
+            output_triangles += (split.upper_indices.size() + split.lower_indices.size()) / 3;
+        }
+        pipeline.halves[1].extract(pipeline.cross_section, pipeline.cross_section.indices, true);
+        pipeline.halves[3].extract(pipeline.cross_section, pipeline.cross_section.indices);
+        output_triangles += pipeline.cross_section.face_count() * 2;
+
+        uint64_t end = SliceTimings::now_usec();
+
+        r_result.split_usec.push_back(split_end - start);
+        r_result.cap_usec.push_back(cap_end - split_end);
+        r_result.extract_usec.push_back(end - cap_end);
+        r_result.total_usec.push_back(end - start);
+
+        r_result.input_triangles = 0;
+        for (uint32_t i = 0; i < surfaces.size(); i++) {
+            r_result.input_triangles += surfaces[i].face_count();
+        }
+        r_result.output_triangles = output_triangles;
+        r_result.intersection_points = pipeline.points.size();
+    }
+
+    double median(std::vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        size_t middle = samples.size() / 2;
+        return samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) * 0.5;
+    }
+
+    bool parse_options(int argc, char **argv, Options &r_options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+
+            if (arg == "--output" && has_value) {
+                r_options.output = argv[++i];
+            } else if (arg == "--repeats" && has_value) {
+                r_options.repeats = atoi(argv[++i]);
+            } else if (arg == "--first" && has_value) {
+                r_options.first = atoi(argv[++i]);
+            } else if (arg == "--last" && has_value) {
+                r_options.last = atoi(argv[++i]);
+            } else if (r_options.capture.empty() && arg[0] != '-') {
+                r_options.capture = arg;
+            } else {
+                r_options.capture.clear();
+                break;
+            }
+        }
+
+        if (r_options.capture.empty()) {
+            fprintf(stderr,
+                    "usage: %s capture [--output path] [--repeats n] [--first call] [--last call]\n"
+                    "  replays the calls of a capture made with Slicer.start_recording, --first and --last are inclusive\n",
+                    argv[0]);
+            return false;
+        }
+
+        return r_options.repeats > 0 && r_options.first >= 0;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    // A game that crashed mid recording leaves the last record cut short, everything before
+    // it is still worth playing back
+    SliceCapture::Capture capture;
+    bool complete = SliceCapture::read(options.capture.c_str(), capture);
+    if (capture.calls.size() == 0) {
+        fprintf(stderr, "%s isn't a slice capture, or has no calls in it\n", options.capture.c_str());
+        return 1;
+    }
+    if (!complete) {
+        fprintf(stderr, "%s is cut short or corrupted, replaying the %u calls before that\n", options.capture.c_str(), capture.calls.size());
+    }
+
+    int call_count = capture.calls.size();
+    int last = options.last < 0 ? call_count - 1 : MIN(options.last, call_count - 1);
+
+    printf("%u meshes, %u materials, %d calls\n", capture.meshes.size(), capture.materials.size(), call_count);
+    printf("%-6s %-6s %-10s %-10s %-8s %10s %10s %10s %10s   (median ms)\n", "call", "mesh", "in_tris", "out_tris", "points", "split", "cap", "extract", "total");
+
+    Pipeline pipeline;
+    std::vector<CallResult> results(MAX(last - options.first + 1, 0));
+    double total_msec = 0;
+
+    for (int i = options.first; i <= last; i++) {
+        const SliceCapture::Call &call = capture.calls[i];
+        CallResult &result = results[i - options.first];
+
+        // One run to warm up the caches and grow the buffers, which then get reused
+        CallResult warmup;
+        replay_call(capture, call, pipeline, warmup);
+
+        for (int j = 0; j < options.repeats; j++) {
+            replay_call(capture, call, pipeline, result);
+        }
+
+        double call_msec = median(result.total_usec) / 1000.0;
+        total_msec += call_msec;
+
+        printf("%-6d %-6u %-10d %-10d %-8d %10.3f %10.3f %10.3f %10.3f\n", i, call.mesh, result.input_triangles, result.output_triangles, result.intersection_points,
+                median(result.split_usec) / 1000.0, median(result.cap_usec) / 1000.0, median(result.extract_usec) / 1000.0, call_msec);
+        fflush(stdout);
+    }
+
+    printf("Replayed %d calls in %.3f ms\n", (int)results.size(), total_msec);
+
+    if (options.output.empty()) {
+        return 0;
+    }
+
+    FILE *file = fopen(options.output.c_str(), "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Couldn't open %s for writing\n", options.output.c_str());
+        return 1;
+    }
+
+    fprintf(file, "{\n  \"format\": 1,\n  \"capture\": \"%s\",\n  \"real_t_bytes\": %d,\n  \"repeats\": %d,\n  \"total_msec\": %.4f,\n  \"calls\": [\n",
+            options.capture.c_str(), int(sizeof(real_t)), options.repeats, total_msec);
+
+    for (int i = options.first; i <= last; i++) {
+        const SliceCapture::Call &call = capture.calls[i];
+        const CallResult &result = results[i - options.first];
+
+        fprintf(file, "    {\"call\": %d, \"mesh\": %u, \"material\": %d, \"flags\": %u, \"recorded_at_usec\": %llu, ",
+                i, call.mesh, call.material, call.flags, (unsigned long long)call.time_usec);
+        fprintf(file, "\"input_triangles\": %d, \"output_triangles\": %d, \"intersection_points\": %d, ",
+                result.input_triangles, result.output_triangles, result.intersection_points);
+        fprintf(file, "\"split_msec\": %.4f, \"cap_msec\": %.4f, \"extract_msec\": %.4f, \"total_msec\": %.4f}%s\n",
+                median(result.split_usec) / 1000.0, median(result.cap_usec) / 1000.0, median(result.extract_usec) / 1000.0,
+                median(result.total_usec) / 1000.0, i == last ? "" : ",");
+    }
+
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+
+    printf("Wrote %s\n", options.output.c_str());
+    return 0;
+}
@@ -0,0 +1,459 @@
+// Times each stage of a slice on its own, over synthetic icospheres of 1k to 1M faces, indexed
+// and not, carrying anything from bare positions up to every stream a skinned mesh can have.
+// Builds against the standalone core, so no Godot is needed:
+//
+//   scons bench=yes
+//   bin/slicer_bench --output bench_results.json
+//
+// Every result gets written to the JSON file in ns per face and faces per second of the mesh
+// being sliced, so two runs can be diffed stage by stage. Splitting is timed with the kernels
+// specialized for the mesh's vertex format and with the generic ones side by side.
+
+#include "core/slicer_core.h"
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+namespace {
+    struct Attributes {
+        const char *name;
+        bool normals;
+        bool tangents;
+        bool colors;
+        bool skinned;
+        bool uvs;
+        bool uv2s;
+    };
+
+    const Attributes ATTRIBUTE_SETS[] = {
+        { "position", false, false, false, false, false, false },
+        { "position_normal", true, false, false, false, false, false },
+        { "position_normal_uv", true, false, false, false, true, false },
+        { "position_normal_uv_tangent", true, true, false, false, true, false },
+        { "skinned", true, true, false, true, true, false },
+        { "full", true, true, true, true, true, true },
+    };
+
+    struct PlaneCase {
+        const char *name;
+        real_t normal[3];
+        real_t d;
+    };
+
+    // Through the middle along an axis and diagonally, and one grazing the top of the sphere
+    // where only a small ring of faces gets cut
+    const PlaneCase PLANES[] = {
+        { "axis_x", { 1, 0, 0 }, 0 },
+        { "axis_y", { 0, 1, 0 }, 0 },
+        { "diagonal", { 1, 1, 1 }, 0 },
+        { "grazing", { 0.3, 1, 0.2 }, 0.9 },
+    };
+
+    enum Stage {
+        STAGE_LOAD,
+        STAGE_SPLIT,
+        STAGE_SPLIT_GENERIC,
+        STAGE_MONOTONE_CHAIN,
+        STAGE_CAP,
+        STAGE_EXTRACT,
+        STAGE_MAX,
+    };
+
+    const char *STAGE_NAMES[STAGE_MAX] = {
+        "load_mesh",
+        "split_surface_by_plane",
+        "split_generic",
+        "monotone_chain",
+        "cap",
+        "extract",
+    };
+
+    struct Options {
+        int min_subdivisions = 3;
+        int max_subdivisions = 8;
+        int repeats = 5;
+        std::string output = "bench_results.json";
+    };
+
+    /**
+     * A unit icosphere with every stream filled in, the MeshView for each attribute set just
+     * leaves out the ones it doesn't carry
+    */
+    struct Icosphere {
+        std::vector<real_t> positions;
+        std::vector<real_t> normals;
+        std::vector<real_t> tangents;
+        std::vector<float> colors;
+        std::vector<real_t> bones;
+        std::vector<real_t> weights;
+        std::vector<real_t> uvs;
+        std::vector<real_t> uv2s;
+        std::vector<int> indices;
+
+        int vertex_count() const {
+            return positions.size() / 3;
+        }
+
+        int face_count() const {
+            return indices.empty() ? vertex_count() / 3 : indices.size() / 3;
+        }
+
+        SlicerCore::MeshView view(const Attributes &attributes) const {
+            SlicerCore::MeshView view;
+            view.positions = positions.data();
+            view.vertex_count = vertex_count();
+            view.normals = attributes.normals ? normals.data() : nullptr;
+            view.tangents = attributes.tangents ? tangents.data() : nullptr;
+            view.colors = attributes.colors ? colors.data() : nullptr;
+            view.bones = attributes.skinned ? bones.data() : nullptr;
+            view.weights = attributes.skinned ? weights.data() : nullptr;
+            view.uvs = attributes.uvs ? uvs.data() : nullptr;
+            view.uv2s = attributes.uv2s ? uv2s.data() : nullptr;
+
+            if (!indices.empty()) {
+                view.indices = indices.data();
+                view.index_count = indices.size();
+            }
+
+            return view;
+        }
+    };
+
+    int midpoint(std::vector<Vector3> &points, std::unordered_map<uint64_t, int> &midpoints, int a, int b) {
+        uint64_t key = a < b ? (uint64_t(a) << 32) | uint32_t(b) : (uint64_t(b) << 32) | uint32_t(a);
+        auto found = midpoints.find(key);
+        if (found != midpoints.end()) {
+            return found->second;
+        }
+
+        points.push_back(((points[a] + points[b]) * 0.5).normalized());
+        midpoints[key] = points.size() - 1;
+        return points.size() - 1;
+    }
+
+    Icosphere make_icosphere(int subdivisions, bool indexed) {
+        const real_t t = (1.0 + std::sqrt(5.0)) / 2.0;
+        std::vector<Vector3> points = {
+            Vector3(-1, t, 0), Vector3(1, t, 0), Vector3(-1, -t, 0), Vector3(1, -t, 0),
+            Vector3(0, -1, t), Vector3(0, 1, t), Vector3(0, -1, -t), Vector3(0, 1, -t),
+            Vector3(t, 0, -1), Vector3(t, 0, 1), Vector3(-t, 0, -1), Vector3(-t, 0, 1),
+        };
+        for (Vector3 &point : points) {
+            point = point.normalized();
+        }
+
+        std::vector<int> faces = {
+            0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+            1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+            4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+        };
+
+        std::unordered_map<uint64_t, int> midpoints;
+        for (int level = 0; level < subdivisions; level++) {
+            std::vector<int> subdivided;
+            subdivided.reserve(faces.size() * 4);
+            midpoints.clear();
+
+            for (size_t i = 0; i < faces.size(); i += 3) {
+                int a = faces[i];
+                int b = faces[i + 1];
+                int c = faces[i + 2];
+                int ab = midpoint(points, midpoints, a, b);
+                int bc = midpoint(points, midpoints, b, c);
+                int ca = midpoint(points, midpoints, c, a);
+
+                int quads[] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+                subdivided.insert(subdivided.end(), quads, quads + 12);
+            }
+
+            faces.swap(subdivided);
+        }
+
+        // The faces above go counter clockwise from the outside, Godot's front faces go the other way
+        for (size_t i = 0; i < faces.size(); i += 3) {
+            std::swap(faces[i + 1], faces[i + 2]);
+        }
+
+        Icosphere sphere;
+        int vertex_count = indexed ? points.size() : faces.size();
+        sphere.positions.reserve(vertex_count * 3);
+        sphere.normals.reserve(vertex_count * 3);
+        sphere.tangents.reserve(vertex_count * 4);
+        sphere.colors.reserve(vertex_count * 4);
+        sphere.bones.reserve(vertex_count * 4);
+        sphere.weights.reserve(vertex_count * 4);
+        sphere.uvs.reserve(vertex_count * 2);
+        sphere.uv2s.reserve(vertex_count * 2);
+
+        for (int i = 0; i < vertex_count; i++) {
+            Vector3 point = points[indexed ? i : faces[i]];
+            Vector3 tangent = Vector3(0, 1, 0).cross(point);
+            tangent = tangent.length_squared() > CMP_EPSILON ? tangent.normalized() : Vector3(1, 0, 0);
+
+            real_t u = 0.5 + std::atan2(point.z, point.x) / (2 * Math_PI);
+            real_t v = 0.5 - std::asin(CLAMP(point.y, (real_t)-1, (real_t)1)) / Math_PI;
+            int bone = i % 4;
+
+            sphere.positions.insert(sphere.positions.end(), { point.x, point.y, point.z });
+            sphere.normals.insert(sphere.normals.end(), { point.x, point.y, point.z });
+            sphere.tangents.insert(sphere.tangents.end(), { tangent.x, tangent.y, tangent.z, 1 });
+            sphere.colors.insert(sphere.colors.end(), { float(point.x * 0.5 + 0.5), float(point.y * 0.5 + 0.5), float(point.z * 0.5 + 0.5), 1.0f });
+            sphere.bones.insert(sphere.bones.end(), { real_t(bone), real_t((bone + 1) % 4), real_t((bone + 2) % 4), real_t((bone + 3) % 4) });
+            sphere.weights.insert(sphere.weights.end(), { 0.4, 0.3, 0.2, 0.1 });
+            sphere.uvs.insert(sphere.uvs.end(), { u, v });
+            sphere.uv2s.insert(sphere.uv2s.end(), { u * 0.5f, v * 0.5f });
+        }
+
+        if (indexed) {
+            sphere.indices = faces;
+        }
+
+        return sphere;
+    }
+
+    /**
+     * Reusable state for slicing one mesh over and over, same as SlicerCore::Slicer holds but
+     * laid out so each stage can be timed on its own
+    */
+    struct Pipeline {
+        Intersector::SplitResult split;
+        LocalVector<Vector3> points;
+        LocalVector<Vector3> segments;
+        Triangulator::Workspace triangulator;
+        MeshBuffer hull;
+        MeshBuffer cross_section;
+        MeshBuffer halves[4];
+
+        // See MemoryTracker
+        LocalVector<uint64_t> memory_watermarks;
+
+        /**
+         * Estimates what the pipeline's buffers hold right now, see MemoryTracker
+        */
+        uint64_t memory_bytes() {
+            MemoryTracker tracker(memory_watermarks);
+            split.track_memory(tracker);
+            tracker.add(points);
+            tracker.add(segments);
+            triangulator.track_memory(tracker);
+            hull.track_memory(tracker);
+            cross_section.track_memory(tracker);
+            for (int i = 0; i < 4; i++) {
+                halves[i].track_memory(tracker);
+            }
+            return tracker.bytes;
+        }
+    };
+
+    struct Timings {
+        std::vector<double> samples[STAGE_MAX];
+
+        // Whatever the last repeat produced, to tell the cases apart in the results
+        int intersection_points = 0;
+        int cap_faces = 0;
+        int upper_faces = 0;
+        int lower_faces = 0;
+
+        // The most the pipeline's buffers held at the end of any stage
+        uint64_t peak_bytes = 0;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    double elapsed_ns(Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    }
+
+    void run_once(const SlicerCore::MeshView &mesh, const Plane &plane, Pipeline &pipeline, Timings *r_timings) {
+        double times[STAGE_MAX];
+        uint64_t peak_bytes = 0;
+        Intersector::SplitResult &split = pipeline.split;
+        split.reset();
+        for (int i = 0; i < 4; i++) {
+            pipeline.halves[i].clear();
+        }
+
+        Clock::time_point start = Clock::now();
+        SlicerCore::load_mesh(mesh, split.surface);
+        times[STAGE_LOAD] = elapsed_ns(start);
+        peak_bytes = MAX(peak_bytes, pipeline.memory_bytes());
+
+        // The generic kernels get the surface first, then everything they added to it is dropped
+        // so the specialized ones split the exact same thing
+        int vertex_count = split.surface.vertex_count();
+        start = Clock::now();
+        Intersector::split_surface_by_plane(plane, split, false);
+        times[STAGE_SPLIT_GENERIC] = elapsed_ns(start);
+
+        split.surface.resize_vertices(vertex_count);
+        split.upper_indices.clear();
+        split.lower_indices.clear();
+        split.intersection_points.clear();
+        split.cut_segments.clear();
+
+        start = Clock::now();
+        Intersector::split_surface_by_plane(plane, split, true);
+        times[STAGE_SPLIT] = elapsed_ns(start);
+
+        pipeline.points.clear();
+        pipeline.segments.clear();
+        for (uint32_t i = 0; i < split.intersection_points.size(); i++) {
+            pipeline.points.push_back(split.intersection_points[i]);
+        }
+        for (uint32_t i = 0; i < split.cut_segments.size(); i++) {
+            pipeline.segments.push_back(split.cut_segments[i]);
+        }
+        peak_bytes = MAX(peak_bytes, pipeline.memory_bytes());
+
+        start = Clock::now();
+        Triangulator::monotone_chain(pipeline.points, plane.normal, pipeline.triangulator, pipeline.hull);
+        times[STAGE_MONOTONE_CHAIN] = elapsed_ns(start);
+
+        start = Clock::now();
+        Triangulator::cap(pipeline.segments, pipeline.points, plane.normal, pipeline.triangulator, pipeline.cross_section);
+        times[STAGE_CAP] = elapsed_ns(start);
+        peak_bytes = MAX(peak_bytes, pipeline.memory_bytes());
+
+        // Stands in for SurfaceFiller, which needs Godot's arrays. This is the same copy out
+        // into a buffer per half that SlicerCore::Slicer hands back
+        start = Clock::now();
+        pipeline.halves[0].extract(split.surface, split.upper_indices);
+        pipeline.halves[1].extract(pipeline.cross_section, pipeline.cross_section.indices, true);
+        pipeline.halves[2].extract(split.surface, split.lower_indices);
+        pipeline.halves[3].extract(pipeline.cross_section, pipeline.cross_section.indices);
+        times[STAGE_EXTRACT] = elapsed_ns(start);
+        peak_bytes = MAX(peak_bytes, pipeline.memory_bytes());
+
+        if (r_timings == nullptr) {
+            return;
+        }
+
+        for (int i = 0; i < STAGE_MAX; i++) {
+            r_timings->samples[i].push_back(times[i]);
+        }
+        r_timings->intersection_points = split.intersection_points.size();
+        r_timings->cap_faces = pipeline.cross_section.face_count();
+        r_timings->upper_faces = split.upper_indices.size() / 3;
+        r_timings->lower_faces = split.lower_indices.size() / 3;
+        r_timings->peak_bytes = peak_bytes;
+    }
+
+    double median(std::vector<double> samples) {
+        std::sort(samples.begin(), samples.end());
+        size_t middle = samples.size() / 2;
+        return samples.size() % 2 ? samples[middle] : (samples[middle - 1] + samples[middle]) * 0.5;
+    }
+
+    void write_stage(FILE *file, const char *name, const std::vector<double> &samples, int faces, bool last) {
+        double best = *std::min_element(samples.begin(), samples.end());
+        double middle = median(samples);
+        double ns_per_face = middle / faces;
+
+        fprintf(file, "        \"%s\": {\"min_ns\": %.0f, \"median_ns\": %.0f, \"ns_per_triangle\": %.4f, \"triangles_per_second\": %.0f}%s\n",
+                name, best, middle, ns_per_face, ns_per_face > 0 ? 1e9 / ns_per_face : 0.0, last ? "" : ",");
+    }
+
+    bool parse_options(int argc, char **argv, Options &r_options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+
+            if (arg == "--output" && has_value) {
+                r_options.output = argv[++i];
+            } else if (arg == "--min-subdivisions" && has_value) {
+                r_options.min_subdivisions = atoi(argv[++i]);
+            } else if (arg == "--max-subdivisions" && has_value) {
+                r_options.max_subdivisions = atoi(argv[++i]);
+            } else if (arg == "--repeats" && has_value) {
+                r_options.repeats = atoi(argv[++i]);
+            } else {
+                fprintf(stderr,
+                        "usage: %s [--output path] [--min-subdivisions n] [--max-subdivisions n] [--repeats n]\n"
+                        "  subdivisions 3 to 8 make icospheres of 1280 to 1310720 triangles\n",
+                        argv[0]);
+                return false;
+            }
+        }
+
+        return r_options.repeats > 0 && r_options.min_subdivisions >= 0 && r_options.min_subdivisions <= r_options.max_subdivisions;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 1;
+    }
+
+    FILE *file = fopen(options.output.c_str(), "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Couldn't open %s for writing\n", options.output.c_str());
+        return 1;
+    }
+
+    fprintf(file, "{\n  \"format\": 2,\n  \"real_t_bytes\": %d,\n  \"repeats\": %d,\n  \"results\": [\n",
+            int(sizeof(real_t)), options.repeats);
+
+    printf("%-8s %-8s %-27s %-9s", "faces", "indexed", "attributes", "plane");
+    for (int i = 0; i < STAGE_MAX; i++) {
+        printf(" %14s", STAGE_NAMES[i]);
+    }
+    printf(" %14s   (median ns/triangle)\n", "peak_B/tri");
+
+    Pipeline pipeline;
+    bool first = true;
+
+    for (int subdivisions = options.min_subdivisions; subdivisions <= options.max_subdivisions; subdivisions++) {
+        for (int indexed = 1; indexed >= 0; indexed--) {
+            Icosphere sphere = make_icosphere(subdivisions, indexed);
+            int faces = sphere.face_count();
+
+            for (const Attributes &attributes : ATTRIBUTE_SETS) {
+                SlicerCore::MeshView mesh = sphere.view(attributes);
+
+                for (const PlaneCase &plane_case : PLANES) {
+                    Vector3 normal = Vector3(plane_case.normal[0], plane_case.normal[1], plane_case.normal[2]).normalized();
+                    Plane plane(normal, plane_case.d);
+
+                    // One run to warm up the caches and grow the buffers, which then get reused
+                    run_once(mesh, plane, pipeline, nullptr);
+
+                    Timings timings;
+                    for (int i = 0; i < options.repeats; i++) {
+                        run_once(mesh, plane, pipeline, &timings);
+                    }
+
+                    fprintf(file, "%s    {\n", first ? "" : ",\n");
+                    fprintf(file, "      \"subdivisions\": %d, \"triangles\": %d, \"vertices\": %d, \"indexed\": %s,\n",
+                            subdivisions, faces, sphere.vertex_count(), indexed ? "true" : "false");
+                    fprintf(file, "      \"attributes\": \"%s\", \"plane\": \"%s\",\n", attributes.name, plane_case.name);
+                    double peak_per_face = double(timings.peak_bytes) / faces;
+                    fprintf(file, "      \"intersection_points\": %d, \"cap_triangles\": %d, \"upper_triangles\": %d, \"lower_triangles\": %d,\n",
+                            timings.intersection_points, timings.cap_faces, timings.upper_faces, timings.lower_faces);
+                    fprintf(file, "      \"peak_bytes\": %llu, \"peak_bytes_per_triangle\": %.2f,\n", (unsigned long long)timings.peak_bytes, peak_per_face);
+                    fprintf(file, "      \"stages\": {\n");
+                    for (int i = 0; i < STAGE_MAX; i++) {
+                        write_stage(file, STAGE_NAMES[i], timings.samples[i], faces, i == STAGE_MAX - 1);
+                    }
+                    fprintf(file, "      }\n    }");
+                    first = false;
+
+                    printf("%-8d %-8s %-27s %-9s", faces, indexed ? "yes" : "no", attributes.name, plane_case.name);
+                    for (int i = 0; i < STAGE_MAX; i++) {
+                        printf(" %14.3f", median(timings.samples[i]) / faces);
+                    }
+                    printf(" %14.1f\n", peak_per_face);
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+    fclose(file);
+
+    printf("Wrote %s\n", options.output.c_str());
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "slicer_core.h"
+
+#include <cstring>
+
+// The views hand out the streams of the buffers as they are, which only works
+// as long as the math types are laid out as plain runs of real_t
+static_assert(sizeof(Vector3) == sizeof(real_t) * 3, "Vector3 needs to be three packed real_t");
+static_assert(sizeof(Vector2) == sizeof(real_t) * 2, "Vector2 needs to be two packed real_t");
+static_assert(sizeof(SlicerVector4) == sizeof(real_t) * 4, "SlicerVector4 needs to be four packed real_t");
+static_assert(sizeof(Color) == sizeof(float) * 4, "Color needs to be four packed floats");
+
+namespace SlicerCore {
+    _FORCE_INLINE_ void copy_stream(void *to, const void *from, int count, size_t element_size) {
+        if (from) {
+            memcpy(to, from, count * element_size);
+        }
+    }
+
+    MeshView view_of(const MeshBuffer &buffer) {
+        MeshView view;
+        view.positions = reinterpret_cast<const real_t *>(buffer.vertices.ptr());
+        view.vertex_count = buffer.vertex_count();
+        view.indices = buffer.indices.ptr();
+        view.index_count = buffer.indices.size();
+
+        if (buffer.has(Mesh::ARRAY_FORMAT_NORMAL)) {
+            view.normals = reinterpret_cast<const real_t *>(buffer.normals.ptr());
+        }
+
+        if (buffer.has(Mesh::ARRAY_FORMAT_TANGENT)) {
+            view.tangents = reinterpret_cast<const real_t *>(buffer.tangents.ptr());
+        }
+
+        if (buffer.has(Mesh::ARRAY_FORMAT_COLOR)) {
+            view.colors = reinterpret_cast<const float *>(buffer.colors.ptr());
+        }
+
+        if (buffer.has(Mesh::ARRAY_FORMAT_BONES)) {
+            view.bones = reinterpret_cast<const real_t *>(buffer.bones.ptr());
+        }
+
+        if (buffer.has(Mesh::ARRAY_FORMAT_WEIGHTS)) {
+            view.weights = reinterpret_cast<const real_t *>(buffer.weights.ptr());
+        }
+
+        if (buffer.has(Mesh::ARRAY_FORMAT_TEX_UV)) {
+            view.uvs = reinterpret_cast<const real_t *>(buffer.uvs.ptr());
+        }
+
+        if (buffer.has(Mesh::ARRAY_FORMAT_TEX_UV2)) {
+            view.uv2s = reinterpret_cast<const real_t *>(buffer.uv2s.ptr());
+        }
+
+        return view;
+    }
+
+    void load_mesh(const MeshView &mesh, MeshBuffer &surface) {
+        surface.format = 0;
+        surface.format |= mesh.normals ? Mesh::ARRAY_FORMAT_NORMAL : 0;
+        surface.format |= mesh.tangents ? Mesh::ARRAY_FORMAT_TANGENT : 0;
+        surface.format |= mesh.colors ? Mesh::ARRAY_FORMAT_COLOR : 0;
+        surface.format |= mesh.bones ? Mesh::ARRAY_FORMAT_BONES : 0;
+        surface.format |= mesh.weights ? Mesh::ARRAY_FORMAT_WEIGHTS : 0;
+        surface.format |= mesh.uvs ? Mesh::ARRAY_FORMAT_TEX_UV : 0;
+        surface.format |= mesh.uv2s ? Mesh::ARRAY_FORMAT_TEX_UV2 : 0;
+        surface.resize_vertices(mesh.vertex_count);
+
+        copy_stream(surface.vertices.ptr(), mesh.positions, mesh.vertex_count, sizeof(Vector3));
+        copy_stream(surface.normals.ptr(), mesh.normals, mesh.vertex_count, sizeof(Vector3));
+        copy_stream(surface.tangents.ptr(), mesh.tangents, mesh.vertex_count, sizeof(SlicerVector4));
+        copy_stream(surface.colors.ptr(), mesh.colors, mesh.vertex_count, sizeof(Color));
+        copy_stream(surface.bones.ptr(), mesh.bones, mesh.vertex_count, sizeof(SlicerVector4));
+        copy_stream(surface.weights.ptr(), mesh.weights, mesh.vertex_count, sizeof(SlicerVector4));
+        copy_stream(surface.uvs.ptr(), mesh.uvs, mesh.vertex_count, sizeof(Vector2));
+        copy_stream(surface.uv2s.ptr(), mesh.uv2s, mesh.vertex_count, sizeof(Vector2));
+
+        if (mesh.indices) {
+            surface.indices.resize(mesh.index_count);
+            memcpy(surface.indices.ptr(), mesh.indices, mesh.index_count * sizeof(int));
+        } else {
+            surface.indices.resize(mesh.vertex_count - mesh.vertex_count % 3);
+            for (uint32_t i = 0; i < surface.indices.size(); i++) {
+                surface.indices[i] = i;
+            }
+        }
+    }
+
+    bool Slicer::slice(const MeshView &mesh, const real_t plane[4]) {
+        split.reset();
+        for (int i = 0; i < 4; i++) {
+            buffers[i].clear();
+        }
+        halves[0] = HalfView();
+        halves[1] = HalfView();
+
+        // Nothing to cut, which isn't a mistake on the caller's part the way missing positions are
+        if (mesh.vertex_count == 0) {
+            return false;
+        }
+
+        ERR_FAIL_COND_V(mesh.positions == nullptr, false);
+        ERR_FAIL_COND_V(mesh.indices != nullptr && mesh.index_count % 3 != 0, false);
+
+        load_mesh(mesh, split.surface);
+
+        Plane split_plane(Vector3(plane[0], plane[1], plane[2]), plane[3]);
+        Intersector::split_surface_by_plane(split_plane, split, specialized_kernels);
+
+        // Through a ring of vertexes the plane only leaves segments, see SlicePipeline::gather_cut
+        if (split.intersection_points.size() == 0 && split.cut_segments.size() == 0) {
+            return false;
+        }
+
+        intersection_points.clear();
+        cut_segments.clear();
+        for (uint32_t i = 0; i < split.intersection_points.size(); i++) {
+            intersection_points.push_back(split.intersection_points[i]);
+        }
+        for (uint32_t i = 0; i < split.cut_segments.size(); i++) {
+            cut_segments.push_back(split.cut_segments[i]);
+        }
+
+        Triangulator::cap(cut_segments, intersection_points, split_plane.normal, triangulator, cross_section);
+
+        // Same as SlicedMesh, the cap faces the way the plane does so the upper half gets it flipped
+        buffers[0].extract(split.surface, split.upper_indices, false, &remap);
+        buffers[1].extract(cross_section, cross_section.indices, true, &remap);
+        buffers[2].extract(split.surface, split.lower_indices, false, &remap);
+        buffers[3].extract(cross_section, cross_section.indices, false, &remap);
+
+        for (int i = 0; i < 2; i++) {
+            halves[i].surface = view_of(buffers[i * 2]);
+            halves[i].cap = view_of(buffers[i * 2 + 1]);
+        }
+
+        return true;
+    }
+
+    void Slicer::track_memory(MemoryTracker &tracker) const {
+        split.track_memory(tracker);
+        tracker.add(intersection_points);
+        tracker.add(cut_segments);
+        triangulator.track_memory(tracker);
+        cross_section.track_memory(tracker);
+        for (int i = 0; i < 4; i++) {
+            buffers[i].track_memory(tracker);
+        }
+        tracker.add(remap);
+    }
+} // SlicerCore
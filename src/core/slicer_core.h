@@ -0,0 +1,93 @@
+#ifndef SLICER_CORE_H
+#define SLICER_CORE_H
+
+#include "utils/intersector.h"
+#include "utils/triangulator.h"
+
+/**
+ * A plain C++ front end to the slicing core, for native code that wants to slice a mesh
+ * without going through Variants, and for driving the core without Godot at all (see the
+ * core target in SConstruct). Meshes go in and come out as flat arrays of real_t
+*/
+namespace SlicerCore {
+    /**
+     * A triangle mesh laid out as flat arrays. Positions are required, every other stream can
+     * be left null. Without indices every three vertexes make a face
+    */
+    struct MeshView {
+        const real_t *positions = nullptr; // Three per vertex
+        const real_t *normals = nullptr; // Three per vertex
+        const real_t *tangents = nullptr; // Four per vertex
+        const float *colors = nullptr; // Four per vertex
+        const real_t *bones = nullptr; // Four per vertex
+        const real_t *weights = nullptr; // Four per vertex
+        const real_t *uvs = nullptr; // Two per vertex
+        const real_t *uv2s = nullptr; // Two per vertex
+        int vertex_count = 0;
+
+        const int *indices = nullptr;
+        int index_count = 0;
+    };
+
+    /**
+     * One side of a slice: the faces of the mesh on that side, and the cap over the cut as
+     * its own mesh since it carries its own normals and uvs. Both point into the Slicer that
+     * made them, and only stay valid until it slices again
+    */
+    struct HalfView {
+        MeshView surface;
+        MeshView cap;
+    };
+
+    /**
+     * Copies the mesh into the buffer, carrying over whichever streams it has
+    */
+    void load_mesh(const MeshView &mesh, MeshBuffer &r_buffer);
+
+    /**
+     * The streams of the buffer as a MeshView, valid for as long as the buffer isn't changed
+    */
+    MeshView view_of(const MeshBuffer &buffer);
+
+    class Slicer {
+    public:
+        /**
+         * Slices the mesh by the plane, given as its normal followed by its distance from the
+         * origin. Returns false if the plane missed the mesh, in which case the halves are empty
+        */
+        bool slice(const MeshView &mesh, const real_t plane[4]);
+
+        const HalfView &get_upper() const {
+            return halves[0];
+        }
+
+        const HalfView &get_lower() const {
+            return halves[1];
+        }
+
+        /**
+         * Adds every buffer the slicer holds onto between slices to the tracker, see MemoryTracker
+        */
+        void track_memory(MemoryTracker &tracker) const;
+
+        /**
+         * See Slicer::set_specialized_kernels
+        */
+        bool specialized_kernels = true;
+
+    private:
+        Intersector::SplitResult split;
+        LocalVector<Vector3> intersection_points;
+        LocalVector<Vector3> cut_segments;
+
+        Triangulator::Workspace triangulator;
+        MeshBuffer cross_section;
+
+        // The surface and cap of the upper half, followed by those of the lower one
+        MeshBuffer buffers[4];
+        LocalVector<int> remap;
+        HalfView halves[2];
+    };
+} // SlicerCore
+
+#endif // SLICER_CORE_H
@@ -0,0 +1,416 @@
+#ifndef STANDALONE_TYPES_H
+#define STANDALONE_TYPES_H
+
+/**
+ * Stand-ins for the few godot-cpp types the slicing core is written against, for building
+ * the core without Godot (see utils/core_types.h). Only what the core actually uses is here,
+ * and everything behaves the same as godot-cpp's as far as the core can tell. The one real
+ * difference is memory, which goes through the standard library instead of the engine
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#define _FORCE_INLINE_ inline
+
+#ifndef MIN
+#define MIN(m_a, m_b) (((m_a) < (m_b)) ? (m_a) : (m_b))
+#endif
+
+#ifndef MAX
+#define MAX(m_a, m_b) (((m_a) > (m_b)) ? (m_a) : (m_b))
+#endif
+
+#ifndef CLAMP
+#define CLAMP(m_a, m_min, m_max) (((m_a) < (m_min)) ? (m_min) : (((m_a) > (m_max)) ? m_max : m_a))
+#endif
+
+#define SWAP(m_x, m_y) std::swap((m_x), (m_y))
+
+#define CMP_EPSILON 0.00001
+#define Math_PI 3.1415926535897932384626433833
+
+// Errors get printed, and the function bails out, same as in Godot
+#define SLICER_PRINT_ERROR(m_msg) fprintf(stderr, "ERROR: %s\n   at: %s (%s:%i)\n", m_msg, __FUNCTION__, __FILE__, __LINE__)
+
+#define ERR_FAIL_COND(m_cond) \
+    if (m_cond) {             \
+        SLICER_PRINT_ERROR("Condition \"" #m_cond "\" is true."); \
+        return;               \
+    } else ((void)0)
+
+#define ERR_FAIL_COND_V(m_cond, m_retval) \
+    if (m_cond) {                         \
+        SLICER_PRINT_ERROR("Condition \"" #m_cond "\" is true. Returning: " #m_retval); \
+        return m_retval;                  \
+    } else ((void)0)
+
+#define ERR_FAIL_COND_MSG(m_cond, m_msg) \
+    if (m_cond) {                        \
+        SLICER_PRINT_ERROR(m_msg);       \
+        return;                          \
+    } else ((void)0)
+
+#define ERR_FAIL_COND_V_MSG(m_cond, m_retval, m_msg) \
+    if (m_cond) {                                    \
+        SLICER_PRINT_ERROR(m_msg);                   \
+        return m_retval;                             \
+    } else ((void)0)
+
+#define ERR_FAIL_NULL(m_param) ERR_FAIL_COND((m_param) == nullptr)
+#define ERR_FAIL_NULL_V(m_param, m_retval) ERR_FAIL_COND_V((m_param) == nullptr, m_retval)
+#define ERR_FAIL_NULL_V_MSG(m_param, m_retval, m_msg) ERR_FAIL_COND_V_MSG((m_param) == nullptr, m_retval, m_msg)
+
+#define ERR_FAIL_MSG(m_msg)        \
+    if (true) {                    \
+        SLICER_PRINT_ERROR(m_msg); \
+        return;                    \
+    } else ((void)0)
+
+namespace godot {
+
+#ifdef REAL_T_IS_DOUBLE
+typedef double real_t;
+#else
+typedef float real_t;
+#endif
+
+namespace Math {
+    template <class T>
+    _FORCE_INLINE_ T abs(T x) { return std::abs(x); }
+    _FORCE_INLINE_ double sqrt(double x) { return std::sqrt(x); }
+    _FORCE_INLINE_ double floor(double x) { return std::floor(x); }
+    _FORCE_INLINE_ double round(double x) { return std::round(x); }
+    _FORCE_INLINE_ double cos(double x) { return std::cos(x); }
+    _FORCE_INLINE_ double sin(double x) { return std::sin(x); }
+    _FORCE_INLINE_ bool is_zero_approx(real_t x) { return std::abs(x) < CMP_EPSILON; }
+    _FORCE_INLINE_ double snapped(double value, double step) {
+        return step != 0 ? std::floor(value / step + 0.5) * step : value;
+    }
+} // Math
+
+struct Vector2 {
+    union {
+        struct {
+            real_t x;
+            real_t y;
+        };
+        real_t coord[2];
+    };
+
+    _FORCE_INLINE_ Vector2() { x = y = 0; }
+    _FORCE_INLINE_ Vector2(real_t p_x, real_t p_y) { x = p_x; y = p_y; }
+
+    _FORCE_INLINE_ real_t &operator[](int axis) { return coord[axis]; }
+    _FORCE_INLINE_ const real_t &operator[](int axis) const { return coord[axis]; }
+
+    _FORCE_INLINE_ Vector2 operator+(const Vector2 &v) const { return Vector2(x + v.x, y + v.y); }
+    _FORCE_INLINE_ Vector2 operator-(const Vector2 &v) const { return Vector2(x - v.x, y - v.y); }
+    _FORCE_INLINE_ Vector2 operator*(real_t s) const { return Vector2(x * s, y * s); }
+    _FORCE_INLINE_ Vector2 operator/(real_t s) const { return Vector2(x / s, y / s); }
+    _FORCE_INLINE_ Vector2 &operator+=(const Vector2 &v) { x += v.x; y += v.y; return *this; }
+    _FORCE_INLINE_ Vector2 &operator-=(const Vector2 &v) { x -= v.x; y -= v.y; return *this; }
+    _FORCE_INLINE_ bool operator==(const Vector2 &v) const { return x == v.x && y == v.y; }
+    _FORCE_INLINE_ bool operator!=(const Vector2 &v) const { return !(*this == v); }
+
+    _FORCE_INLINE_ real_t dot(const Vector2 &v) const { return x * v.x + y * v.y; }
+    _FORCE_INLINE_ real_t cross(const Vector2 &v) const { return x * v.y - y * v.x; }
+    _FORCE_INLINE_ real_t length() const { return std::sqrt(x * x + y * y); }
+    _FORCE_INLINE_ Vector2 min(const Vector2 &v) const { return Vector2(MIN(x, v.x), MIN(y, v.y)); }
+    _FORCE_INLINE_ Vector2 max(const Vector2 &v) const { return Vector2(MAX(x, v.x), MAX(y, v.y)); }
+};
+
+struct Vector3 {
+    union {
+        struct {
+            real_t x;
+            real_t y;
+            real_t z;
+        };
+        real_t coord[3];
+    };
+
+    _FORCE_INLINE_ Vector3() { x = y = z = 0; }
+    _FORCE_INLINE_ Vector3(real_t p_x, real_t p_y, real_t p_z) { x = p_x; y = p_y; z = p_z; }
+
+    _FORCE_INLINE_ real_t &operator[](int axis) { return coord[axis]; }
+    _FORCE_INLINE_ const real_t &operator[](int axis) const { return coord[axis]; }
+
+    _FORCE_INLINE_ Vector3 operator+(const Vector3 &v) const { return Vector3(x + v.x, y + v.y, z + v.z); }
+    _FORCE_INLINE_ Vector3 operator-(const Vector3 &v) const { return Vector3(x - v.x, y - v.y, z - v.z); }
+    _FORCE_INLINE_ Vector3 operator*(const Vector3 &v) const { return Vector3(x * v.x, y * v.y, z * v.z); }
+    _FORCE_INLINE_ Vector3 operator/(const Vector3 &v) const { return Vector3(x / v.x, y / v.y, z / v.z); }
+    _FORCE_INLINE_ Vector3 operator*(real_t s) const { return Vector3(x * s, y * s, z * s); }
+    _FORCE_INLINE_ Vector3 operator/(real_t s) const { return Vector3(x / s, y / s, z / s); }
+    _FORCE_INLINE_ Vector3 operator-() const { return Vector3(-x, -y, -z); }
+    _FORCE_INLINE_ Vector3 &operator+=(const Vector3 &v) { x += v.x; y += v.y; z += v.z; return *this; }
+    _FORCE_INLINE_ Vector3 &operator-=(const Vector3 &v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+    _FORCE_INLINE_ Vector3 &operator*=(real_t s) { x *= s; y *= s; z *= s; return *this; }
+    _FORCE_INLINE_ Vector3 &operator/=(real_t s) { x /= s; y /= s; z /= s; return *this; }
+    _FORCE_INLINE_ bool operator==(const Vector3 &v) const { return x == v.x && y == v.y && z == v.z; }
+    _FORCE_INLINE_ bool operator!=(const Vector3 &v) const { return !(*this == v); }
+
+    _FORCE_INLINE_ real_t dot(const Vector3 &v) const { return x * v.x + y * v.y + z * v.z; }
+    _FORCE_INLINE_ Vector3 cross(const Vector3 &v) const {
+        return Vector3(y * v.z - z * v.y, z * v.x - x * v.z, x * v.y - y * v.x);
+    }
+
+    _FORCE_INLINE_ real_t length_squared() const { return dot(*this); }
+    _FORCE_INLINE_ real_t length() const { return std::sqrt(length_squared()); }
+    _FORCE_INLINE_ real_t distance_to(const Vector3 &v) const { return (v - *this).length(); }
+    _FORCE_INLINE_ real_t distance_squared_to(const Vector3 &v) const { return (v - *this).length_squared(); }
+
+    _FORCE_INLINE_ void normalize() {
+        real_t l = length_squared();
+        if (l == 0) {
+            x = y = z = 0;
+        } else {
+            l = std::sqrt(l);
+            x /= l;
+            y /= l;
+            z /= l;
+        }
+    }
+
+    _FORCE_INLINE_ Vector3 normalized() const {
+        Vector3 v = *this;
+        v.normalize();
+        return v;
+    }
+
+    _FORCE_INLINE_ Vector3 abs() const { return Vector3(std::abs(x), std::abs(y), std::abs(z)); }
+    _FORCE_INLINE_ Vector3 min(const Vector3 &v) const { return Vector3(MIN(x, v.x), MIN(y, v.y), MIN(z, v.z)); }
+    _FORCE_INLINE_ Vector3 max(const Vector3 &v) const { return Vector3(MAX(x, v.x), MAX(y, v.y), MAX(z, v.z)); }
+    _FORCE_INLINE_ Vector3 lerp(const Vector3 &to, real_t t) const { return *this + (to - *this) * t; }
+
+    _FORCE_INLINE_ Vector3 snapped(const Vector3 &step) const {
+        return Vector3(Math::snapped(x, step.x), Math::snapped(y, step.y), Math::snapped(z, step.z));
+    }
+};
+
+_FORCE_INLINE_ Vector3 operator*(real_t s, const Vector3 &v) {
+    return v * s;
+}
+
+struct Color {
+    union {
+        struct {
+            float r;
+            float g;
+            float b;
+            float a;
+        };
+        float components[4];
+    };
+
+    _FORCE_INLINE_ Color() { r = g = b = 0; a = 1; }
+    _FORCE_INLINE_ Color(float p_r, float p_g, float p_b, float p_a = 1.0) { r = p_r; g = p_g; b = p_b; a = p_a; }
+
+    _FORCE_INLINE_ Color operator+(const Color &c) const { return Color(r + c.r, g + c.g, b + c.b, a + c.a); }
+    _FORCE_INLINE_ Color operator*(float s) const { return Color(r * s, g * s, b * s, a * s); }
+    _FORCE_INLINE_ bool operator==(const Color &c) const { return r == c.r && g == c.g && b == c.b && a == c.a; }
+};
+
+struct Plane {
+    Vector3 normal;
+    real_t d = 0;
+
+    _FORCE_INLINE_ Plane() {}
+    _FORCE_INLINE_ Plane(const Vector3 &p_normal, real_t p_d = 0) : normal(p_normal), d(p_d) {}
+    _FORCE_INLINE_ Plane(real_t p_a, real_t p_b, real_t p_c, real_t p_d) : normal(p_a, p_b, p_c), d(p_d) {}
+
+    _FORCE_INLINE_ real_t distance_to(const Vector3 &point) const { return normal.dot(point) - d; }
+    _FORCE_INLINE_ bool is_point_over(const Vector3 &point) const { return normal.dot(point) > d; }
+};
+
+struct AABB {
+    Vector3 position;
+    Vector3 size;
+
+    _FORCE_INLINE_ AABB() {}
+    _FORCE_INLINE_ AABB(const Vector3 &p_position, const Vector3 &p_size) : position(p_position), size(p_size) {}
+
+    _FORCE_INLINE_ Vector3 get_end() const { return position + size; }
+
+    _FORCE_INLINE_ void expand_to(const Vector3 &point) {
+        Vector3 begin = position.min(point);
+        Vector3 end = get_end().max(point);
+        position = begin;
+        size = end - begin;
+    }
+
+    _FORCE_INLINE_ AABB merge(const AABB &with) const {
+        Vector3 begin = position.min(with.position);
+        Vector3 end = get_end().max(with.get_end());
+        return AABB(begin, end - begin);
+    }
+};
+
+struct Basis {
+    Vector3 rows[3] = { Vector3(1, 0, 0), Vector3(0, 1, 0), Vector3(0, 0, 1) };
+
+    _FORCE_INLINE_ Basis() {}
+    _FORCE_INLINE_ Basis(real_t xx, real_t xy, real_t xz, real_t yx, real_t yy, real_t yz, real_t zx, real_t zy, real_t zz) {
+        rows[0] = Vector3(xx, xy, xz);
+        rows[1] = Vector3(yx, yy, yz);
+        rows[2] = Vector3(zx, zy, zz);
+    }
+
+    _FORCE_INLINE_ Vector3 &operator[](int axis) { return rows[axis]; }
+    _FORCE_INLINE_ const Vector3 &operator[](int axis) const { return rows[axis]; }
+};
+
+// The few Mesh enums the core uses, with the same values as Godot's
+struct Mesh {
+    enum ArrayType {
+        ARRAY_VERTEX = 0,
+        ARRAY_NORMAL = 1,
+        ARRAY_TANGENT = 2,
+        ARRAY_COLOR = 3,
+        ARRAY_TEX_UV = 4,
+        ARRAY_TEX_UV2 = 5,
+        ARRAY_BONES = 10,
+        ARRAY_WEIGHTS = 11,
+        ARRAY_INDEX = 12,
+        ARRAY_MAX = 13,
+    };
+
+    enum ArrayFormat {
+        ARRAY_FORMAT_VERTEX = 1 << ARRAY_VERTEX,
+        ARRAY_FORMAT_NORMAL = 1 << ARRAY_NORMAL,
+        ARRAY_FORMAT_TANGENT = 1 << ARRAY_TANGENT,
+        ARRAY_FORMAT_COLOR = 1 << ARRAY_COLOR,
+        ARRAY_FORMAT_TEX_UV = 1 << ARRAY_TEX_UV,
+        ARRAY_FORMAT_TEX_UV2 = 1 << ARRAY_TEX_UV2,
+        ARRAY_FORMAT_BONES = 1 << ARRAY_BONES,
+        ARRAY_FORMAT_WEIGHTS = 1 << ARRAY_WEIGHTS,
+        ARRAY_FORMAT_INDEX = 1 << ARRAY_INDEX,
+    };
+};
+
+/**
+ * Same as godot-cpp's LocalVector: a plain growable array that clearing never shrinks
+*/
+template <class T>
+class LocalVector {
+    std::vector<T> data;
+
+public:
+    _FORCE_INLINE_ uint32_t size() const { return data.size(); }
+    _FORCE_INLINE_ bool is_empty() const { return data.empty(); }
+
+    // Not in godot-cpp's, see MemoryTracker::capacity_of
+    _FORCE_INLINE_ uint32_t capacity() const { return data.capacity(); }
+
+    _FORCE_INLINE_ T *ptr() { return data.data(); }
+    _FORCE_INLINE_ const T *ptr() const { return data.data(); }
+
+    _FORCE_INLINE_ T &operator[](uint32_t idx) { return data[idx]; }
+    _FORCE_INLINE_ const T &operator[](uint32_t idx) const { return data[idx]; }
+
+    _FORCE_INLINE_ void push_back(const T &value) { data.push_back(value); }
+    _FORCE_INLINE_ void resize(uint32_t size) { data.resize(size); }
+    _FORCE_INLINE_ void reserve(uint32_t size) { data.reserve(size); }
+    _FORCE_INLINE_ void clear() { data.clear(); }
+
+    _FORCE_INLINE_ void remove_at(uint32_t idx) { data.erase(data.begin() + idx); }
+
+    template <class Comparator>
+    void sort_custom() {
+        std::sort(data.begin(), data.end(), Comparator());
+    }
+
+    _FORCE_INLINE_ T *begin() { return data.data(); }
+    _FORCE_INLINE_ T *end() { return data.data() + data.size(); }
+    _FORCE_INLINE_ const T *begin() const { return data.data(); }
+    _FORCE_INLINE_ const T *end() const { return data.data() + data.size(); }
+};
+
+template <class K, class V>
+struct KeyValue {
+    K key;
+    V value;
+};
+
+/**
+ * Same as godot-cpp's HashMap for what the core needs of it, including iterating in
+ * insertion order as long as nothing was erased
+*/
+template <class K, class V>
+class HashMap {
+    std::vector<KeyValue<K, V>> elements;
+    std::unordered_map<K, uint32_t> slots;
+
+public:
+    _FORCE_INLINE_ uint32_t size() const { return elements.size(); }
+    _FORCE_INLINE_ bool is_empty() const { return elements.empty(); }
+
+    _FORCE_INLINE_ bool has(const K &key) const { return slots.find(key) != slots.end(); }
+
+    _FORCE_INLINE_ V *getptr(const K &key) {
+        auto it = slots.find(key);
+        return it == slots.end() ? nullptr : &elements[it->second].value;
+    }
+
+    _FORCE_INLINE_ const V *getptr(const K &key) const {
+        auto it = slots.find(key);
+        return it == slots.end() ? nullptr : &elements[it->second].value;
+    }
+
+    void insert(const K &key, const V &value) {
+        auto it = slots.find(key);
+        if (it != slots.end()) {
+            elements[it->second].value = value;
+            return;
+        }
+
+        slots.emplace(key, (uint32_t)elements.size());
+        elements.push_back({ key, value });
+    }
+
+    bool erase(const K &key) {
+        auto it = slots.find(key);
+        if (it == slots.end()) {
+            return false;
+        }
+
+        // The last element takes the place of the erased one
+        uint32_t slot = it->second;
+        slots.erase(it);
+        if (slot != elements.size() - 1) {
+            elements[slot] = elements.back();
+            slots[elements[slot].key] = slot;
+        }
+        elements.pop_back();
+        return true;
+    }
+
+    V &operator[](const K &key) {
+        V *existing = getptr(key);
+        if (existing) {
+            return *existing;
+        }
+
+        insert(key, V());
+        return elements.back().value;
+    }
+
+    void clear() {
+        elements.clear();
+        slots.clear();
+    }
+
+    _FORCE_INLINE_ const KeyValue<K, V> *begin() const { return elements.data(); }
+    _FORCE_INLINE_ const KeyValue<K, V> *end() const { return elements.data() + elements.size(); }
+};
+
+} // godot
+
+#endif // STANDALONE_TYPES_H
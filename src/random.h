@@ -4,13 +4,53 @@
 #include <random>
 #include <godot_cpp/core/defs.hpp>
 
-real_t random(real_t min, real_t max) {
-    std::random_device rd;
-    std::uniform_real_distribution<real_t> dist(min, max);
+/**
+ * Small, fast and seedable random number generator (PCG32, see https://www.pcg-random.org).
+ * Cheap enough to create on the stack and call thousands of times per slice, unlike
+ * std::random_device + std::mt19937, and the same seed always gives the same sequence
+*/
+struct FastRandom {
+    uint64_t state;
+    uint64_t increment;
 
-    std::mt19937 mt(rd());
+    FastRandom(uint64_t p_seed = 0x853c49e6748fea9bULL) {
+        seed(p_seed);
+    }
 
-    return dist(mt);
+    void seed(uint64_t p_seed, uint64_t p_stream = 0xda3e39cb94b95bdbULL) {
+        state = 0;
+        increment = (p_stream << 1u) | 1u;
+        next();
+        state += p_seed;
+        next();
+    }
+
+    _FORCE_INLINE_ uint32_t next() {
+        uint64_t old_state = state;
+        state = old_state * 6364136223846793005ULL + increment;
+
+        uint32_t xorshifted = (uint32_t)(((old_state >> 18u) ^ old_state) >> 27u);
+        uint32_t rotation = (uint32_t)(old_state >> 59u);
+        return (xorshifted >> rotation) | (xorshifted << ((-rotation) & 31));
+    }
+
+    // Uniform in [0, 1)
+    _FORCE_INLINE_ real_t randf() {
+        return (next() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    _FORCE_INLINE_ real_t randf_range(real_t min, real_t max) {
+        return min + (max - min) * randf();
+    }
+};
+
+/**
+ * Unseeded random number in [min, max). Each thread seeds its own generator once
+ * on first use rather than on every call
+*/
+inline real_t random(real_t min, real_t max) {
+    thread_local FastRandom rng(std::random_device{}());
+    return rng.randf_range(min, max);
 }
 
-#endif // RANDOM_H
\ No newline at end of file
+#endif // RANDOM_H
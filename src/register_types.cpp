@@ -15,12 +15,21 @@ void initialize_slicer_module(ModuleInitializationLevel p_level) {
 
 	ClassDB::register_class<Slicer>();
 	ClassDB::register_class<SlicedMesh>();
+	ClassDB::register_class<SliceJob>();
+	ClassDB::register_class<SliceScheduler>();
+	ClassDB::register_class<SliceableMeshCache>();
+	ClassDB::register_class<SliceStats>();
+	ClassDB::register_class<SliceMonitors>();
+
+	SliceMonitors::create();
 }
 
 void uninitialize_slicer_module(ModuleInitializationLevel p_level) {
 	if (p_level != MODULE_INITIALIZATION_LEVEL_SCENE) {
 		return;
 	}
+
+	SliceMonitors::destroy();
 }
 
 extern "C" {
@@ -2,6 +2,7 @@
 #define SLICER_REGISTER_TYPES_H
 
 #include "slicer.h"
+#include "slice_scheduler.h"
 
 void initialize_slicer_module();
 void uninitialize_slicer_module();
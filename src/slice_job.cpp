@@ -0,0 +1,383 @@
+#include "slice_job.h"
+
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+
+#include "utils/trace.h"
+
+void SliceJob::start(const Ref<ArrayMesh> &mesh, const Plane &p_plane, const Ref<Material> &p_cross_section_material, const SlicePipeline::Options &p_options, SliceableMeshCache *cache) {
+    ERR_FAIL_COND_MSG(task_id != -1 || self.is_valid() || completed, "SliceJob has already been started");
+    ERR_FAIL_COND(mesh.is_null());
+
+    plane = p_plane;
+    cross_section_material = p_cross_section_material;
+    options = p_options;
+
+    self = Ref<SliceJob>(this);
+
+    // If the plane misses the mesh there's nothing to hand off, the job still completes
+    // on the next frame though so whoever started it has a chance to connect to it
+    if (Intersector::get_side_of(plane, mesh->get_aabb()) != Intersector::SideOfPlane::ON) {
+        call_deferred("_finish");
+        return;
+    }
+
+    snapshot.capture(mesh, cache, options.specialized_kernels, options.use_bvh);
+    if (options.collect_stats) {
+        workspace.source_array_bytes = snapshot.array_bytes();
+    }
+
+    task_id = WorkerThreadPool::get_singleton()->add_native_task(&SliceJob::run_task, this, false, "Slicer slice_async");
+}
+
+void SliceJob::start_stepped(const Ref<ArrayMesh> &mesh, const Plane &p_plane, const Ref<Material> &p_cross_section_material, const SlicePipeline::Options &p_options, SliceableMeshCache *cache) {
+    ERR_FAIL_COND_MSG(stepped || task_id != -1 || self.is_valid() || completed, "SliceJob has already been started");
+    ERR_FAIL_COND(mesh.is_null());
+
+    plane = p_plane;
+    cross_section_material = p_cross_section_material;
+    options = p_options;
+    stepped = true;
+    stage = STAGE_COMMIT;
+
+    // Same as start, a job the plane misses still only completes on its first step
+    if (Intersector::get_side_of(plane, mesh->get_aabb()) != Intersector::SideOfPlane::ON) {
+        return;
+    }
+
+    // Every step runs on the main thread and a BVH only pays off for a whole split at once
+    options.parallel = false;
+    options.use_bvh = false;
+
+    if (mesh->get_surface_count() > 0) {
+        source_mesh = mesh;
+        source_cache = Ref<SliceableMeshCache>(cache);
+        source_mesh->connect("changed", Callable(this, "_on_mesh_changed"));
+
+        workspace.begin(mesh->get_surface_count());
+        stage = STAGE_PARSE;
+        stage_item = 0;
+        parse_offset = -1;
+    }
+}
+
+bool SliceJob::parse_step() {
+    Intersector::SplitResult &result = workspace.split_results.ptrw()[stage_item];
+    MeshBuffer &surface = result.surface;
+
+    // Looked up every step, as the cache can drop the mesh from one to the next
+    const SliceableMeshCache::Entry *entry = nullptr;
+    if (source_cache.is_valid() && (parse_offset == -1 || parsing_from_cache)) {
+        entry = source_cache->find(source_mesh);
+    }
+
+    if (parse_offset == -1) {
+        result.reset();
+        parsing_from_cache = entry != nullptr;
+
+        if (parsing_from_cache) {
+            const MeshBuffer &cached = entry->surfaces[stage_item];
+            result.material = entry->materials[stage_item];
+            surface.format = cached.format;
+            surface.resize_vertices(cached.vertex_count());
+            surface.indices.resize(cached.indices.size());
+        } else {
+            // Same as MeshSnapshot::capture, only triangles get sliced
+            result.material = source_mesh->surface_get_material(stage_item);
+            if (source_mesh->surface_get_primitive_type(stage_item) == Mesh::PRIMITIVE_TRIANGLES) {
+                source_arrays = source_mesh->surface_get_arrays(stage_item);
+            }
+
+            if (options.collect_stats) {
+                workspace.source_array_bytes = MemoryTracker::arrays_bytes(source_arrays);
+            }
+            surface.begin_parse(source_arrays, source_mesh->surface_get_format(stage_item));
+        }
+
+        parse_offset = 0;
+    } else if (parsing_from_cache && !entry) {
+        // Evicted partway through, the mesh's own arrays are the same
+        parse_offset = -1;
+        return false;
+    } else {
+        int vertex_count = surface.vertex_count();
+        int end = MIN(parse_offset + STEP_VERTICES, vertex_count + (int)surface.indices.size());
+        int vertex_end = MIN(end, vertex_count);
+        int index_first = MAX(parse_offset, vertex_count) - vertex_count;
+        int index_count = end - vertex_count - index_first;
+
+        if (parsing_from_cache) {
+            const MeshBuffer &cached = entry->surfaces[stage_item];
+            if (vertex_end > parse_offset) {
+                surface.copy_vertices(cached, parse_offset, parse_offset, vertex_end - parse_offset);
+            }
+            if (index_count > 0) {
+                memcpy(surface.indices.ptr() + index_first, cached.indices.ptr() + index_first, index_count * sizeof(int));
+            }
+        } else {
+            uint32_t format = source_mesh->surface_get_format(stage_item);
+            if (vertex_end > parse_offset) {
+                surface.parse_vertices(source_arrays, format, parse_offset, vertex_end - parse_offset, options.specialized_kernels);
+            }
+            if (index_count > 0) {
+                surface.parse_indices(source_arrays, format, index_first, index_count);
+            }
+        }
+
+        parse_offset = end;
+    }
+
+    if (parse_offset < surface.vertex_count() + (int)surface.indices.size()) {
+        return false;
+    }
+
+    // Only one surface's arrays are ever held at a time, which the peak should reflect
+    if (options.collect_stats && !parsing_from_cache) {
+        workspace.sample_memory(workspace.halves);
+    }
+
+    source_arrays = Array();
+    parse_offset = -1;
+    return ++stage_item == workspace.split_results.size();
+}
+
+void SliceJob::_on_mesh_changed() {
+    if (stage != STAGE_PARSE || cancelled) {
+        return;
+    }
+
+    // Whatever was parsed so far is of the mesh as it was, so none of it can be kept
+    workspace.begin(source_mesh->get_surface_count());
+    source_arrays = Array();
+    stage_item = 0;
+    parse_offset = -1;
+}
+
+void SliceJob::release_source() {
+    if (source_mesh.is_valid() && source_mesh->is_connected("changed", Callable(this, "_on_mesh_changed"))) {
+        source_mesh->disconnect("changed", Callable(this, "_on_mesh_changed"));
+    }
+
+    source_mesh.unref();
+    source_cache.unref();
+    source_arrays = Array();
+}
+
+bool SliceJob::commit_surface() {
+    for (int i = 0; i < 2; i++) {
+        if (committed_meshes[i].is_null()) {
+            committed_meshes[i].instantiate();
+        }
+
+        int idx = committed_meshes[i]->get_surface_count();
+        if (idx < (int)workspace.halves[i].surface_arrays.size()) {
+            workspace.halves[i].commit_surface(committed_meshes[i].ptr(), idx);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SliceJob::step() {
+    ERR_FAIL_COND_V_MSG(!stepped, false, "Only jobs started with start_stepped can be stepped");
+
+    if (stage == STAGE_DONE) {
+        return false;
+    }
+
+    if (cancelled) {
+        release_source();
+        stepped_half.reset();
+        committed_meshes[0].unref();
+        committed_meshes[1].unref();
+        workspace = SliceWorkspace();
+        stage = STAGE_DONE;
+        return false;
+    }
+
+    TRACE_ZONE("SliceJob::step");
+    SliceTimings *timings = options.collect_stats ? &workspace.timings : nullptr;
+    uint64_t start = timings ? SliceTimings::now_usec() : 0;
+
+    switch (stage) {
+        case STAGE_PARSE: {
+            // The mesh can change to one without any surfaces partway through
+            bool parsed = workspace.split_results.size() == 0 || parse_step();
+
+            if (timings) {
+                timings->add(SliceTimings::PHASE_PARSE, start);
+            }
+
+            if (!parsed) {
+                break;
+            }
+
+            release_source();
+            if (timings) {
+                workspace.sample_memory(workspace.halves);
+            }
+
+            SlicePipeline::begin_split(workspace, options);
+            stepped_split.begin(plane, workspace.split_results.ptrw(), workspace.split_results.size(), options.specialized_kernels, workspace.parallel);
+            stage = STAGE_SPLIT;
+        } break;
+        case STAGE_SPLIT: {
+            if (!stepped_split.is_done()) {
+                SliceTimings::Phase phase = stepped_split.is_classifying() ? SliceTimings::PHASE_CLASSIFY : SliceTimings::PHASE_SPLIT;
+                stepped_split.step();
+
+                if (timings) {
+                    timings->add(phase, start);
+                }
+            }
+
+            if (!stepped_split.is_done()) {
+                break;
+            }
+
+            bool has_cut = SlicePipeline::gather_cut(workspace, timings);
+            if (timings) {
+                workspace.sample_memory(workspace.halves);
+            }
+
+            stage = has_cut ? STAGE_CAP : STAGE_COMMIT;
+        } break;
+        case STAGE_CAP: {
+            Triangulator::cap(workspace.cut_segments, workspace.intersection_points, plane.normal, workspace.triangulator, workspace.cross_section);
+
+            if (timings) {
+                timings->add(SliceTimings::PHASE_CAP, start);
+                workspace.sample_memory(workspace.halves);
+            }
+
+            stage = STAGE_SERIALIZE;
+            stage_item = 0;
+            stepped_half.begin(stage_item, workspace.split_results, workspace.cross_section, cross_section_material, options.indexed_output, options.specialized_kernels, workspace.halves, workspace.remaps, options.extras);
+        } break;
+        case STAGE_SERIALIZE: {
+            if (!stepped_half.is_done()) {
+                stepped_half.step();
+
+                if (timings) {
+                    timings->add(SliceTimings::PHASE_SERIALIZE, start);
+                }
+            }
+
+            if (!stepped_half.is_done()) {
+                break;
+            }
+
+            if (++stage_item < 2) {
+                stepped_half.begin(stage_item, workspace.split_results, workspace.cross_section, cross_section_material, options.indexed_output, options.specialized_kernels, workspace.halves, workspace.remaps, options.extras);
+                break;
+            }
+
+            if (timings) {
+                SlicePipeline::count_outputs(workspace.halves, *timings);
+                workspace.sample_memory(workspace.halves);
+            }
+
+            has_halves = true;
+            stage = STAGE_COMMIT;
+        } break;
+        default: {
+            if (has_halves && commit_surface()) {
+                if (timings) {
+                    timings->add(SliceTimings::PHASE_COMMIT, start);
+                }
+                break;
+            }
+
+            stage = STAGE_DONE;
+            commit(workspace.split_results.size() > 0);
+        }
+    }
+
+    return stage != STAGE_DONE;
+}
+
+void SliceJob::run_task(void *p_userdata) {
+    static_cast<SliceJob *>(p_userdata)->run();
+}
+
+void SliceJob::run() {
+    TRACE_ZONE("SliceJob::run");
+
+    if (!cancelled) {
+        uint64_t start = options.collect_stats ? SliceTimings::now_usec() : 0;
+        snapshot.parse(workspace.split_results, options.specialized_kernels);
+
+        if (options.collect_stats) {
+            workspace.timings.add(SliceTimings::PHASE_PARSE, start);
+            workspace.sample_memory(workspace.halves);
+        }
+    }
+
+    if (!cancelled) {
+        has_halves = SlicePipeline::build_halves(plane, workspace, cross_section_material, options, workspace.halves);
+    }
+
+    call_deferred("_finish");
+}
+
+void SliceJob::_finish() {
+    TRACE_ZONE("SliceJob::_finish");
+
+    if (task_id != -1) {
+        WorkerThreadPool::get_singleton()->wait_for_task_completion(task_id);
+    }
+
+    // The worker is done with us, whatever happens to hold the last reference
+    // to the job lets it go once we're out of here
+    Ref<SliceJob> keep_alive = self;
+    self.unref();
+
+    commit(task_id != -1);
+}
+
+void SliceJob::commit(bool parsed) {
+    snapshot.clear();
+
+    if (!cancelled) {
+        uint64_t start = options.collect_stats ? SliceTimings::now_usec() : 0;
+        if (has_halves && stepped) {
+            sliced_mesh = Ref<SlicedMesh>(memnew(SlicedMesh(committed_meshes[0], committed_meshes[1], workspace.halves[0], workspace.halves[1])));
+        } else if (has_halves) {
+            sliced_mesh = Ref<SlicedMesh>(memnew(SlicedMesh(workspace.halves[0], workspace.halves[1])));
+        }
+
+        if (options.collect_stats && parsed) {
+            workspace.timings.add(SliceTimings::PHASE_COMMIT, start);
+            stats = Ref<SliceStats>(memnew(SliceStats(workspace.timings)));
+            SliceMonitors::record(workspace.timings);
+        }
+
+        completed = true;
+    }
+
+    // A job only ever runs once, so there's no point holding on to any of it
+    workspace = SliceWorkspace();
+    committed_meshes[0].unref();
+    committed_meshes[1].unref();
+
+    if (completed) {
+        emit_signal("completed", sliced_mesh);
+    }
+}
+
+void SliceJob::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("cancel"), &SliceJob::cancel);
+    ClassDB::bind_method(D_METHOD("is_cancelled"), &SliceJob::is_cancelled);
+    ClassDB::bind_method(D_METHOD("is_completed"), &SliceJob::is_completed);
+    ClassDB::bind_method(D_METHOD("is_pending"), &SliceJob::is_pending);
+    ClassDB::bind_method(D_METHOD("get_sliced_mesh"), &SliceJob::get_sliced_mesh);
+    ClassDB::bind_method(D_METHOD("get_stats"), &SliceJob::get_stats);
+    ClassDB::bind_method(D_METHOD("set_priority", "priority"), &SliceJob::set_priority);
+    ClassDB::bind_method(D_METHOD("get_priority"), &SliceJob::get_priority);
+    ClassDB::bind_method(D_METHOD("_finish"), &SliceJob::_finish);
+    ClassDB::bind_method(D_METHOD("_on_mesh_changed"), &SliceJob::_on_mesh_changed);
+
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "priority"), "set_priority", "get_priority");
+
+    ADD_SIGNAL(MethodInfo("completed", PropertyInfo(Variant::OBJECT, "sliced_mesh", PROPERTY_HINT_RESOURCE_TYPE, "SlicedMesh")));
+}
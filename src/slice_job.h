@@ -0,0 +1,201 @@
+#ifndef SLICE_JOB_H
+#define SLICE_JOB_H
+
+#include <atomic>
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/classes/array_mesh.hpp>
+#include "slice_pipeline.h"
+#include "slice_stats.h"
+
+using namespace godot;
+
+/**
+ * Handle to a slice running in the background, see Slicer::slice_async. Parsing,
+ * splitting and building the vertex arrays happen on the WorkerThreadPool, only
+ * adding the finished surfaces to the new meshes happens back on the main thread.
+ * Either connect to completed or poll is_completed and get_sliced_mesh.
+ *
+ * Jobs handed out by a SliceScheduler run on the main thread instead, a step at a time,
+ * whenever the scheduler gets around to them
+*/
+class SliceJob : public RefCounted {
+    GDCLASS(SliceJob, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+    Plane plane;
+    Ref<Material> cross_section_material;
+    SlicePipeline::Options options;
+
+    // The mesh's surfaces as they were when the job was started, see start
+    SlicePipeline::MeshSnapshot snapshot;
+
+    SliceWorkspace workspace;
+    bool has_halves = false;
+
+    std::atomic<bool> cancelled;
+    bool completed = false;
+    Ref<SlicedMesh> sliced_mesh;
+    Ref<SliceStats> stats;
+
+    int64_t task_id = -1;
+
+    // Keeps the job alive while the worker is using it, even if nobody else holds on to it
+    Ref<SliceJob> self;
+
+    // Where a job started with start_stepped is up to, see step
+    enum Stage {
+        STAGE_PARSE,
+        STAGE_SPLIT,
+        STAGE_CAP,
+        STAGE_SERIALIZE,
+        STAGE_COMMIT,
+        STAGE_DONE,
+    };
+
+    // How many vertexes, or indices, a step parses. About as much work as a step of the split
+    static const int STEP_VERTICES = Intersector::PARALLEL_CHUNK_SIZE * 4;
+
+    bool stepped = false;
+    Stage stage = STAGE_DONE;
+
+    // The surface being parsed or the half being serialized
+    int stage_item = 0;
+
+    // How far into the surface being parsed the job is, through its vertexes and then its
+    // indices, or -1 if it has yet to start on it
+    int parse_offset = -1;
+    bool parsing_from_cache = false;
+
+    // What a job started with start_stepped parses its surfaces out of, a surface at a time.
+    // source_arrays holds the one surface being parsed if it didn't come from the cache
+    Ref<ArrayMesh> source_mesh;
+    Ref<SliceableMeshCache> source_cache;
+    Array source_arrays;
+
+    Intersector::SteppedSplit stepped_split;
+    SteppedHalfBuild stepped_half;
+
+    // The meshes the halves are committed to, a surface a step
+    Ref<ArrayMesh> committed_meshes[2];
+
+    // See set_priority
+    double priority = 0.0;
+
+    static void run_task(void *p_userdata);
+    void run();
+    void _finish();
+
+    /**
+     * Parses the next chunk of a stepped job's surfaces, copying a surface out of the engine
+     * first if it isn't cached. Returns true once every surface has been parsed
+    */
+    bool parse_step();
+
+    /**
+     * Starts a stepped job's parsing over, after the mesh changed partway through it
+    */
+    void _on_mesh_changed();
+
+    /**
+     * Lets go of the mesh a stepped job was parsing, once it's done with it
+    */
+    void release_source();
+
+    /**
+     * Adds the next surface of the halves to their meshes. Returns false if there are none left
+    */
+    bool commit_surface();
+
+    /**
+     * Adds the halves to the new meshes, if the plane cut through them, and emits completed
+     * unless the job was cancelled. Lets go of everything the job was working in either way.
+     * Stats only get kept if the slice got as far as parsing
+    */
+    void commit(bool parsed);
+
+public:
+    /**
+     * Snapshots the mesh's surfaces, from the cache if there is one, and hands the rest of the
+     * slice off to the WorkerThreadPool. Needs to be called on the main thread
+    */
+    void start(const Ref<ArrayMesh> &mesh, const Plane &p_plane, const Ref<Material> &p_cross_section_material, const SlicePipeline::Options &p_options, SliceableMeshCache *cache = nullptr);
+
+    /**
+     * Leaves the whole slice to calls to step on the main thread, reading the mesh's surfaces
+     * one at a time as it gets to them rather than snapshotting them up front. They're read
+     * out of the cache if it has the mesh already (see SliceableMeshCache::prepare), as a
+     * mesh that isn't cached would have to be parsed all at once to cache it. If the mesh
+     * changes before every surface has been read, the job starts over on what it changed to.
+     * Neither options.parallel nor options.use_bvh apply here
+    */
+    void start_stepped(const Ref<ArrayMesh> &mesh, const Plane &p_plane, const Ref<Material> &p_cross_section_material, const SlicePipeline::Options &p_options, SliceableMeshCache *cache = nullptr);
+
+    /**
+     * Runs the next step of a job started with start_stepped, which copies a surface out of
+     * the engine, parses a chunk of its vertexes or indices, splits a chunk of faces, caps the
+     * cut, serializes a chunk of faces of one of the halves or adds one surface to its mesh.
+     * Returns false once the job has completed or been cancelled.
+     *
+     * Copying a surface out and adding one to a mesh are a single engine call each, so those
+     * steps take as long as their surface is big. Capping the cut and working out a half's
+     * collision hull take a step each too, as chaining up the outline of the cut needs all of
+     * it at once, as does the hull every vertex of the half
+    */
+    bool step();
+
+    /**
+     * How urgent the job is to a SliceScheduler, which always steps the pending job with the
+     * lowest priority first, such as the distance to the camera. Can be changed while it's pending
+    */
+    void set_priority(double p_priority) {
+        priority = p_priority;
+    }
+    double get_priority() const {
+        return priority;
+    }
+
+    /**
+     * Stops the job at the next step of the slice. A cancelled job never emits completed.
+     * Does nothing if the job has already completed
+    */
+    void cancel() {
+        if (!completed) {
+            cancelled = true;
+        }
+    }
+
+    bool is_cancelled() const {
+        return cancelled;
+    }
+
+    bool is_completed() const {
+        return completed;
+    }
+
+    bool is_pending() const {
+        return !completed && !cancelled;
+    }
+
+    /**
+     * The result of the slice once the job has completed. Null if the plane missed
+     * the mesh, same as Slicer::slice_by_plane
+    */
+    Ref<SlicedMesh> get_sliced_mesh() const {
+        return sliced_mesh;
+    }
+
+    /**
+     * How the slice went once the job has completed, or null if its Slicer wasn't set to
+     * collect_stats or the plane missed the mesh. Only commit_usec was spent on the main thread
+    */
+    Ref<SliceStats> get_stats() const {
+        return stats;
+    }
+
+    SliceJob() : cancelled(false) {}
+};
+
+#endif // SLICE_JOB_H
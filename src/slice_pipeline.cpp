@@ -0,0 +1,197 @@
+#include "slice_pipeline.h"
+#include "utils/triangulator.h"
+
+namespace SlicePipeline {
+    void MeshSnapshot::capture(const Ref<ArrayMesh> &mesh, SliceableMeshCache *cache, bool specialized, bool with_bvh) {
+        clear();
+
+        if (cache) {
+            const SliceableMeshCache::Entry *entry = cache->fetch(mesh, specialized, with_bvh);
+            ERR_FAIL_NULL(entry);
+
+            materials = entry->materials;
+            parsed_surfaces = entry->surfaces;
+            if (with_bvh) {
+                bvhs = entry->bvhs;
+            }
+            is_parsed = true;
+            return;
+        }
+
+        for (int i = 0; i < mesh->get_surface_count(); i++) {
+            materials.push_back(mesh->surface_get_material(i));
+            surface_formats.push_back(mesh->surface_get_format(i));
+
+            // Slicer functionality really only makes sense in the context of a mesh composed of
+            // triangles. An empty array parses into an empty surface, same as parse_surface would
+            if (mesh->surface_get_primitive_type(i) == Mesh::PRIMITIVE_TRIANGLES) {
+                surface_arrays.push_back(mesh->surface_get_arrays(i));
+            } else {
+                surface_arrays.push_back(Array());
+            }
+        }
+    }
+
+    void MeshSnapshot::parse(Vector<Intersector::SplitResult> &split_results, bool specialized) const {
+        split_results.resize(surface_count());
+        Intersector::SplitResult *split_results_writer = split_results.ptrw();
+
+        for (int i = 0; i < surface_count(); i++) {
+            parse_surface(i, split_results_writer[i], specialized);
+        }
+    }
+
+    void MeshSnapshot::parse_surface(int idx, Intersector::SplitResult &r_result, bool specialized) const {
+        r_result.reset();
+        r_result.material = materials[idx];
+
+        if (is_parsed) {
+            r_result.surface = parsed_surfaces[idx];
+            r_result.bvh = (uint32_t)idx < bvhs.size() ? &bvhs[idx] : nullptr;
+        } else {
+            r_result.surface.parse_arrays(surface_arrays[idx], surface_formats[idx], specialized);
+        }
+    }
+
+    /**
+     * Does the actual work of split_surfaces, which times all of it
+    */
+    void split_each_surface(const Plane &plane, Intersector::SplitResult *split_results, int surface_count, const Options &options, Intersector::ParallelWorkspace *workspace, SliceTimings *r_timings) {
+        bool has_bvh = false;
+        for (int i = 0; i < surface_count; i++) {
+            has_bvh = has_bvh || split_results[i].bvh != nullptr;
+        }
+
+        if (options.parallel && !has_bvh) {
+            Intersector::split_surfaces_by_plane_parallel(plane, split_results, surface_count, options.specialized_kernels, workspace, r_timings);
+            return;
+        }
+
+        for (int i = 0; i < surface_count; i++) {
+            Intersector::SplitResult &result = split_results[i];
+
+            // With a BVH there's usually too little left to split to be worth the trip through the pool
+            if (result.bvh) {
+                Intersector::split_surface_by_plane(plane, result, *result.bvh, options.specialized_kernels);
+            } else if (options.parallel) {
+                Intersector::split_surfaces_by_plane_parallel(plane, &result, 1, options.specialized_kernels, workspace, r_timings);
+            } else {
+                Intersector::split_surface_by_plane(plane, result, options.specialized_kernels, r_timings);
+            }
+        }
+    }
+
+    void split_surfaces(const Plane &plane, Intersector::SplitResult *split_results, int surface_count, const Options &options, Intersector::ParallelWorkspace *workspace, SliceTimings *r_timings) {
+        if (!r_timings) {
+            split_each_surface(plane, split_results, surface_count, options, workspace, nullptr);
+            return;
+        }
+
+        // Classifying gets timed on its own along the way, whatever's left of the time is splitting
+        uint64_t start = SliceTimings::now_usec();
+        uint64_t classify_before = r_timings->usec[SliceTimings::PHASE_CLASSIFY];
+
+        split_each_surface(plane, split_results, surface_count, options, workspace, r_timings);
+
+        r_timings->add(SliceTimings::PHASE_SPLIT, start);
+        r_timings->usec[SliceTimings::PHASE_SPLIT] -= r_timings->usec[SliceTimings::PHASE_CLASSIFY] - classify_before;
+    }
+
+    void count_outputs(const MeshHalf *halves, SliceTimings &r_timings) {
+        for (int i = 0; i < 2; i++) {
+            for (uint32_t j = 0; j < halves[i].surface_arrays.size(); j++) {
+                const Array &arrays = halves[i].surface_arrays[j];
+                int vertex_count = PackedVector3Array(arrays[Mesh::ARRAY_VERTEX]).size();
+                int index_count = arrays[Mesh::ARRAY_INDEX].get_type() == Variant::NIL ? vertex_count : PackedInt32Array(arrays[Mesh::ARRAY_INDEX]).size();
+
+                r_timings.output_vertices += vertex_count;
+                r_timings.output_triangles += index_count / 3;
+            }
+        }
+    }
+
+    void begin_split(SliceWorkspace &workspace, const Options &options) {
+        if (options.collect_stats) {
+            for (int i = 0; i < workspace.split_results.size(); i++) {
+                workspace.timings.input_triangles += workspace.split_results[i].surface.face_count();
+                workspace.timings.input_vertices += workspace.split_results[i].surface.vertex_count();
+            }
+        }
+
+        workspace.reserve_outputs();
+    }
+
+    bool gather_cut(SliceWorkspace &workspace, SliceTimings *r_timings) {
+        int surface_count = workspace.split_results.size();
+        Intersector::SplitResult *split_results_writer = workspace.split_results.ptrw();
+
+        // The upper and lower meshes will share the same intersection points
+        LocalVector<Vector3> &intersection_points = workspace.intersection_points;
+        LocalVector<Vector3> &cut_segments = workspace.cut_segments;
+        intersection_points.clear();
+        cut_segments.clear();
+
+        for (int i = 0; i < surface_count; i++) {
+            Intersector::SplitResult &results = split_results_writer[i];
+
+            for (uint32_t j = 0; j < results.intersection_points.size(); j++) {
+                intersection_points.push_back(results.intersection_points[j]);
+            }
+            results.intersection_points.clear();
+
+            for (uint32_t j = 0; j < results.cut_segments.size(); j++) {
+                cut_segments.push_back(results.cut_segments[j]);
+            }
+            results.cut_segments.clear();
+        }
+
+        if (r_timings) {
+            r_timings->intersection_points += intersection_points.size();
+        }
+
+        // If no intersection has occurred then there's really nothing for us to do
+        // but still, is this the expected behavior? Would it be better to return an
+        // actual SliceMesh with either the upper_mesh or lower_mesh null?
+        //
+        // A plane running exactly through a ring of vertexes only leaves segments behind,
+        // as every face it touches lies against it along an edge rather than being crossed
+        return intersection_points.size() > 0 || cut_segments.size() > 0;
+    }
+
+    bool build_halves(const Plane &plane, SliceWorkspace &workspace, Ref<Material> cross_section_material, const Options &options, MeshHalf *r_halves) {
+        Vector<Intersector::SplitResult> &split_results = workspace.split_results;
+        SliceTimings *timings = options.collect_stats ? &workspace.timings : nullptr;
+
+        begin_split(workspace, options);
+        split_surfaces(plane, split_results.ptrw(), split_results.size(), options, &workspace.parallel, timings);
+
+        bool has_cut = gather_cut(workspace, timings);
+        if (timings) {
+            workspace.sample_memory(r_halves);
+        }
+
+        if (!has_cut) {
+            return false;
+        }
+
+        uint64_t start = timings ? SliceTimings::now_usec() : 0;
+        MeshBuffer &cross_section = workspace.cross_section;
+        Triangulator::cap(workspace.cut_segments, workspace.intersection_points, plane.normal, workspace.triangulator, cross_section);
+
+        if (timings) {
+            timings->add(SliceTimings::PHASE_CAP, start);
+            workspace.sample_memory(r_halves);
+            start = SliceTimings::now_usec();
+        }
+
+        SlicedMesh::build_halves(split_results, cross_section, cross_section_material, options.indexed_output, options.specialized_kernels, options.parallel, r_halves, workspace.remaps, options.extras);
+
+        if (timings) {
+            timings->add(SliceTimings::PHASE_SERIALIZE, start);
+            count_outputs(r_halves, *timings);
+            workspace.sample_memory(r_halves);
+        }
+
+        return true;
+    }
+} // SlicePipeline
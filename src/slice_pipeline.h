@@ -0,0 +1,119 @@
+#ifndef SLICE_PIPELINE_H
+#define SLICE_PIPELINE_H
+
+#include "sliced_mesh.h"
+#include "sliceable_mesh_cache.h"
+#include "slice_workspace.h"
+
+/**
+ * The steps of a slice that come after the mesh's surfaces have been parsed, shared
+ * between the Slicer's blocking methods and SliceJob. None of these touch the engine,
+ * so they're fine to run off the main thread
+*/
+namespace SlicePipeline {
+    // The Slicer settings a slice runs with. Copied by value so a SliceJob that's
+    // already running isn't affected by later changes to its Slicer
+    struct Options {
+        bool indexed_output = true;
+        bool specialized_kernels = true;
+        bool parallel = false;
+        bool use_bvh = false;
+        HalfExtras extras;
+
+        // Whether build_halves fills in the workspace's timings, see Slicer::set_collect_stats
+        bool collect_stats = false;
+    };
+
+    /**
+     * The surfaces of a mesh as they were when captured, so they can be parsed off the
+     * main thread without going through the engine
+    */
+    struct MeshSnapshot {
+        LocalVector<Array> surface_arrays;
+        LocalVector<uint32_t> surface_formats;
+        LocalVector<Ref<Material>> materials;
+
+        // Already parsed surfaces, used instead of the arrays when captured from a cache,
+        // along with their BVHs if those were asked for
+        LocalVector<MeshBuffer> parsed_surfaces;
+        LocalVector<TriangleBVH> bvhs;
+        bool is_parsed = false;
+
+        /**
+         * Copies the arrays of every surface of the mesh, or its already parsed surfaces if
+         * there's a cache. Needs to be called on the main thread
+        */
+        void capture(const Ref<ArrayMesh> &mesh, SliceableMeshCache *cache = nullptr, bool specialized = true, bool with_bvh = false);
+
+        /**
+         * Parses every captured surface into split_results, reusing whatever memory they
+         * already hold
+        */
+        void parse(Vector<Intersector::SplitResult> &split_results, bool specialized) const;
+
+        /**
+         * Parses just the surface at idx into r_result, see parse
+        */
+        void parse_surface(int idx, Intersector::SplitResult &r_result, bool specialized) const;
+
+        int surface_count() const {
+            return materials.size();
+        }
+
+        /**
+         * Bytes held by the captured arrays, see SliceWorkspace::source_array_bytes
+        */
+        uint64_t array_bytes() const {
+            uint64_t total = 0;
+            for (uint32_t i = 0; i < surface_arrays.size(); i++) {
+                total += MemoryTracker::arrays_bytes(surface_arrays[i]);
+            }
+            return total;
+        }
+
+        void clear() {
+            surface_arrays.clear();
+            surface_formats.clear();
+            materials.clear();
+            parsed_surfaces.clear();
+            bvhs.clear();
+            is_parsed = false;
+        }
+    };
+
+    /**
+     * Splits each of the parsed surfaces by the plane, either one after another or spread
+     * across the WorkerThreadPool depending on options.parallel. Surfaces that have a BVH
+     * are always split through it, on the calling thread. If given, the time spent
+     * classifying and splitting is added to r_timings
+    */
+    void split_surfaces(const Plane &plane, Intersector::SplitResult *split_results, int surface_count, const Options &options, Intersector::ParallelWorkspace *workspace = nullptr, SliceTimings *r_timings = nullptr);
+
+    /**
+     * Readies the workspace's parsed split_results for splitting, counting what went into the
+     * slice if options.collect_stats is set
+    */
+    void begin_split(SliceWorkspace &workspace, const Options &options);
+
+    /**
+     * Gathers the intersection points and cut segments of every split result into the
+     * workspace once they've all been split. Returns false if the plane left neither of them
+    */
+    bool gather_cut(SliceWorkspace &workspace, SliceTimings *r_timings = nullptr);
+
+    /**
+     * Adds up the faces and vertexes of every surface built for the halves
+    */
+    void count_outputs(const MeshHalf *halves, SliceTimings &r_timings);
+
+    /**
+     * Splits the surfaces parsed into the workspace's split_results by the plane, triangulates
+     * the cross section and builds the vertex arrays of both halves into r_halves, upper first.
+     * Returns false if the plane didn't intersect the mesh at all. With options.collect_stats
+     * the phases and counts of the slice get added to the workspace's timings, short of
+     * parsing and committing the halves which are up to the caller
+    */
+    bool build_halves(const Plane &plane, SliceWorkspace &workspace, Ref<Material> cross_section_material, const Options &options, MeshHalf *r_halves);
+} // SlicePipeline
+
+#endif // SLICE_PIPELINE_H
@@ -0,0 +1,94 @@
+#include "slice_scheduler.h"
+
+#include "utils/trace.h"
+
+Ref<SliceJob> SliceScheduler::schedule(const Ref<ArrayMesh> mesh, const Plane plane, const Ref<Material> cross_section_material, double priority) {
+    if (mesh.is_null()) {
+        return Ref<SliceJob>();
+    }
+
+    SlicePipeline::Options options = slicer.is_valid() ? slicer->get_options() : SlicePipeline::Options();
+    SliceableMeshCache *cache = slicer.is_valid() ? slicer->get_cache().ptr() : nullptr;
+
+    Ref<SliceJob> job;
+    job.instantiate();
+    job->set_priority(priority);
+    job->start_stepped(mesh, plane, cross_section_material, options, cache);
+
+    jobs.push_back(job);
+    return job;
+}
+
+Ref<SliceJob> SliceScheduler::next_job() {
+    Ref<SliceJob> next;
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < jobs.size(); i++) {
+        if (!jobs[i]->is_pending()) {
+            continue;
+        }
+
+        if (next.is_null() || jobs[i]->get_priority() < next->get_priority()) {
+            next = jobs[i];
+        }
+        jobs[kept++] = jobs[i];
+    }
+
+    jobs.resize(kept);
+    return next;
+}
+
+int SliceScheduler::run(int64_t usec) {
+    TRACE_ZONE("SliceScheduler::run");
+    uint64_t deadline = SliceTimings::now_usec() + MAX(usec, (int64_t)0);
+    int steps = 0;
+
+    do {
+        // Held on to here as completed might well drop the scheduler's reference to it
+        Ref<SliceJob> job = next_job();
+        if (job.is_null()) {
+            break;
+        }
+
+        job->step();
+        steps++;
+    } while (SliceTimings::now_usec() < deadline);
+
+    return steps;
+}
+
+void SliceScheduler::cancel_all() {
+    for (uint32_t i = 0; i < jobs.size(); i++) {
+        jobs[i]->cancel();
+    }
+    jobs.clear();
+}
+
+int SliceScheduler::get_pending_count() const {
+    int count = 0;
+    for (uint32_t i = 0; i < jobs.size(); i++) {
+        count += jobs[i]->is_pending();
+    }
+    return count;
+}
+
+void SliceScheduler::_process(double delta) {
+    if (jobs.size() > 0) {
+        run(budget_usec);
+    }
+}
+
+void SliceScheduler::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("schedule", "mesh", "plane", "cross_section_material", "priority"), &SliceScheduler::schedule, DEFVAL(0.0));
+    ClassDB::bind_method(D_METHOD("run", "usec"), &SliceScheduler::run);
+    ClassDB::bind_method(D_METHOD("cancel_all"), &SliceScheduler::cancel_all);
+    ClassDB::bind_method(D_METHOD("get_pending_count"), &SliceScheduler::get_pending_count);
+
+    ClassDB::bind_method(D_METHOD("set_budget_usec", "budget_usec"), &SliceScheduler::set_budget_usec);
+    ClassDB::bind_method(D_METHOD("get_budget_usec"), &SliceScheduler::get_budget_usec);
+    ClassDB::bind_method(D_METHOD("set_slicer", "slicer"), &SliceScheduler::set_slicer);
+    ClassDB::bind_method(D_METHOD("get_slicer"), &SliceScheduler::get_slicer);
+
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "budget_usec"), "set_budget_usec", "get_budget_usec");
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "slicer", PROPERTY_HINT_RESOURCE_TYPE, "Slicer"), "set_slicer", "get_slicer");
+}
@@ -0,0 +1,79 @@
+#ifndef SLICE_SCHEDULER_H
+#define SLICE_SCHEDULER_H
+
+#include <godot_cpp/classes/node.hpp>
+#include "slicer.h"
+
+using namespace godot;
+
+/**
+ * Runs slices on the main thread a step at a time, so a burst of them gets spread across
+ * frames rather than stalling one. Every frame the scheduler steps its pending jobs for up to
+ * budget_usec, always picking the most urgent one (see SliceJob::set_priority) next, and
+ * leaves the rest for later frames. A step is a single surface parsed, a chunk of faces split,
+ * a cut capped, a half serialized or committed, so it can overrun the budget by about one
+ * of those. Add it to the scene tree for it to run, or call run yourself
+*/
+class SliceScheduler : public Node {
+    GDCLASS(SliceScheduler, Node);
+
+protected:
+    static void _bind_methods();
+
+    int64_t budget_usec = 2000;
+    Ref<Slicer> slicer;
+
+    // In the order they were scheduled, which breaks ties in priority
+    LocalVector<Ref<SliceJob>> jobs;
+
+    /**
+     * Drops the jobs that are no longer pending and returns the most urgent of the rest,
+     * or null if there are none
+    */
+    Ref<SliceJob> next_job();
+
+public:
+    /**
+     * Queues up a slice of the mesh by the plane, same as Slicer::slice_async, running with the
+     * settings of slicer as they are now. The lower the priority, the sooner it runs
+    */
+    Ref<SliceJob> schedule(const Ref<ArrayMesh> mesh, const Plane plane, const Ref<Material> cross_section_material, double priority = 0.0);
+
+    /**
+     * Steps the pending jobs until usec microseconds have gone by, always running at least
+     * one step if there's anything to do. Returns how many steps were run
+    */
+    int run(int64_t usec);
+
+    /**
+     * Cancels every pending job, none of them emit completed
+    */
+    void cancel_all();
+
+    int get_pending_count() const;
+
+    /**
+     * How long the jobs get to run every frame, in microseconds
+    */
+    void set_budget_usec(int64_t p_budget_usec) {
+        budget_usec = MAX(p_budget_usec, (int64_t)0);
+    }
+    int64_t get_budget_usec() const {
+        return budget_usec;
+    }
+
+    /**
+     * The Slicer whose settings and cache the jobs get started with, or its defaults if null.
+     * Its parallel and use_bvh settings don't apply, see SliceJob::start_stepped
+    */
+    void set_slicer(const Ref<Slicer> &p_slicer) {
+        slicer = p_slicer;
+    }
+    Ref<Slicer> get_slicer() const {
+        return slicer;
+    }
+
+    void _process(double delta) override;
+};
+
+#endif // SLICE_SCHEDULER_H
@@ -0,0 +1,147 @@
+#include "slice_stats.h"
+
+#include <godot_cpp/classes/performance.hpp>
+
+void SliceStats::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("get_parse_usec"), &SliceStats::get_parse_usec);
+    ClassDB::bind_method(D_METHOD("get_classify_usec"), &SliceStats::get_classify_usec);
+    ClassDB::bind_method(D_METHOD("get_split_usec"), &SliceStats::get_split_usec);
+    ClassDB::bind_method(D_METHOD("get_cap_usec"), &SliceStats::get_cap_usec);
+    ClassDB::bind_method(D_METHOD("get_serialize_usec"), &SliceStats::get_serialize_usec);
+    ClassDB::bind_method(D_METHOD("get_commit_usec"), &SliceStats::get_commit_usec);
+    ClassDB::bind_method(D_METHOD("get_total_usec"), &SliceStats::get_total_usec);
+    ClassDB::bind_method(D_METHOD("get_input_triangles"), &SliceStats::get_input_triangles);
+    ClassDB::bind_method(D_METHOD("get_input_vertices"), &SliceStats::get_input_vertices);
+    ClassDB::bind_method(D_METHOD("get_output_triangles"), &SliceStats::get_output_triangles);
+    ClassDB::bind_method(D_METHOD("get_output_vertices"), &SliceStats::get_output_vertices);
+    ClassDB::bind_method(D_METHOD("get_intersection_points"), &SliceStats::get_intersection_points);
+    ClassDB::bind_method(D_METHOD("get_bytes_allocated"), &SliceStats::get_bytes_allocated);
+    ClassDB::bind_method(D_METHOD("get_allocations"), &SliceStats::get_allocations);
+    ClassDB::bind_method(D_METHOD("get_peak_bytes"), &SliceStats::get_peak_bytes);
+
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "parse_usec"), "", "get_parse_usec");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "classify_usec"), "", "get_classify_usec");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "split_usec"), "", "get_split_usec");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "cap_usec"), "", "get_cap_usec");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "serialize_usec"), "", "get_serialize_usec");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "commit_usec"), "", "get_commit_usec");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "total_usec"), "", "get_total_usec");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "input_triangles"), "", "get_input_triangles");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "input_vertices"), "", "get_input_vertices");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "output_triangles"), "", "get_output_triangles");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "output_vertices"), "", "get_output_vertices");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "intersection_points"), "", "get_intersection_points");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "bytes_allocated"), "", "get_bytes_allocated");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "allocations"), "", "get_allocations");
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "peak_bytes"), "", "get_peak_bytes");
+}
+
+SliceMonitors *SliceMonitors::singleton = nullptr;
+
+// The ids the monitors go by in Performance, and the getter each one calls
+static const char *MONITORS[][2] = {
+    { "Slicer/slices_per_second", "get_slices_per_second" },
+    { "Slicer/average_slice_msec", "get_average_slice_msec" },
+    { "Slicer/max_slice_msec", "get_max_slice_msec" },
+    { "Slicer/triangles_processed", "get_triangles_processed" },
+    { "Slicer/peak_slice_bytes", "get_peak_slice_bytes" },
+};
+
+static const int MONITOR_COUNT = sizeof(MONITORS) / sizeof(MONITORS[0]);
+static const uint64_t WINDOW_USEC = 1000000;
+
+void SliceMonitors::create() {
+    ERR_FAIL_COND(singleton != nullptr);
+    singleton = memnew(SliceMonitors);
+    singleton->window_start = SliceTimings::now_usec();
+
+    Performance *performance = Performance::get_singleton();
+    for (int i = 0; i < MONITOR_COUNT; i++) {
+        performance->add_custom_monitor(MONITORS[i][0], Callable(singleton, MONITORS[i][1]));
+    }
+}
+
+void SliceMonitors::destroy() {
+    if (!singleton) {
+        return;
+    }
+
+    Performance *performance = Performance::get_singleton();
+    for (int i = 0; i < MONITOR_COUNT; i++) {
+        if (performance->has_custom_monitor(MONITORS[i][0])) {
+            performance->remove_custom_monitor(MONITORS[i][0]);
+        }
+    }
+
+    memdelete(singleton);
+    singleton = nullptr;
+}
+
+void SliceMonitors::roll_window(uint64_t now) {
+    uint64_t elapsed = now - window_start;
+    if (elapsed < WINDOW_USEC) {
+        return;
+    }
+
+    slices_per_second = window_slices * 1000000.0 / elapsed;
+    average_msec = window_slices > 0 ? window_usec / (window_slices * 1000.0) : 0.0;
+    max_msec = window_max_usec / 1000.0;
+
+    window_start = now;
+    window_slices = 0;
+    window_usec = 0;
+    window_max_usec = 0;
+}
+
+void SliceMonitors::record(const SliceTimings &timings) {
+    if (!singleton) {
+        return;
+    }
+
+    uint64_t total = timings.total_usec();
+
+    std::lock_guard<std::mutex> lock(singleton->mutex);
+    singleton->roll_window(SliceTimings::now_usec());
+
+    singleton->window_slices++;
+    singleton->window_usec += total;
+    singleton->window_max_usec = MAX(singleton->window_max_usec, total);
+    singleton->triangles_processed += timings.input_triangles;
+    singleton->peak_slice_bytes = MAX(singleton->peak_slice_bytes, timings.peak_bytes);
+}
+
+double SliceMonitors::get_slices_per_second() {
+    std::lock_guard<std::mutex> lock(mutex);
+    roll_window(SliceTimings::now_usec());
+    return slices_per_second;
+}
+
+double SliceMonitors::get_average_slice_msec() {
+    std::lock_guard<std::mutex> lock(mutex);
+    roll_window(SliceTimings::now_usec());
+    return average_msec;
+}
+
+double SliceMonitors::get_max_slice_msec() {
+    std::lock_guard<std::mutex> lock(mutex);
+    roll_window(SliceTimings::now_usec());
+    return max_msec;
+}
+
+int64_t SliceMonitors::get_triangles_processed() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return triangles_processed;
+}
+
+int64_t SliceMonitors::get_peak_slice_bytes() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return peak_slice_bytes;
+}
+
+void SliceMonitors::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("get_slices_per_second"), &SliceMonitors::get_slices_per_second);
+    ClassDB::bind_method(D_METHOD("get_average_slice_msec"), &SliceMonitors::get_average_slice_msec);
+    ClassDB::bind_method(D_METHOD("get_max_slice_msec"), &SliceMonitors::get_max_slice_msec);
+    ClassDB::bind_method(D_METHOD("get_triangles_processed"), &SliceMonitors::get_triangles_processed);
+    ClassDB::bind_method(D_METHOD("get_peak_slice_bytes"), &SliceMonitors::get_peak_slice_bytes);
+}
@@ -0,0 +1,166 @@
+#ifndef SLICE_STATS_H
+#define SLICE_STATS_H
+
+#include <mutex>
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include "utils/slice_timings.h"
+
+using namespace godot;
+
+/**
+ * How long each phase of a slice took, in microseconds, and how much it went through, along
+ * with estimates of the memory it took (see MemoryTracker). Handed out by
+ * Slicer::get_last_stats and SliceJob::get_stats when the Slicer was set to collect_stats
+*/
+class SliceStats : public RefCounted {
+    GDCLASS(SliceStats, RefCounted);
+
+protected:
+    static void _bind_methods();
+
+public:
+    SliceTimings timings;
+
+    int64_t get_parse_usec() const {
+        return timings.usec[SliceTimings::PHASE_PARSE];
+    }
+
+    int64_t get_classify_usec() const {
+        return timings.usec[SliceTimings::PHASE_CLASSIFY];
+    }
+
+    int64_t get_split_usec() const {
+        return timings.usec[SliceTimings::PHASE_SPLIT];
+    }
+
+    int64_t get_cap_usec() const {
+        return timings.usec[SliceTimings::PHASE_CAP];
+    }
+
+    int64_t get_serialize_usec() const {
+        return timings.usec[SliceTimings::PHASE_SERIALIZE];
+    }
+
+    /**
+     * Time spent adding the finished surfaces to the new meshes, add_surface_from_arrays
+    */
+    int64_t get_commit_usec() const {
+        return timings.usec[SliceTimings::PHASE_COMMIT];
+    }
+
+    int64_t get_total_usec() const {
+        return timings.total_usec();
+    }
+
+    int get_input_triangles() const {
+        return timings.input_triangles;
+    }
+
+    int get_input_vertices() const {
+        return timings.input_vertices;
+    }
+
+    int get_output_triangles() const {
+        return timings.output_triangles;
+    }
+
+    int get_output_vertices() const {
+        return timings.output_vertices;
+    }
+
+    int get_intersection_points() const {
+        return timings.intersection_points;
+    }
+
+    /**
+     * An estimate of the bytes the slice's buffers had to allocate, short of what they kept
+     * from earlier slices, going by how much they grew from one phase to the next. Includes
+     * the arrays copied out of the engine to parse the mesh and those handed over to the halves
+    */
+    int64_t get_bytes_allocated() const {
+        return timings.bytes_allocated;
+    }
+
+    /**
+     * An estimate of how many times the buffers grew, see get_bytes_allocated
+    */
+    int get_allocations() const {
+        return timings.allocations;
+    }
+
+    /**
+     * An estimate of the most the slice's buffers held at once, by their capacity. Only
+     * sampled at the end of each phase, so whatever a phase frees before it ends isn't in it
+    */
+    int64_t get_peak_bytes() const {
+        return timings.peak_bytes;
+    }
+
+    SliceStats() {}
+
+    SliceStats(const SliceTimings &p_timings) {
+        timings = p_timings;
+    }
+};
+
+/**
+ * Adds up the stats of every slice into the engine's Performance monitors, under Slicer/,
+ * so they show up in the debugger's monitors tab. Slices only get recorded when their
+ * Slicer collects stats. The rates, average and max cover the last full second
+*/
+class SliceMonitors : public Object {
+    GDCLASS(SliceMonitors, Object);
+
+    static SliceMonitors *singleton;
+
+    std::mutex mutex;
+
+    uint64_t window_start = 0;
+    int window_slices = 0;
+    uint64_t window_usec = 0;
+    uint64_t window_max_usec = 0;
+
+    double slices_per_second = 0;
+    double average_msec = 0;
+    double max_msec = 0;
+    int64_t triangles_processed = 0;
+    uint64_t peak_slice_bytes = 0;
+
+    /**
+     * Publishes the numbers of the current window and starts a new one if it's been a
+     * second since it started. Needs the mutex to be held
+    */
+    void roll_window(uint64_t now);
+
+protected:
+    static void _bind_methods();
+
+public:
+    /**
+     * Creates the singleton and adds its monitors to Performance
+    */
+    static void create();
+
+    /**
+     * Removes the monitors and frees the singleton
+    */
+    static void destroy();
+
+    /**
+     * Adds a finished slice to the monitors. Safe to call from any thread
+    */
+    static void record(const SliceTimings &timings);
+
+    double get_slices_per_second();
+    double get_average_slice_msec();
+    double get_max_slice_msec();
+    int64_t get_triangles_processed();
+
+    /**
+     * The highest peak_bytes of any slice so far, which makes it an estimate as well
+    */
+    int64_t get_peak_slice_bytes();
+};
+
+#endif // SLICE_STATS_H
@@ -0,0 +1,75 @@
+#include "slice_workspace.h"
+
+void SliceWorkspace::begin(int surface_count) {
+    split_results.resize(surface_count);
+
+    Intersector::SplitResult *split_results_writer = split_results.ptrw();
+    for (int i = 0; i < surface_count; i++) {
+        split_results_writer[i].reset();
+    }
+
+    intersection_points.clear();
+    cut_segments.clear();
+    halves[0].clear();
+    halves[1].clear();
+}
+
+void SliceWorkspace::reserve_outputs() {
+    Intersector::SplitResult *split_results_writer = split_results.ptrw();
+    int total_faces = 0;
+
+    for (int i = 0; i < split_results.size(); i++) {
+        Intersector::SplitResult &result = split_results_writer[i];
+        int index_count = result.surface.indices.size();
+
+        result.upper_indices.reserve(index_count);
+        result.lower_indices.reserve(index_count);
+        result.distances.reserve(result.surface.vertex_count());
+        result.sides.reserve(result.surface.vertex_count());
+
+        total_faces += result.surface.face_count();
+    }
+
+    // No telling how many faces the plane is going to cross before it does, this is plenty
+    // for most cuts and whatever it grows to gets kept for the next one anyway
+    intersection_points.reserve(total_faces);
+    cut_segments.reserve(total_faces);
+}
+
+void SliceWorkspace::finish() {
+    Intersector::SplitResult *split_results_writer = split_results.ptrw();
+    for (int i = 0; i < split_results.size(); i++) {
+        split_results_writer[i].material.unref();
+    }
+
+    halves[0].clear();
+    halves[1].clear();
+}
+
+void SliceWorkspace::sample_memory(const MeshHalf *halves) {
+    MemoryTracker tracker(memory_watermarks);
+
+    tracker.add(intersection_points);
+    tracker.add(cut_segments);
+    cross_section.track_memory(tracker);
+    triangulator.track_memory(tracker);
+    tracker.add(remaps[0]);
+    tracker.add(remaps[1]);
+
+    halves[0].track_memory(tracker);
+    halves[1].track_memory(tracker);
+
+    tracker.add_fresh_bytes(source_array_bytes);
+    source_array_bytes = 0;
+
+    // These come in a different number for every mesh, so they go last to keep the buffers
+    // above matched up with their own watermarks
+    for (int i = 0; i < split_results.size(); i++) {
+        split_results[i].track_memory(tracker);
+    }
+    parallel.track_memory(tracker);
+
+    timings.bytes_allocated += tracker.bytes_allocated;
+    timings.allocations += tracker.allocations;
+    timings.peak_bytes = MAX(timings.peak_bytes, tracker.bytes);
+}
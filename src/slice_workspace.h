@@ -0,0 +1,67 @@
+#ifndef SLICE_WORKSPACE_H
+#define SLICE_WORKSPACE_H
+
+#include "sliced_mesh.h"
+#include "utils/triangulator.h"
+
+/**
+ * Everything a slice works in, meant to be kept around between slices. Nothing in here
+ * ever gets freed, only cleared, so once a workspace has sliced a mesh, slicing meshes of
+ * about the same size again only allocates for the vertex arrays handed over to the new
+ * meshes. A workspace can only be used by one slice at a time
+*/
+struct SliceWorkspace {
+    Vector<Intersector::SplitResult> split_results;
+
+    // The intersection points and cut segments of every surface, which the cross section gets built from
+    LocalVector<Vector3> intersection_points;
+    LocalVector<Vector3> cut_segments;
+    MeshBuffer cross_section;
+
+    Triangulator::Workspace triangulator;
+    Intersector::ParallelWorkspace parallel;
+
+    // SurfaceFiller's remapping for each half, as both can be built at the same time
+    LocalVector<int> remaps[2];
+
+    MeshHalf halves[2];
+
+    // See SlicePipeline::Options::collect_stats
+    SliceTimings timings;
+
+    // The most each buffer above has held, see MemoryTracker
+    LocalVector<uint64_t> memory_watermarks;
+
+    // Bytes of the arrays copied out of the engine with Mesh::surface_get_arrays to parse the
+    // mesh, which the next sample_memory counts as allocated and then clears. Left at 0 when
+    // the surfaces came already parsed out of a SliceableMeshCache
+    uint64_t source_array_bytes = 0;
+
+    /**
+     * Readies split_results for a mesh with surface_count surfaces, without
+     * letting go of the memory they already hold
+    */
+    void begin(int surface_count);
+
+    /**
+     * Reserves room in every split result for its faces once the surfaces have been parsed.
+     * That covers every slice but the ones that cut through a lot of faces, which only have
+     * to grow them the first time around
+    */
+    void reserve_outputs();
+
+    /**
+     * Drops the references left over from the last slice, its materials and the vertex
+     * arrays of the halves, while keeping hold of all the memory
+    */
+    void finish();
+
+    /**
+     * Adds up the memory held by every buffer of the workspace, along with the two halves
+     * being built into, into the allocations and peak of timings. Meant to be called at the
+     * end of each phase of a slice, at most once after the halves have been serialized
+    */
+    void sample_memory(const MeshHalf *halves);
+};
+
+#endif // SLICE_WORKSPACE_H
@@ -0,0 +1,160 @@
+#include "sliceable_mesh_cache.h"
+
+#include <godot_cpp/core/object.hpp>
+
+_FORCE_INLINE_ uint64_t cache_key(const Ref<ArrayMesh> &mesh) {
+    return mesh->get_rid().get_id();
+}
+
+/**
+ * Builds a BVH for every surface of the entry, returning how many bytes they take up
+*/
+int64_t build_bvhs(SliceableMeshCache::Entry &entry) {
+    int64_t bvh_memory = 0;
+
+    entry.bvhs.resize(entry.surfaces.size());
+    for (uint32_t i = 0; i < entry.surfaces.size(); i++) {
+        entry.bvhs[i].build(entry.surfaces[i]);
+        bvh_memory += entry.bvhs[i].memory_usage();
+    }
+
+    return bvh_memory;
+}
+
+const SliceableMeshCache::Entry *SliceableMeshCache::fetch(const Ref<ArrayMesh> &mesh, bool specialized, bool with_bvh) {
+    ERR_FAIL_COND_V(mesh.is_null(), nullptr);
+
+    uint64_t key = cache_key(mesh);
+    if (entries.has(key)) {
+        Entry &entry = entries[key];
+        entry.last_used = ++use_counter;
+
+        if (with_bvh && entry.bvhs.size() != entry.surfaces.size()) {
+            int64_t bvh_memory = build_bvhs(entry);
+            entry.memory_usage += bvh_memory;
+            memory_usage += bvh_memory;
+
+            evict_to(max_memory, key);
+            return &entries[key];
+        }
+
+        return &entry;
+    }
+
+    Entry &entry = entries[key];
+    entry.surfaces.resize(mesh->get_surface_count());
+    for (int i = 0; i < mesh->get_surface_count(); i++) {
+        entry.materials.push_back(mesh->surface_get_material(i));
+        entry.surfaces[i].parse_surface(**mesh, i, specialized);
+        entry.memory_usage += entry.surfaces[i].memory_usage();
+    }
+
+    if (with_bvh) {
+        entry.memory_usage += build_bvhs(entry);
+    }
+
+    Array binds;
+    binds.push_back(key);
+    entry.mesh_instance_id = mesh->get_instance_id();
+    entry.on_changed = Callable(this, "_on_mesh_changed").bindv(binds);
+    mesh->connect("changed", entry.on_changed);
+
+    entry.last_used = ++use_counter;
+    memory_usage += entry.memory_usage;
+
+    evict_to(max_memory, key);
+    return &entries[key];
+}
+
+const SliceableMeshCache::Entry *SliceableMeshCache::find(const Ref<ArrayMesh> &mesh) const {
+    ERR_FAIL_COND_V(mesh.is_null(), nullptr);
+    return entries.getptr(cache_key(mesh));
+}
+
+void SliceableMeshCache::erase(uint64_t key) {
+    if (!entries.has(key)) {
+        return;
+    }
+
+    Entry &entry = entries[key];
+
+    // The mesh may well be gone already, in which case so is the connection
+    Object *mesh = ObjectDB::get_instance(entry.mesh_instance_id);
+    if (mesh && mesh->is_connected("changed", entry.on_changed)) {
+        mesh->disconnect("changed", entry.on_changed);
+    }
+
+    memory_usage -= entry.memory_usage;
+    entries.erase(key);
+}
+
+void SliceableMeshCache::evict_to(int64_t memory_budget, uint64_t keep_key) {
+    // There's only ever a handful of meshes worth caching, so finding the least
+    // recently used one by going through all of them is fine
+    while (memory_usage > memory_budget) {
+        uint64_t oldest_key = keep_key;
+        uint64_t oldest_use = UINT64_MAX;
+
+        for (const KeyValue<uint64_t, Entry> &E : entries) {
+            if (E.key != keep_key && E.value.last_used < oldest_use) {
+                oldest_key = E.key;
+                oldest_use = E.value.last_used;
+            }
+        }
+
+        // Whatever was just fetched stays, even if it's bigger than the budget by itself
+        if (oldest_key == keep_key) {
+            return;
+        }
+
+        erase(oldest_key);
+    }
+}
+
+void SliceableMeshCache::_on_mesh_changed(uint64_t key) {
+    erase(key);
+}
+
+void SliceableMeshCache::evict(const Ref<ArrayMesh> mesh) {
+    ERR_FAIL_COND(mesh.is_null());
+    erase(cache_key(mesh));
+}
+
+bool SliceableMeshCache::has(const Ref<ArrayMesh> mesh) const {
+    ERR_FAIL_COND_V(mesh.is_null(), false);
+    return entries.has(cache_key(mesh));
+}
+
+void SliceableMeshCache::clear() {
+    LocalVector<uint64_t> keys;
+    for (const KeyValue<uint64_t, Entry> &E : entries) {
+        keys.push_back(E.key);
+    }
+
+    for (uint32_t i = 0; i < keys.size(); i++) {
+        erase(keys[i]);
+    }
+}
+
+void SliceableMeshCache::set_max_memory(int64_t p_max_memory) {
+    max_memory = p_max_memory;
+    evict_to(max_memory, 0);
+}
+
+SliceableMeshCache::~SliceableMeshCache() {
+    clear();
+}
+
+void SliceableMeshCache::_bind_methods() {
+    ClassDB::bind_method(D_METHOD("prepare", "mesh", "with_bvh"), &SliceableMeshCache::prepare, DEFVAL(false));
+    ClassDB::bind_method(D_METHOD("evict", "mesh"), &SliceableMeshCache::evict);
+    ClassDB::bind_method(D_METHOD("has", "mesh"), &SliceableMeshCache::has);
+    ClassDB::bind_method(D_METHOD("clear"), &SliceableMeshCache::clear);
+    ClassDB::bind_method(D_METHOD("get_memory_usage"), &SliceableMeshCache::get_memory_usage);
+    ClassDB::bind_method(D_METHOD("_on_mesh_changed", "key"), &SliceableMeshCache::_on_mesh_changed);
+
+    ClassDB::bind_method(D_METHOD("set_max_memory", "max_memory"), &SliceableMeshCache::set_max_memory);
+    ClassDB::bind_method(D_METHOD("get_max_memory"), &SliceableMeshCache::get_max_memory);
+
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "max_memory"), "set_max_memory", "get_max_memory");
+}
@@ -0,0 +1,89 @@
+#ifndef SLICEABLE_MESH_CACHE_H
+#define SLICEABLE_MESH_CACHE_H
+
+#include <godot_cpp/classes/ref_counted.hpp>
+#include <godot_cpp/classes/array_mesh.hpp>
+#include <godot_cpp/classes/material.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include "utils/mesh_buffer.h"
+#include "utils/triangle_bvh.h"
+
+using namespace godot;
+
+/**
+ * Keeps meshes around already parsed into MeshBuffers, so slicing the same mesh over
+ * and over doesn't have to copy its arrays out of the engine and parse them every time.
+ * Entries are keyed by the mesh's RID and dropped as soon as the mesh emits changed.
+ * Once the parsed meshes take up more than max_memory bytes, the ones that were used
+ * least recently get evicted. Hand one to Slicer.cache to use it
+*/
+class SliceableMeshCache : public RefCounted {
+    GDCLASS(SliceableMeshCache, RefCounted);
+
+public:
+    struct Entry {
+        LocalVector<MeshBuffer> surfaces;
+        LocalVector<Ref<Material>> materials;
+
+        // One per surface, only built once something asks for them
+        LocalVector<TriangleBVH> bvhs;
+
+        // For disconnecting from the mesh's changed signal once the entry goes away
+        uint64_t mesh_instance_id = 0;
+        Callable on_changed;
+
+        int64_t memory_usage = 0;
+        uint64_t last_used = 0;
+    };
+
+protected:
+    static void _bind_methods();
+
+    HashMap<uint64_t, Entry> entries;
+    int64_t max_memory = 64 * 1024 * 1024;
+    int64_t memory_usage = 0;
+    uint64_t use_counter = 0;
+
+    void _on_mesh_changed(uint64_t key);
+    void erase(uint64_t key);
+    void evict_to(int64_t memory_budget, uint64_t keep_key);
+
+public:
+    /**
+     * Returns the parsed surfaces of the mesh, parsing and caching it first if it isn't yet,
+     * and builds their BVHs too if with_bvh is set. The entry stays valid until the cache is
+     * next changed, so it should be used or copied out of right away. Main thread only
+    */
+    const Entry *fetch(const Ref<ArrayMesh> &mesh, bool specialized = true, bool with_bvh = false);
+
+    /**
+     * The entry of the mesh if it's cached already, or null, without parsing it or counting
+     * it as used. Stays valid for as long as fetch's does
+    */
+    const Entry *find(const Ref<ArrayMesh> &mesh) const;
+
+    /**
+     * Parses the mesh, and builds its BVHs if with_bvh is set, ahead of time so its first
+     * slice doesn't have to
+    */
+    void prepare(const Ref<ArrayMesh> mesh, bool with_bvh = false) {
+        fetch(mesh, true, with_bvh);
+    }
+
+    void evict(const Ref<ArrayMesh> mesh);
+    bool has(const Ref<ArrayMesh> mesh) const;
+    void clear();
+
+    void set_max_memory(int64_t p_max_memory);
+    int64_t get_max_memory() const {
+        return max_memory;
+    }
+
+    int64_t get_memory_usage() const {
+        return memory_usage;
+    }
+
+    ~SliceableMeshCache();
+};
+
+#endif // SLICEABLE_MESH_CACHE_H
@@ -1,83 +1,261 @@
 #include "sliced_mesh.h"
 #include "utils/surface_filler.h"
+#include "utils/parallel.h"
+#include "utils/trace.h"
 
-/*
- * Creates a new surface composed of the uncut faces that were above the plane and the new faces generated
- * from the cut faces that fell on the plane
+/**
+ * Serializes the corners listed in indices from first up to end, in order, see
+ * VertexFormat::dispatch. When flip_winding is set the last two corners of every face are swapped
 */
-void create_surface(const Vector<SlicerFace> &faces, const Ref<Material> material, ArrayMesh &mesh) {
-    if (faces.size() == 0) {
-        return;
+struct SurfaceFillKernel {
+    SurfaceFiller &filler;
+    const LocalVector<int> &indices;
+    bool indexed;
+    bool flip_winding;
+    int first;
+    int end;
+
+    template <uint32_t FORMAT>
+    void run() {
+        int second = flip_winding ? 2 : 1;
+        int third = flip_winding ? 1 : 2;
+
+        if (indexed) {
+            for (int i = first; i < end; i += 3) {
+                filler.fill_indexed<FORMAT>(indices[i]);
+                filler.fill_indexed<FORMAT>(indices[i + second]);
+                filler.fill_indexed<FORMAT>(indices[i + third]);
+            }
+        } else {
+            for (int i = first; i < end; i += 3) {
+                filler.fill<FORMAT>(indices[i], i);
+                filler.fill<FORMAT>(indices[i + second], i + 1);
+                filler.fill<FORMAT>(indices[i + third], i + 2);
+            }
+        }
     }
+};
+
+Mesh* MeshHalf::commit() const {
+    TRACE_ZONE_COUNT("MeshHalf::commit", surface_arrays.size());
+    ArrayMesh *mesh = memnew(ArrayMesh);
 
-    SurfaceFiller filler(faces);
+    for (uint32_t i = 0; i < surface_arrays.size(); i++) {
+        commit_surface(mesh, i);
+    }
+
+    return mesh;
+}
+
+void MeshHalf::commit_surface(ArrayMesh *mesh, int idx) const {
+    mesh->add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, surface_arrays[idx]);
+    mesh->surface_set_material(idx, materials[idx]);
+}
+
+void MeshHalf::track_memory(MemoryTracker &tracker) const {
+    tracker.add(hull_marks);
+    tracker.add(hull_scratch);
+    tracker.add(hull_indices);
+    hull_workspace.track_memory(tracker);
+
+    uint64_t serialized = hull_points.size() * sizeof(Vector3);
+    for (uint32_t i = 0; i < surface_arrays.size(); i++) {
+        serialized += MemoryTracker::arrays_bytes(surface_arrays[i]);
+    }
+    tracker.add_fresh_bytes(serialized);
+}
 
-    for (int i = 0; i < faces.size() * 3; i++) {
-        filler.fill(i, i);
+void MeshHalf::add_surface(const MeshBuffer &surface, const LocalVector<int> &indices, const Ref<Material> material, bool indexed, bool specialized, bool flip_winding, LocalVector<int> *remap) {
+    int index_count = indices.size();
+    if (index_count == 0) {
+        return;
     }
 
-    filler.add_to_mesh(mesh, material);
+    TRACE_ZONE_COUNT("SurfaceFiller", index_count / 3);
+    SurfaceFiller filler(surface, index_count, indexed, remap);
+    filler.origin = origin;
+
+    SurfaceFillKernel kernel = { filler, indices, indexed, flip_winding, 0, index_count };
+    VertexFormat::dispatch(surface.format, kernel, specialized);
+
+    add_surface(filler.get_arrays(), material);
 }
 
 /**
- * Create a new surface of the cross section faces. This should be called twice: once for the upper_mesh
- * and again for the lower_mesh
+ * Picks out the point furthest along each of direction_count directions, spread evenly over
+ * the sphere along a Fibonacci spiral. Every point picked this way is a point of the hull
 */
-void create_cross_section_surface(const Vector<SlicerFace> &faces, const Ref<Material> material, ArrayMesh &mesh, bool is_upper) {
-    if (faces.size() == 0) {
-        return;
+void keep_extreme_points(const LocalVector<Vector3> &points, int direction_count, LocalVector<uint8_t> &marks, PackedVector3Array &r_kept) {
+    const real_t golden_angle = Math_PI * (3.0 - Math::sqrt(5.0));
+
+    marks.resize(points.size());
+    memset(marks.ptr(), 0, marks.size());
+
+    r_kept.resize(direction_count);
+    Vector3 *kept_writer = r_kept.ptrw();
+    int kept_count = 0;
+
+    for (int i = 0; i < direction_count; i++) {
+        real_t y = 1.0 - (i + 0.5) * 2.0 / direction_count;
+        real_t radius = Math::sqrt(1.0 - y * y);
+        real_t angle = golden_angle * i;
+        Vector3 direction(Math::cos(angle) * radius, y, Math::sin(angle) * radius);
+
+        int furthest = 0;
+        real_t furthest_distance = points[0].dot(direction);
+        for (uint32_t j = 1; j < points.size(); j++) {
+            real_t distance = points[j].dot(direction);
+            if (distance > furthest_distance) {
+                furthest = j;
+                furthest_distance = distance;
+            }
+        }
+
+        if (!marks[furthest]) {
+            marks[furthest] = 1;
+            kept_writer[kept_count++] = points[furthest];
+        }
     }
 
-    SurfaceFiller filler(faces);
+    r_kept.resize(kept_count);
+}
+
+void MeshHalf::add_hull_points(const Vector<Intersector::SplitResult> &surface_splits, bool is_upper, int budget) {
+    hull_scratch.clear();
 
-    for (int i = 0; i < faces.size(); i++) {
-        // The cross section faces have the same normal as the plane that cut
-        // them. That means that, for the upper half of the cut, we want to add
-        // the vertexes counterclockwise so that the normal is facing outwards
-        if (is_upper) {
-            filler.fill(i * 3, i * 3);
-            filler.fill(i * 3 + 1, i * 3 + 2);
-            filler.fill(i * 3 + 2, i * 3 + 1);
-        } else {
-            filler.fill(i * 3, i * 3);
-            filler.fill(i * 3 + 1, i * 3 + 1);
-            filler.fill(i * 3 + 2, i * 3 + 2);
+    // The cross section's points are the crossing vertexes the faces along the cut already use,
+    // so going through the faces of each surface covers the cap as well
+    for (int i = 0; i < surface_splits.size(); i++) {
+        const Intersector::SplitResult &split = surface_splits[i];
+        const LocalVector<int> &indices = is_upper ? split.upper_indices : split.lower_indices;
+
+        hull_marks.resize(split.surface.vertex_count());
+        memset(hull_marks.ptr(), 0, hull_marks.size());
+
+        for (uint32_t j = 0; j < indices.size(); j++) {
+            int idx = indices[j];
+            if (!hull_marks[idx]) {
+                hull_marks[idx] = 1;
+                hull_scratch.push_back(split.surface.vertices[idx] - origin);
+            }
         }
     }
 
-    filler.add_to_mesh(mesh, material);
+    if (hull_scratch.size() == 0) {
+        hull_points = PackedVector3Array();
+        return;
+    }
+
+    // The hull's points come in the order they were gathered, so they can be packed down in place.
+    // A flat half has no hull to speak of, and keeps every point
+    if (ConvexHull::compute(hull_scratch, hull_workspace, hull_indices)) {
+        for (uint32_t i = 0; i < hull_indices.size(); i++) {
+            hull_scratch[i] = hull_scratch[hull_indices[i]];
+        }
+        hull_scratch.resize(hull_indices.size());
+    }
+
+    if (budget > 0 && (int)hull_scratch.size() > budget) {
+        keep_extreme_points(hull_scratch, budget, hull_marks, hull_points);
+        return;
+    }
+
+    hull_points.resize(hull_scratch.size());
+    memcpy(hull_points.ptrw(), hull_scratch.ptr(), hull_scratch.size() * sizeof(Vector3));
 }
 
 /**
- * Creates either an upper or lower half of the sliced mesh
+ * Adds the faces listed in indices from first up to end to the mass properties
 */
-Mesh* create_mesh_half(
+_FORCE_INLINE_ void add_faces_to_mass(const MeshBuffer &surface, const LocalVector<int> &indices, int first, int end, bool flip_winding, MassProperties &mass) {
+    int second = flip_winding ? 2 : 1;
+    int third = flip_winding ? 1 : 2;
+
+    for (int i = first; i < end; i += 3) {
+        mass.add_face(surface.vertices[indices[i]], surface.vertices[indices[i + second]], surface.vertices[indices[i + third]]);
+    }
+}
+
+void MeshHalf::add_mass_properties(const Vector<Intersector::SplitResult> &surface_splits, const MeshBuffer &cross_section, bool is_upper) {
+    mass.clear();
+
+    for (int i = 0; i < surface_splits.size(); i++) {
+        const Intersector::SplitResult &split = surface_splits[i];
+        const LocalVector<int> &indices = is_upper ? split.upper_indices : split.lower_indices;
+        add_faces_to_mass(split.surface, indices, 0, indices.size(), false, mass);
+    }
+
+    // Without the cap the half would be open and the volume meaningless
+    add_faces_to_mass(cross_section, cross_section.indices, 0, cross_section.indices.size(), is_upper, mass);
+
+    mass.finish();
+}
+
+/**
+ * Builds the surfaces of either an upper or lower half of the sliced mesh
+*/
+void create_mesh_half(
     const Vector<Intersector::SplitResult> &surface_splits,
-    const Vector<SlicerFace> &cross_section_faces,
+    const MeshBuffer &cross_section,
     Ref<Material> cross_section_material,
-    bool is_upper
+    bool is_upper,
+    bool indexed,
+    bool specialized,
+    LocalVector<int> *remap,
+    const HalfExtras &extras,
+    MeshHalf &half
 ) {
-    ArrayMesh *mesh = memnew(ArrayMesh);
+    // Worked out up front so the vertexes can be written out already recentered
+    if (extras.mass_properties || extras.recenter) {
+        half.add_mass_properties(surface_splits, cross_section, is_upper);
+    }
+
+    if (extras.recenter) {
+        half.origin = half.mass.center_of_mass;
+    }
 
     for (int i = 0; i < surface_splits.size(); i++) {
-        if (is_upper) {
-            create_surface(surface_splits[i].upper_faces, surface_splits[i].material, *mesh);
-        } else {
-            create_surface(surface_splits[i].lower_faces, surface_splits[i].material, *mesh);
-        }
+        const Intersector::SplitResult &split = surface_splits[i];
+        // The uncut faces on this side of the plane along with the new faces generated from the cut ones
+        half.add_surface(split.surface, is_upper ? split.upper_indices : split.lower_indices, split.material, indexed, specialized, false, remap);
     }
 
 
-    if (cross_section_material.is_null() && mesh->get_surface_count() > 0) {
+    if (cross_section_material.is_null() && half.materials.size() > 0) {
         // I believe Ezy-Slice has a way of specifying the existing material to use,
         // we may want to add that as a TODO
-        cross_section_material = mesh->surface_get_material(0);
+        cross_section_material = half.materials[0];
     }
 
-    create_cross_section_surface(cross_section_faces, cross_section_material, *mesh, is_upper);
-    return mesh;
+    // The cross section faces have the same normal as the plane that cut
+    // them. That means that, for the upper half of the cut, we want to add
+    // the vertexes counterclockwise so that the normal is facing outwards
+    half.add_surface(cross_section, cross_section.indices, cross_section_material, indexed, specialized, is_upper, remap);
+
+    if (extras.hulls) {
+        half.add_hull_points(surface_splits, is_upper, extras.hull_budget);
+    }
 }
 
+/**
+ * Builds the upper half for index 0 and the lower half for index 1, see Parallel::for_each
+*/
+struct MeshHalfBuilder {
+    const Vector<Intersector::SplitResult> &surface_splits;
+    const MeshBuffer &cross_section;
+    Ref<Material> cross_section_material;
+    bool indexed;
+    bool specialized;
+    MeshHalf *halves;
+    LocalVector<int> *remaps;
+    const HalfExtras &extras;
+
+    void operator()(uint32_t idx) {
+        TRACE_ZONE(idx == 0 ? "build upper half" : "build lower half");
+        create_mesh_half(surface_splits, cross_section, cross_section_material, idx == 0, indexed, specialized, remaps ? &remaps[idx] : nullptr, extras, halves[idx]);
+    }
+};
+
 void SlicedMesh::_bind_methods() {
     ClassDB::bind_method(D_METHOD("set_upper_mesh", "mesh"), &SlicedMesh::set_upper_mesh);
     ClassDB::bind_method(D_METHOD("get_upper_mesh"), &SlicedMesh::get_upper_mesh);
@@ -86,9 +264,212 @@ void SlicedMesh::_bind_methods() {
 
     ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "upper_mesh", PROPERTY_HINT_RESOURCE_TYPE, "Mesh"), "set_upper_mesh", "get_upper_mesh");
     ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "lower_mesh", PROPERTY_HINT_RESOURCE_TYPE, "Mesh"), "set_lower_mesh", "get_lower_mesh");
+
+    ClassDB::bind_method(D_METHOD("get_upper_hull"), &SlicedMesh::get_upper_hull);
+    ClassDB::bind_method(D_METHOD("get_lower_hull"), &SlicedMesh::get_lower_hull);
+    ClassDB::bind_method(D_METHOD("get_upper_shape"), &SlicedMesh::get_upper_shape);
+    ClassDB::bind_method(D_METHOD("get_lower_shape"), &SlicedMesh::get_lower_shape);
+
+    ClassDB::bind_method(D_METHOD("get_upper_volume"), &SlicedMesh::get_upper_volume);
+    ClassDB::bind_method(D_METHOD("get_lower_volume"), &SlicedMesh::get_lower_volume);
+    ClassDB::bind_method(D_METHOD("get_upper_center_of_mass"), &SlicedMesh::get_upper_center_of_mass);
+    ClassDB::bind_method(D_METHOD("get_lower_center_of_mass"), &SlicedMesh::get_lower_center_of_mass);
+    ClassDB::bind_method(D_METHOD("get_upper_inertia"), &SlicedMesh::get_upper_inertia);
+    ClassDB::bind_method(D_METHOD("get_lower_inertia"), &SlicedMesh::get_lower_inertia);
+
+    ADD_PROPERTY(PropertyInfo(Variant::PACKED_VECTOR3_ARRAY, "upper_hull"), "", "get_upper_hull");
+    ADD_PROPERTY(PropertyInfo(Variant::PACKED_VECTOR3_ARRAY, "lower_hull"), "", "get_lower_hull");
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "upper_shape", PROPERTY_HINT_RESOURCE_TYPE, "ConvexPolygonShape3D"), "", "get_upper_shape");
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "lower_shape", PROPERTY_HINT_RESOURCE_TYPE, "ConvexPolygonShape3D"), "", "get_lower_shape");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "upper_volume"), "", "get_upper_volume");
+    ADD_PROPERTY(PropertyInfo(Variant::FLOAT, "lower_volume"), "", "get_lower_volume");
+    ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "upper_center_of_mass"), "", "get_upper_center_of_mass");
+    ADD_PROPERTY(PropertyInfo(Variant::VECTOR3, "lower_center_of_mass"), "", "get_lower_center_of_mass");
+    ADD_PROPERTY(PropertyInfo(Variant::BASIS, "upper_inertia"), "", "get_upper_inertia");
+    ADD_PROPERTY(PropertyInfo(Variant::BASIS, "lower_inertia"), "", "get_lower_inertia");
+}
+
+/**
+ * The shape for one of the halves, created from its hull the first time around
+*/
+Ref<ConvexPolygonShape3D> get_or_create_shape(const PackedVector3Array &hull, Ref<ConvexPolygonShape3D> &shape) {
+    if (shape.is_null() && hull.size() > 0) {
+        shape.instantiate();
+        shape->set_points(hull);
+    }
+
+    return shape;
+}
+
+Ref<ConvexPolygonShape3D> SlicedMesh::get_upper_shape() {
+    return get_or_create_shape(upper_hull, upper_shape);
+}
+
+Ref<ConvexPolygonShape3D> SlicedMesh::get_lower_shape() {
+    return get_or_create_shape(lower_hull, lower_shape);
+}
+
+void SlicedMesh::build_halves(const Vector<Intersector::SplitResult> &surface_splits, const MeshBuffer &cross_section, const Ref<Material> cross_section_material, bool indexed, bool specialized, bool parallel, MeshHalf *r_halves, LocalVector<int> *remaps, const HalfExtras &extras) {
+    MeshHalfBuilder builder = { surface_splits, cross_section, cross_section_material, indexed, specialized, r_halves, remaps, extras };
+
+    if (parallel) {
+        Parallel::for_each(2, builder, "Slicer build halves");
+    } else {
+        builder(0);
+        builder(1);
+    }
+}
+
+void SlicedMesh::build_half(int half, const Vector<Intersector::SplitResult> &surface_splits, const MeshBuffer &cross_section, const Ref<Material> cross_section_material, bool indexed, bool specialized, MeshHalf *r_halves, LocalVector<int> *remaps, const HalfExtras &extras) {
+    ERR_FAIL_INDEX(half, 2);
+    MeshHalfBuilder builder = { surface_splits, cross_section, cross_section_material, indexed, specialized, r_halves, remaps, extras };
+    builder(half);
+}
+
+SteppedHalfBuild::~SteppedHalfBuild() {
+    reset();
+}
+
+void SteppedHalfBuild::reset() {
+    if (filler) {
+        memdelete(filler);
+        filler = nullptr;
+    }
+    stage = STAGE_DONE;
+}
+
+void SteppedHalfBuild::begin(int p_half, const Vector<Intersector::SplitResult> &p_surface_splits, const MeshBuffer &p_cross_section, Ref<Material> p_cross_section_material, bool p_indexed, bool p_specialized, MeshHalf *r_halves, LocalVector<int> *remaps, const HalfExtras &p_extras) {
+    ERR_FAIL_INDEX(p_half, 2);
+    reset();
+
+    surface_splits = &p_surface_splits;
+    cross_section = &p_cross_section;
+    cross_section_material = p_cross_section_material;
+    is_upper = p_half == 0;
+    indexed = p_indexed;
+    specialized = p_specialized;
+    remap = remaps ? &remaps[p_half] : nullptr;
+    extras = p_extras;
+    half = &r_halves[p_half];
+
+    stage = extras.mass_properties || extras.recenter ? STAGE_MASS : STAGE_SURFACES;
+    source = 0;
+    next_index = 0;
+    if (stage == STAGE_MASS) {
+        half->mass.clear();
+    }
+    skip_finished_sources();
 }
 
-SlicedMesh::SlicedMesh(const Vector<Intersector::SplitResult> &surface_splits, const Vector<SlicerFace> &cross_section_faces, const Ref<Material> cross_section_material) {
-    upper_mesh = Ref<Mesh>(create_mesh_half(surface_splits, cross_section_faces, cross_section_material, true));
-    lower_mesh = Ref<Mesh>(create_mesh_half(surface_splits, cross_section_faces, cross_section_material, false));
+const MeshBuffer &SteppedHalfBuild::source_surface() const {
+    return source < surface_splits->size() ? (*surface_splits)[source].surface : *cross_section;
+}
+
+const LocalVector<int> &SteppedHalfBuild::source_indices() const {
+    if (source == surface_splits->size()) {
+        return cross_section->indices;
+    }
+
+    const Intersector::SplitResult &split = (*surface_splits)[source];
+    return is_upper ? split.upper_indices : split.lower_indices;
+}
+
+void SteppedHalfBuild::skip_finished_sources() {
+    while (stage == STAGE_MASS || stage == STAGE_SURFACES) {
+        if (next_index < (int)source_indices().size()) {
+            return;
+        }
+
+        if (source < surface_splits->size()) {
+            source++;
+            next_index = 0;
+            continue;
+        }
+
+        source = 0;
+        next_index = 0;
+
+        if (stage == STAGE_MASS) {
+            half->mass.finish();
+            if (extras.recenter) {
+                half->origin = half->mass.center_of_mass;
+            }
+            stage = STAGE_SURFACES;
+        } else {
+            stage = extras.hulls ? STAGE_HULL : STAGE_DONE;
+        }
+    }
+}
+
+bool SteppedHalfBuild::step() {
+    ERR_FAIL_COND_V(stage == STAGE_DONE, true);
+
+    // The cross section faces the other way on the upper half, see create_mesh_half
+    bool flip_winding = source == surface_splits->size() && is_upper;
+
+    switch (stage) {
+        case STAGE_MASS: {
+            const LocalVector<int> &indices = source_indices();
+            int end = MIN(next_index + STEP_FACES * 3, (int)indices.size());
+            add_faces_to_mass(source_surface(), indices, next_index, end, flip_winding, half->mass);
+            next_index = end;
+        } break;
+        case STAGE_SURFACES: {
+            const MeshBuffer &surface = source_surface();
+            const LocalVector<int> &indices = source_indices();
+
+            if (!filler) {
+                filler = memnew(SurfaceFiller(surface, indices.size(), indexed, remap));
+                filler->origin = half->origin;
+            }
+
+            int end = MIN(next_index + STEP_FACES * 3, (int)indices.size());
+            SurfaceFillKernel kernel = { *filler, indices, indexed, flip_winding, next_index, end };
+            VertexFormat::dispatch(surface.format, kernel, specialized);
+            next_index = end;
+
+            if (next_index < (int)indices.size()) {
+                break;
+            }
+
+            Ref<Material> material;
+            if (source < surface_splits->size()) {
+                material = (*surface_splits)[source].material;
+            } else {
+                material = cross_section_material.is_null() && half->materials.size() > 0 ? half->materials[0] : cross_section_material;
+            }
+
+            half->add_surface(filler->get_arrays(), material);
+            memdelete(filler);
+            filler = nullptr;
+        } break;
+        default: {
+            half->add_hull_points(*surface_splits, is_upper, extras.hull_budget);
+            stage = STAGE_DONE;
+        }
+    }
+
+    skip_finished_sources();
+    return stage == STAGE_DONE;
+}
+
+SlicedMesh::SlicedMesh(const MeshHalf &upper, const MeshHalf &lower) :
+        SlicedMesh(Ref<Mesh>(upper.commit()), Ref<Mesh>(lower.commit()), upper, lower) {
+}
+
+SlicedMesh::SlicedMesh(const Ref<Mesh> &p_upper_mesh, const Ref<Mesh> &p_lower_mesh, const MeshHalf &upper, const MeshHalf &lower) {
+    upper_mesh = p_upper_mesh;
+    lower_mesh = p_lower_mesh;
+    upper_hull = upper.hull_points;
+    lower_hull = lower.hull_points;
+    upper_mass = upper.mass;
+    lower_mass = lower.mass;
+}
+
+SlicedMesh::SlicedMesh(const Vector<Intersector::SplitResult> &surface_splits, const MeshBuffer &cross_section, const Ref<Material> cross_section_material, bool indexed, bool specialized, bool parallel) {
+    MeshHalf halves[2];
+    build_halves(surface_splits, cross_section, cross_section_material, indexed, specialized, parallel, halves);
+
+    upper_mesh = Ref<Mesh>(halves[0].commit());
+    lower_mesh = Ref<Mesh>(halves[1].commit());
 }
@@ -5,7 +5,173 @@
 #include <godot_cpp/classes/resource.hpp>
 //#include <godot-cpp/classes/mesh.hpp>
 #include <godot_cpp/classes/mesh.hpp>
+#include <godot_cpp/classes/convex_polygon_shape3d.hpp>
+#include "utils/convex_hull.h"
 #include "utils/intersector.h"
+#include "utils/mass_properties.h"
+
+/**
+ * What gets worked out about each half on top of its surfaces, see SlicedMesh::build_halves
+*/
+struct HalfExtras {
+    // See MeshHalf::add_hull_points
+    bool hulls = false;
+    int hull_budget = 0;
+
+    // See MeshHalf::add_mass_properties. Recentering needs the mass properties
+    // so it works them out either way
+    bool mass_properties = false;
+    bool recenter = false;
+};
+
+/**
+ * The vertex arrays and materials of every surface of one half of a sliced mesh.
+ * Building them doesn't touch the engine, so halves can be built off the main
+ * thread. Only commit, which creates the actual mesh, needs to happen on it
+*/
+struct MeshHalf {
+    LocalVector<Array> surface_arrays;
+    LocalVector<Ref<Material>> materials;
+
+    // The points a convex collision shape of the half can be built from, if they were asked for
+    PackedVector3Array hull_points;
+
+    // Scratch memory for add_hull_points
+    LocalVector<uint8_t> hull_marks;
+    LocalVector<Vector3> hull_scratch;
+    LocalVector<int> hull_indices;
+    ConvexHull::Workspace hull_workspace;
+
+    MassProperties mass;
+
+    // Subtracted from every vertex written out, so the half can be centered on its center of mass
+    Vector3 origin;
+
+    void add_surface(const Array &arrays, const Ref<Material> material) {
+        surface_arrays.push_back(arrays);
+        materials.push_back(material);
+    }
+
+    /**
+     * Serializes the faces of surface listed in indices into a new surface. Does nothing if
+     * there aren't any. See SlicedMesh for indexed and specialized, flip_winding swaps the
+     * last two corners of every face and remap is the SurfaceFiller's scratch memory
+    */
+    void add_surface(const MeshBuffer &surface, const LocalVector<int> &indices, const Ref<Material> material, bool indexed, bool specialized, bool flip_winding = false, LocalVector<int> *remap = nullptr);
+
+    /**
+     * Works out the convex hull of the vertexes used by the half's faces, cap included, and
+     * puts its points in hull_points, so the engine has nothing left to hull when it builds a
+     * shape from them. If there are more than budget of them (and budget isn't 0), only the
+     * ones furthest out in budget directions spread evenly around the sphere are kept. A flat
+     * half, which has no hull, keeps all of its vertexes
+    */
+    void add_hull_points(const Vector<Intersector::SplitResult> &surface_splits, bool is_upper, int budget);
+
+    /**
+     * Works out the mass properties of the half from its faces, cross section included,
+     * which should be wound the same way as the half's
+    */
+    void add_mass_properties(const Vector<Intersector::SplitResult> &surface_splits, const MeshBuffer &cross_section, bool is_upper);
+
+    Mesh* commit() const;
+
+    /**
+     * Adds the surface at idx to mesh, which should have every surface before it already.
+     * Lets committing be spread out a surface at a time, see SliceJob::step
+    */
+    void commit_surface(ArrayMesh *mesh, int idx) const;
+
+    /**
+     * Adds the half's scratch memory to the tracker, along with the arrays it has serialized,
+     * which are allocated anew every slice. See MemoryTracker
+    */
+    void track_memory(MemoryTracker &tracker) const;
+
+    void clear() {
+        surface_arrays.clear();
+        materials.clear();
+        hull_points = PackedVector3Array();
+        mass.clear();
+        origin = Vector3();
+    }
+};
+
+struct SurfaceFiller;
+
+/**
+ * SlicedMesh::build_half taken apart into steps, so a big half can be built across frames
+ * (see SliceJob::step). Each step either works up to STEP_FACES faces into the mass properties
+ * or serializes them, the halves come out the same as build_half's. Working out the hull is a
+ * single step however big the half is, as it needs every vertex of the half at once. The
+ * split results, cross section and halves need to stay put until it's done
+*/
+class SteppedHalfBuild {
+public:
+    static const int STEP_FACES = Intersector::PARALLEL_CHUNK_SIZE;
+
+private:
+    enum Stage {
+        STAGE_MASS,
+        STAGE_SURFACES,
+        STAGE_HULL,
+        STAGE_DONE,
+    };
+
+    const Vector<Intersector::SplitResult> *surface_splits = nullptr;
+    const MeshBuffer *cross_section = nullptr;
+    Ref<Material> cross_section_material;
+    bool is_upper = true;
+    bool indexed = true;
+    bool specialized = true;
+    LocalVector<int> *remap = nullptr;
+    HalfExtras extras;
+    MeshHalf *half = nullptr;
+
+    Stage stage = STAGE_DONE;
+
+    // The surface being worked through, the cross section coming after every split result,
+    // and the next of its indices
+    int source = 0;
+    int next_index = 0;
+
+    // Holds the arrays of the surface being serialized from one step to the next
+    SurfaceFiller *filler = nullptr;
+
+    const MeshBuffer &source_surface() const;
+    const LocalVector<int> &source_indices() const;
+
+    /**
+     * Moves on to the next surface, or the next stage, for as long as the current one has
+     * no faces left
+    */
+    void skip_finished_sources();
+
+public:
+    /**
+     * Starts building the half at p_half into r_halves, with the same arguments as build_half
+    */
+    void begin(int p_half, const Vector<Intersector::SplitResult> &p_surface_splits, const MeshBuffer &p_cross_section, Ref<Material> p_cross_section_material, bool p_indexed, bool p_specialized, MeshHalf *r_halves, LocalVector<int> *remaps = nullptr, const HalfExtras &p_extras = HalfExtras());
+
+    /**
+     * Runs the next step. Returns true once the half is built
+    */
+    bool step();
+
+    bool is_done() const {
+        return stage == STAGE_DONE;
+    }
+
+    /**
+     * Drops a half built partway, leaving whatever it got as far as in the half
+    */
+    void reset();
+
+    SteppedHalfBuild() {}
+    SteppedHalfBuild(const SteppedHalfBuild &) = delete;
+    SteppedHalfBuild &operator=(const SteppedHalfBuild &) = delete;
+    ~SteppedHalfBuild();
+};
 
 /**
  * A simple container for the results of a mesh slice.
@@ -23,6 +189,16 @@ public:
     Ref<Mesh> upper_mesh;
     Ref<Mesh> lower_mesh;
 
+    // See Slicer::set_build_collision_hulls. The shapes are only created when first asked for
+    PackedVector3Array upper_hull;
+    PackedVector3Array lower_hull;
+    Ref<ConvexPolygonShape3D> upper_shape;
+    Ref<ConvexPolygonShape3D> lower_shape;
+
+    // See Slicer::set_compute_mass_properties
+    MassProperties upper_mass;
+    MassProperties lower_mass;
+
 	void set_upper_mesh(const Ref<Mesh> &_upper_mesh) {
         upper_mesh = _upper_mesh;
     }
@@ -37,16 +213,83 @@ public:
         return lower_mesh;
     };
 
+    PackedVector3Array get_upper_hull() const {
+        return upper_hull;
+    }
+    PackedVector3Array get_lower_hull() const {
+        return lower_hull;
+    }
+
+    real_t get_upper_volume() const {
+        return upper_mass.volume;
+    }
+    real_t get_lower_volume() const {
+        return lower_mass.volume;
+    }
+
+    Vector3 get_upper_center_of_mass() const {
+        return upper_mass.center_of_mass;
+    }
+    Vector3 get_lower_center_of_mass() const {
+        return lower_mass.center_of_mass;
+    }
+
+    Basis get_upper_inertia() const {
+        return upper_mass.inertia;
+    }
+    Basis get_lower_inertia() const {
+        return lower_mass.inertia;
+    }
+
+    /**
+     * A convex shape around the upper half, or null if its hull wasn't built
+    */
+    Ref<ConvexPolygonShape3D> get_upper_shape();
+
+    /**
+     * A convex shape around the lower half, or null if its hull wasn't built
+    */
+    Ref<ConvexPolygonShape3D> get_lower_shape();
+
     SlicedMesh(Ref<Mesh> _upper_mesh, Ref<Mesh> _lower_mesh) {
         upper_mesh = _upper_mesh;
         lower_mesh = _lower_mesh;
     }
 
     /**
-     * Transforms a vector of split results and a vector of faces representing
-     * the cross section of a slice and creates an upper and lower mesh from them
+     * Transforms a vector of split results and a buffer holding the faces of
+     * the cross section of a slice and creates an upper and lower mesh from them.
+     * When indexed is set the surfaces are built with an index array, sharing every
+     * vertex that survived the cut instead of writing out three per face. See
+     * VertexFormat::dispatch for specialized. When parallel is set the vertex arrays of
+     * both halves are built at the same time on the WorkerThreadPool
+    */
+    SlicedMesh(const Vector<Intersector::SplitResult> &surface_splits, const MeshBuffer &cross_section, Ref<Material> cross_section_material, bool indexed = false, bool specialized = true, bool parallel = false);
+
+    /**
+     * Commits halves that were already built with build_halves
+    */
+    SlicedMesh(const MeshHalf &upper, const MeshHalf &lower);
+
+    /**
+     * Takes meshes the halves were already committed to, a surface at a time say, along with
+     * everything else that was worked out about them
+    */
+    SlicedMesh(const Ref<Mesh> &p_upper_mesh, const Ref<Mesh> &p_lower_mesh, const MeshHalf &upper, const MeshHalf &lower);
+
+    /**
+     * Does everything the constructor above does short of creating the meshes, filling
+     * r_halves with the upper half followed by the lower one. If given, remaps holds the
+     * indexed remapping scratch memory of each half. extras picks whatever else gets worked
+     * out about the halves
+    */
+    static void build_halves(const Vector<Intersector::SplitResult> &surface_splits, const MeshBuffer &cross_section, Ref<Material> cross_section_material, bool indexed, bool specialized, bool parallel, MeshHalf *r_halves, LocalVector<int> *remaps = nullptr, const HalfExtras &extras = HalfExtras());
+
+    /**
+     * Builds only one of the halves into r_halves, 0 for the upper one and 1 for the lower,
+     * the same way build_halves does
     */
-    SlicedMesh(const Vector<Intersector::SplitResult> &surface_splits, const Vector<SlicerFace> &cross_section_faces, Ref<Material> cross_section_material);
+    static void build_half(int half, const Vector<Intersector::SplitResult> &surface_splits, const MeshBuffer &cross_section, Ref<Material> cross_section_material, bool indexed, bool specialized, MeshHalf *r_halves, LocalVector<int> *remaps = nullptr, const HalfExtras &extras = HalfExtras());
 
     SlicedMesh() {}
 };
@@ -1,112 +1,252 @@
 #include "slicer.h"
-#include "utils/slicer_face.h"
+
+#include <atomic>
+
+#include <godot_cpp/classes/os.hpp>
+#include <godot_cpp/classes/file_access.hpp>
+#include <godot_cpp/classes/project_settings.hpp>
+
+#include "utils/mesh_buffer.h"
 #include "utils/intersector.h"
-#include "utils/triangulator.h"
+#include "utils/fracture.h"
+#include "slice_pipeline.h"
+#include "utils/parallel.h"
+#include "utils/trace.h"
 
-Ref<SlicedMesh> Slicer::slice_by_plane(const Ref<ArrayMesh> mesh, const Plane plane, const Ref<Material> cross_section_material) {
-    // TODO - This function is a little heavy. Maybe we should break it up
-    if (mesh.is_null()) {
-        return Ref<SlicedMesh>();
-    }
+SlicePipeline::Options Slicer::get_options() const {
+    SlicePipeline::Options options;
+    options.indexed_output = indexed_output;
+    options.specialized_kernels = specialized_kernels;
+    options.parallel = parallel;
+    options.use_bvh = use_bvh;
+    options.extras.hulls = build_collision_hulls;
+    options.extras.hull_budget = hull_vertex_budget;
+    options.extras.mass_properties = compute_mass_properties;
+    options.extras.recenter = recenter_halves;
+    options.collect_stats = collect_stats;
+    return options;
+}
 
-    Vector<Intersector::SplitResult> split_results;
-    split_results.resize(mesh->get_surface_count());
-    Intersector::SplitResult *split_results_writer = split_results.ptrw();
+uint64_t Slicer::parse_surfaces(const Ref<ArrayMesh> &mesh, Intersector::SplitResult *split_results) const {
+    if (cache.is_valid()) {
+        const SliceableMeshCache::Entry *entry = cache->fetch(mesh, specialized_kernels, use_bvh);
+        ERR_FAIL_NULL_V(entry, 0);
 
-    // The upper and lower meshes will share the same intersection points
-    PackedVector3Array intersection_points;
+        // Nothing touches the cache again until the slice is done with the BVHs
+        for (uint32_t i = 0; i < entry->surfaces.size(); i++) {
+            split_results[i].material = entry->materials[i];
+            split_results[i].surface = entry->surfaces[i];
+            split_results[i].bvh = use_bvh ? &entry->bvhs[i] : nullptr;
+        }
+        return 0;
+    }
 
+    uint64_t array_bytes = 0;
     for (int i = 0; i < mesh->get_surface_count(); i++) {
-        if (mesh->get_surface_count() != 0) {
-            Intersector::SplitResult results = split_results[i];
+        split_results[i].material = mesh->surface_get_material(i);
 
-            results.material = mesh->surface_get_material(i);
+        // Same as MeshBuffer::parse_surface, which only gets the arrays of triangle surfaces
+        if (mesh->surface_get_primitive_type(i) != Mesh::PRIMITIVE_TRIANGLES) {
+            split_results[i].surface.clear();
+            continue;
+        }
 
-            Vector<SlicerFace> faces = SlicerFace::faces_from_surface(**mesh, i);
-            const SlicerFace *faces_reader = faces.ptr();
+        Array arrays = mesh->surface_get_arrays(i);
+        if (collect_stats) {
+            array_bytes += MemoryTracker::arrays_bytes(arrays);
+        }
+        split_results[i].surface.parse_arrays(arrays, mesh->surface_get_format(i), specialized_kernels);
+    }
+    return array_bytes;
+}
 
-            for (int j = 0; j < faces.size(); j++) {
-                Intersector::split_face_by_plane(plane, faces_reader[j], results);
-            }
+void Slicer::record_call(const Transform3D &mesh_transform, const Plane &plane, const Ref<Material> &cross_section_material) {
+    LocalVector<const MeshBuffer *> surfaces;
+    surfaces.resize(workspace.split_results.size());
+    for (uint32_t i = 0; i < surfaces.size(); i++) {
+        surfaces[i] = &workspace.split_results[i].surface;
+    }
 
-            int ip_size = intersection_points.size();
-            intersection_points.resize(ip_size + results.intersection_points.size());
-            Vector3 *ip_writer = intersection_points.ptrw();
-            for (int j = 0; j < results.intersection_points.size(); j ++) {
-                ip_writer[ip_size + j] = results.intersection_points[j];
-            }
-            results.intersection_points.resize(0);
+    SliceCapture::Call call;
+    call.mesh = recorder.add_mesh(surfaces);
+    call.plane = plane;
 
-            split_results_writer[i] = results;
+    if (cross_section_material.is_valid()) {
+        String name = cross_section_material->get_path();
+        if (name.is_empty()) {
+            name = cross_section_material->get_name();
         }
+        call.material = recorder.add_material(cross_section_material->get_instance_id(), name.utf8().get_data());
     }
 
-    // If no intersection has occurred then there's really nothing for us to do
-    // but still, is this the expected behavior? Would it be better to return an
-    // actual SliceMesh with either the upper_mesh or lower_mesh null?
-    if (intersection_points.size() == 0) {
-        return Ref<SlicedMesh>();
+    for (int i = 0; i < 3; i++) {
+        call.transform[i * 3 + 0] = mesh_transform.basis[i].x;
+        call.transform[i * 3 + 1] = mesh_transform.basis[i].y;
+        call.transform[i * 3 + 2] = mesh_transform.basis[i].z;
+        call.transform[9 + i] = mesh_transform.origin[i];
     }
 
-    Vector<SlicerFace> cross_section_faces = Triangulator::monotone_chain(intersection_points, plane.normal);
+    call.flags = (indexed_output ? SliceCapture::FLAG_INDEXED_OUTPUT : 0) |
+            (specialized_kernels ? SliceCapture::FLAG_SPECIALIZED_KERNELS : 0) |
+            (parallel ? SliceCapture::FLAG_PARALLEL : 0) |
+            (use_bvh ? SliceCapture::FLAG_USE_BVH : 0);
+
+    recorder.add_call(call);
+}
 
-    SlicedMesh *sliced_mesh = memnew(SlicedMesh(split_results, cross_section_faces, cross_section_material));
-    
-    return Ref<SlicedMesh>(sliced_mesh);
+Ref<SlicedMesh> Slicer::slice_by_plane(const Ref<ArrayMesh> mesh, const Plane plane, const Ref<Material> cross_section_material) {
+    return slice_placed(mesh, Transform3D(), plane, cross_section_material);
 }
 
-Ref<SlicedMesh> Slicer::slice_by_multiple_planes(const Ref<ArrayMesh> mesh, const Array planes, const Ref<Material> cross_section_material) {
-    // TODO - This function is a little heavy. Maybe we should break it up
+Ref<SlicedMesh> Slicer::slice_placed(const Ref<ArrayMesh> &mesh, const Transform3D &mesh_transform, const Plane &plane, const Ref<Material> &cross_section_material) {
+    TRACE_ZONE("Slicer::slice_by_plane");
+    last_stats.unref();
+
     if (mesh.is_null()) {
         return Ref<SlicedMesh>();
     }
 
-    Vector<Intersector::SplitResult> split_results;
-    split_results.resize(mesh->get_surface_count());
-    Intersector::SplitResult *split_results_writer = split_results.ptrw();
+    // Not much point in reading the mesh at all if the plane doesn't even come near it
+    if (Intersector::get_side_of(plane, mesh->get_aabb()) != Intersector::SideOfPlane::ON) {
+        return Ref<SlicedMesh>();
+    }
 
-    // The upper and lower meshes will share the same intersection points
-    PackedVector3Array intersection_points;
+    SliceTimings &timings = workspace.timings;
+    timings.clear();
 
-    for (int i = 0; i < planes.size(); i++){ 
-        for (int j = 0; j < mesh->get_surface_count(); j++) {
-            if (mesh->get_surface_count() != 0) {
-                Intersector::SplitResult results = split_results[j];
+    uint64_t start = collect_stats ? SliceTimings::now_usec() : 0;
+    workspace.begin(mesh->get_surface_count());
+    workspace.source_array_bytes = parse_surfaces(mesh, workspace.split_results.ptrw());
 
-                results.material = mesh->surface_get_material(j);
+    if (collect_stats) {
+        timings.add(SliceTimings::PHASE_PARSE, start);
+        workspace.sample_memory(workspace.halves);
+    }
 
-                Vector<SlicerFace> faces = SlicerFace::faces_from_surface(**mesh, j);
-                const SlicerFace *faces_reader = faces.ptr();
+    if (recorder.is_open()) {
+        record_call(mesh_transform, plane, cross_section_material);
+    }
 
-                for (int k = 0; k < faces.size(); k++) {
-                    Intersector::split_face_by_plane(planes[i], faces_reader[k], results);
-                }
+    Ref<SlicedMesh> sliced_mesh;
+    if (SlicePipeline::build_halves(plane, workspace, cross_section_material, get_options(), workspace.halves)) {
+        start = collect_stats ? SliceTimings::now_usec() : 0;
+        sliced_mesh = Ref<SlicedMesh>(memnew(SlicedMesh(workspace.halves[0], workspace.halves[1])));
 
-                int ip_size = intersection_points.size();
-                intersection_points.resize(ip_size + results.intersection_points.size());
-                Vector3 *ip_writer = intersection_points.ptrw();
-                for (int k = 0; k < results.intersection_points.size(); k++) {
-                    ip_writer[ip_size + k] = results.intersection_points[k];
-                }
-                results.intersection_points.resize(0);
+        if (collect_stats) {
+            timings.add(SliceTimings::PHASE_COMMIT, start);
+        }
+    }
 
-                split_results_writer[j] = results;
-            }
+    if (collect_stats) {
+        last_stats = Ref<SliceStats>(memnew(SliceStats(timings)));
+        SliceMonitors::record(timings);
+    }
+
+    workspace.finish();
+    return sliced_mesh;
+}
+
+Ref<SliceJob> Slicer::slice_async(const Ref<ArrayMesh> mesh, const Plane plane, const Ref<Material> cross_section_material) {
+    if (mesh.is_null()) {
+        return Ref<SliceJob>();
+    }
+
+    // Forget about the jobs that have already wrapped up
+    LocalVector<uint64_t> finished;
+    for (const KeyValue<uint64_t, Ref<SliceJob>> &E : pending_jobs) {
+        if (!E.value->is_pending()) {
+            finished.push_back(E.key);
         }
-        // If no intersection has occurred then there's really nothing for us to do
-        // but still, is this the expected behavior? Would it be better to return an
-        // actual SliceMesh with either the upper_mesh or lower_mesh null?
-        if (intersection_points.size() == 0) {
-            return Ref<SlicedMesh>();
+    }
+    for (uint32_t i = 0; i < finished.size(); i++) {
+        pending_jobs.erase(finished[i]);
+    }
+
+    // Whatever the older cut on this mesh was going to produce is stale now
+    uint64_t mesh_id = mesh->get_instance_id();
+    if (pending_jobs.has(mesh_id)) {
+        pending_jobs[mesh_id]->cancel();
+    }
+
+    Ref<SliceJob> job;
+    job.instantiate();
+    job->start(mesh, plane, cross_section_material, get_options(), cache.ptr());
+
+    pending_jobs[mesh_id] = job;
+    return job;
+}
+
+Fracture::Piece *Slicer::parse_piece(const Ref<ArrayMesh> &mesh) const {
+    Fracture::Piece *piece = memnew(Fracture::Piece);
+
+    piece->surfaces.resize(mesh->get_surface_count());
+    parse_surfaces(mesh, piece->surfaces.ptr());
+
+    return piece;
+}
+
+Array Slicer::commit_pieces(const LocalVector<Fracture::Piece *> &pieces) const {
+    Array meshes;
+
+    for (uint32_t i = 0; i < pieces.size(); i++) {
+        const Fracture::Piece *piece = pieces[i];
+        if (!piece) {
+            continue;
+        }
+
+        MeshHalf cell;
+        for (uint32_t j = 0; j < piece->surfaces.size(); j++) {
+            const MeshBuffer &surface = piece->surfaces[j].surface;
+            cell.add_surface(surface, surface.indices, piece->surfaces[j].material, indexed_output, specialized_kernels);
+        }
+
+        meshes.push_back(Ref<Mesh>(cell.commit()));
+        memdelete(pieces[i]);
+    }
+
+    return meshes;
+}
+
+Array Slicer::slice_by_multiple_planes(const Ref<ArrayMesh> mesh, const TypedArray<Plane> &planes, const Ref<Material> cross_section_material) {
+    if (mesh.is_null()) {
+        return Array();
+    }
+
+    // Pulled out of their Variants once up front rather than every time they're used
+    LocalVector<Plane> fracture_planes;
+    fracture_planes.resize(planes.size());
+    for (int i = 0; i < planes.size(); i++) {
+        fracture_planes[i] = planes[i];
+    }
+
+    LocalVector<Fracture::Piece *> pieces;
+    Fracture::fracture(parse_piece(mesh), fracture_planes, cross_section_material, specialized_kernels, parallel, pieces);
+
+    return commit_pieces(pieces);
+}
+
+Array Slicer::fracture_voronoi(const Ref<ArrayMesh> mesh, const PackedVector3Array seeds, int seed_count, int64_t rng_seed, const Ref<Material> cross_section_material) {
+    if (mesh.is_null()) {
+        return Array();
+    }
+
+    Fracture::Piece *root = parse_piece(mesh);
+
+    LocalVector<Vector3> cell_seeds;
+    if (seeds.size() > 0) {
+        cell_seeds.resize(seeds.size());
+        for (int i = 0; i < seeds.size(); i++) {
+            cell_seeds[i] = seeds[i];
         }
-        
+    } else {
+        Fracture::scatter_seeds(*root, seed_count, rng_seed, cell_seeds);
     }
-    
-    Vector<SlicerFace> cross_section_faces = Triangulator::monotone_chain(intersection_points, Plane(planes.back()).normal);
 
-    SlicedMesh *sliced_mesh = memnew(SlicedMesh(split_results, cross_section_faces, cross_section_material));
-    
-    return Ref<SlicedMesh>(sliced_mesh);
+    LocalVector<Fracture::Piece *> cells;
+    Fracture::fracture_voronoi(*root, cell_seeds, cross_section_material, specialized_kernels, parallel, cells);
+    memdelete(root);
+
+    return commit_pieces(cells);
 }
 
 Ref<SlicedMesh> Slicer::slice_mesh(const Ref<Mesh> mesh, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material) {
@@ -114,18 +254,191 @@ Ref<SlicedMesh> Slicer::slice_mesh(const Ref<Mesh> mesh, const Vector3 position,
     return slice_by_plane(mesh, plane, cross_section_material);
 }
 
+/**
+ * Reorients the plane, given in the same space as mesh_transform, so that it will correctly slice
+ * a mesh placed by mesh_transform whose vertexes are based on the origin. Goes through the inverse
+ * of the whole transform, so scaled and skewed meshes get cut in the right place too
+*/
+Plane plane_in_mesh_space(const Transform3D &mesh_transform, const Plane &plane) {
+    // Transform3D::xform takes the plane's normal times its distance for a point on it
+    return mesh_transform.affine_inverse().xform(plane.normalized());
+}
+
 Ref<SlicedMesh> Slicer::slice(const Ref<Mesh> mesh, const Transform3D mesh_transform, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material) {
-    // We need to reorient the plane so that it will correctly slice the mesh whose vertexes are based on the origin
-    Vector3 origin = position - mesh_transform.origin;
-    real_t dist = normal.dot(origin);
-    Vector3 adjusted_normal = mesh_transform.basis.xform_inv(normal);
+    return slice_placed(mesh, mesh_transform, plane_in_mesh_space(mesh_transform, Plane(normal, position)), cross_section_material);
+}
+
+/**
+ * One mesh of a slice_batch call, everything the workers need is captured up front
+*/
+struct BatchItem {
+    Plane plane;
+    SlicePipeline::MeshSnapshot snapshot;
+    MeshHalf halves[2];
+    bool has_halves = false;
+};
 
-    return slice_by_plane(mesh, Plane(adjusted_normal, dist), cross_section_material);
+/**
+ * Run once per worker. Each one keeps taking the next item that nobody has
+ * started on yet and reuses the same workspace for all of them, so scratch
+ * memory is only ever allocated as many times as there are workers
+*/
+struct BatchSlicer {
+    LocalVector<BatchItem> &items;
+    Ref<Material> cross_section_material;
+    SlicePipeline::Options options;
+    std::atomic<uint32_t> next_item;
+
+    void operator()(uint32_t worker_idx) {
+        SliceWorkspace workspace;
+
+        for (uint32_t i = next_item++; i < items.size(); i = next_item++) {
+            BatchItem &item = items[i];
+            if (item.snapshot.surface_count() == 0) {
+                continue;
+            }
+
+            TRACE_ZONE("slice_batch item");
+
+            item.snapshot.parse(workspace.split_results, options.specialized_kernels);
+            item.has_halves = SlicePipeline::build_halves(item.plane, workspace, cross_section_material, options, item.halves);
+        }
+    }
+};
+
+Array Slicer::slice_batch(const TypedArray<Mesh> &meshes, const TypedArray<Transform3D> &mesh_transforms, const TypedArray<Plane> &planes, const Ref<Material> cross_section_material) {
+    Array sliced_meshes;
+    ERR_FAIL_COND_V_MSG(mesh_transforms.size() != meshes.size(), sliced_meshes, "slice_batch needs one transform per mesh");
+    ERR_FAIL_COND_V_MSG(planes.size() != meshes.size(), sliced_meshes, "slice_batch needs one plane per mesh");
+
+    LocalVector<BatchItem> items;
+    items.resize(meshes.size());
+
+    // Reading the meshes goes through the engine so it has to happen here
+    for (int i = 0; i < meshes.size(); i++) {
+        Ref<ArrayMesh> mesh = meshes[i];
+        if (mesh.is_null()) {
+            continue;
+        }
+
+        items[i].plane = plane_in_mesh_space(mesh_transforms[i], planes[i]);
+
+        // Left empty, and so skipped, if the plane misses the mesh
+        if (Intersector::get_side_of(items[i].plane, mesh->get_aabb()) == Intersector::SideOfPlane::ON) {
+            items[i].snapshot.capture(mesh, cache.ptr(), specialized_kernels, use_bvh);
+        }
+    }
+
+    // Items already keep every worker busy, so they're each sliced on a single thread
+    // rather than having them wait on each other for the pool. Nothing hands out the
+    // stats of a batch, so there's no point timing it either
+    SlicePipeline::Options options = get_options();
+    options.parallel = false;
+    options.collect_stats = false;
+
+    BatchSlicer slicer = { items, cross_section_material, options };
+    slicer.next_item = 0;
+
+    int worker_count = MIN((int)items.size(), OS::get_singleton()->get_processor_count());
+    Parallel::for_each(worker_count, slicer, "Slicer slice_batch");
+
+    sliced_meshes.resize(items.size());
+    for (uint32_t i = 0; i < items.size(); i++) {
+        if (items[i].has_halves) {
+            sliced_meshes[i] = Ref<SlicedMesh>(memnew(SlicedMesh(items[i].halves[0], items[i].halves[1])));
+        }
+    }
+
+    return sliced_meshes;
+}
+
+Error Slicer::dump_trace(const String &path) {
+#ifdef SLICER_TRACE
+    std::string json;
+    Trace::write_json(json);
+
+    Ref<FileAccess> file = FileAccess::open(path, FileAccess::WRITE);
+    ERR_FAIL_COND_V_MSG(file.is_null(), FileAccess::get_open_error(), "Couldn't open " + path + " to write the trace to");
+
+    PackedByteArray bytes;
+    bytes.resize(json.size());
+    memcpy(bytes.ptrw(), json.data(), json.size());
+    file->store_buffer(bytes);
+    return OK;
+#else
+    ERR_FAIL_V_MSG(ERR_UNAVAILABLE, "Slicer was built without tracing, rebuild it with trace=yes");
+#endif
+}
+
+void Slicer::clear_trace() {
+    Trace::clear();
+}
+
+Error Slicer::start_recording(const String &path) {
+    String global_path = ProjectSettings::get_singleton()->globalize_path(path);
+    bool opened = recorder.open(global_path.utf8().get_data());
+    ERR_FAIL_COND_V_MSG(!opened, ERR_FILE_CANT_OPEN, "Couldn't open " + path + " to record slices to");
+    return OK;
+}
+
+void Slicer::stop_recording() {
+    recorder.close();
 }
 
 void Slicer::_bind_methods() {
     ClassDB::bind_method(D_METHOD("slice_by_plane", "mesh", "plane", "cross_section_material"), &Slicer::slice_by_plane);
     ClassDB::bind_method(D_METHOD("slice_by_multiple_planes", "mesh", "planes", "cross_section_material"), &Slicer::slice_by_multiple_planes);
+    ClassDB::bind_method(D_METHOD("fracture_voronoi", "mesh", "seeds", "seed_count", "rng_seed", "cross_section_material"), &Slicer::fracture_voronoi);
+    ClassDB::bind_method(D_METHOD("slice_batch", "meshes", "mesh_transforms", "planes", "cross_section_material"), &Slicer::slice_batch);
+    ClassDB::bind_method(D_METHOD("slice_async", "mesh", "plane", "cross_section_material"), &Slicer::slice_async);
     ClassDB::bind_method(D_METHOD("slice_mesh", "mesh", "position", "normal", "cross_section_material"), &Slicer::slice_mesh);
     ClassDB::bind_method(D_METHOD("slice", "mesh_instance", "mesh_transform", "position", "normal", "cross_section_material"), &Slicer::slice);
+
+    ClassDB::bind_static_method("Slicer", D_METHOD("dump_trace", "path"), &Slicer::dump_trace);
+    ClassDB::bind_static_method("Slicer", D_METHOD("clear_trace"), &Slicer::clear_trace);
+
+    ClassDB::bind_method(D_METHOD("start_recording", "path"), &Slicer::start_recording);
+    ClassDB::bind_method(D_METHOD("stop_recording"), &Slicer::stop_recording);
+    ClassDB::bind_method(D_METHOD("is_recording"), &Slicer::is_recording);
+
+    ClassDB::bind_method(D_METHOD("set_indexed_output", "indexed_output"), &Slicer::set_indexed_output);
+    ClassDB::bind_method(D_METHOD("is_indexed_output"), &Slicer::is_indexed_output);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "indexed_output"), "set_indexed_output", "is_indexed_output");
+
+    ClassDB::bind_method(D_METHOD("set_specialized_kernels", "specialized_kernels"), &Slicer::set_specialized_kernels);
+    ClassDB::bind_method(D_METHOD("is_specialized_kernels"), &Slicer::is_specialized_kernels);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "specialized_kernels"), "set_specialized_kernels", "is_specialized_kernels");
+
+    ClassDB::bind_method(D_METHOD("set_parallel", "parallel"), &Slicer::set_parallel);
+    ClassDB::bind_method(D_METHOD("is_parallel"), &Slicer::is_parallel);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "parallel"), "set_parallel", "is_parallel");
+
+    ClassDB::bind_method(D_METHOD("set_use_bvh", "use_bvh"), &Slicer::set_use_bvh);
+    ClassDB::bind_method(D_METHOD("is_using_bvh"), &Slicer::is_using_bvh);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "use_bvh"), "set_use_bvh", "is_using_bvh");
+
+    ClassDB::bind_method(D_METHOD("set_build_collision_hulls", "build_collision_hulls"), &Slicer::set_build_collision_hulls);
+    ClassDB::bind_method(D_METHOD("is_building_collision_hulls"), &Slicer::is_building_collision_hulls);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "build_collision_hulls"), "set_build_collision_hulls", "is_building_collision_hulls");
+
+    ClassDB::bind_method(D_METHOD("set_hull_vertex_budget", "hull_vertex_budget"), &Slicer::set_hull_vertex_budget);
+    ClassDB::bind_method(D_METHOD("get_hull_vertex_budget"), &Slicer::get_hull_vertex_budget);
+    ADD_PROPERTY(PropertyInfo(Variant::INT, "hull_vertex_budget"), "set_hull_vertex_budget", "get_hull_vertex_budget");
+
+    ClassDB::bind_method(D_METHOD("set_compute_mass_properties", "compute_mass_properties"), &Slicer::set_compute_mass_properties);
+    ClassDB::bind_method(D_METHOD("is_computing_mass_properties"), &Slicer::is_computing_mass_properties);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "compute_mass_properties"), "set_compute_mass_properties", "is_computing_mass_properties");
+
+    ClassDB::bind_method(D_METHOD("set_recenter_halves", "recenter_halves"), &Slicer::set_recenter_halves);
+    ClassDB::bind_method(D_METHOD("is_recentering_halves"), &Slicer::is_recentering_halves);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "recenter_halves"), "set_recenter_halves", "is_recentering_halves");
+
+    ClassDB::bind_method(D_METHOD("set_collect_stats", "collect_stats"), &Slicer::set_collect_stats);
+    ClassDB::bind_method(D_METHOD("is_collecting_stats"), &Slicer::is_collecting_stats);
+    ClassDB::bind_method(D_METHOD("get_last_stats"), &Slicer::get_last_stats);
+    ADD_PROPERTY(PropertyInfo(Variant::BOOL, "collect_stats"), "set_collect_stats", "is_collecting_stats");
+
+    ClassDB::bind_method(D_METHOD("set_cache", "cache"), &Slicer::set_cache);
+    ClassDB::bind_method(D_METHOD("get_cache"), &Slicer::get_cache);
+    ADD_PROPERTY(PropertyInfo(Variant::OBJECT, "cache", PROPERTY_HINT_RESOURCE_TYPE, "SliceableMeshCache"), "set_cache", "get_cache");
 }
@@ -9,7 +9,12 @@
 #include <godot_cpp/classes/node3d.hpp>
 //#include <godot-cpp/classes/mesh_instance3d.hpp>
 #include <godot_cpp/classes/mesh_instance3d.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+#include <godot_cpp/variant/typed_array.hpp>
 #include "sliced_mesh.h"
+#include "slice_job.h"
+#include "utils/fracture.h"
+#include "utils/slice_capture.h"
 
 using namespace godot;
 
@@ -23,16 +28,223 @@ class Slicer : public RefCounted {
 protected:
     static void _bind_methods();
 
+    bool indexed_output = true;
+    bool specialized_kernels = true;
+    bool parallel = false;
+    bool use_bvh = false;
+    bool build_collision_hulls = false;
+    int hull_vertex_budget = 0;
+    bool compute_mass_properties = false;
+    bool recenter_halves = false;
+    bool collect_stats = false;
+    Ref<SliceableMeshCache> cache;
+
+    // See get_last_stats
+    Ref<SliceStats> last_stats;
+
+    // Scratch memory for slice_by_plane, kept from one slice to the next
+    SliceWorkspace workspace;
+
+    // The most recent slice_async job of every mesh, by instance id
+    HashMap<uint64_t, Ref<SliceJob>> pending_jobs;
+
+    // See start_recording
+    SliceCapture::Writer recorder;
+
+    /**
+     * slice_by_plane for a mesh placed by mesh_transform, which only gets used for recording
+    */
+    Ref<SlicedMesh> slice_placed(const Ref<ArrayMesh> &mesh, const Transform3D &mesh_transform, const Plane &plane, const Ref<Material> &cross_section_material);
+
+    /**
+     * Adds the slice about to be made on the parsed surfaces to the recording
+    */
+    void record_call(const Transform3D &mesh_transform, const Plane &plane, const Ref<Material> &cross_section_material);
+
+    /**
+     * Fills in the material and parsed surface of a split result per surface of the mesh,
+     * straight from the cache if there is one, along with their BVHs if use_bvh is set.
+     * Returns the bytes of the arrays it copied out of the engine to do so, see
+     * SliceWorkspace::source_array_bytes
+    */
+    uint64_t parse_surfaces(const Ref<ArrayMesh> &mesh, Intersector::SplitResult *split_results) const;
+
+    /**
+     * Parses every surface of the mesh into a piece for Fracture to work on
+    */
+    Fracture::Piece *parse_piece(const Ref<ArrayMesh> &mesh) const;
+
+    /**
+     * Creates a mesh for each of the pieces, skipping null ones, and frees them
+    */
+    Array commit_pieces(const LocalVector<Fracture::Piece *> &pieces) const;
+
 public:
+    /**
+     * The settings below as they are right now, for a slice about to be started
+    */
+    SlicePipeline::Options get_options() const;
+
+    /**
+     * Whether the sliced meshes are built as indexed surfaces that keep sharing the
+     * vertexes of the original mesh, or as a flat list of three vertexes per face
+    */
+    void set_indexed_output(bool p_indexed_output) {
+        indexed_output = p_indexed_output;
+    }
+    bool is_indexed_output() const {
+        return indexed_output;
+    }
+
+    /**
+     * Whether vertexes get parsed, split and serialized by kernels compiled for the mesh's
+     * exact vertex format, or by the generic ones that check every attribute of every vertex.
+     * The generic path only exists as a fallback, so this is mostly useful for benchmarking
+    */
+    void set_specialized_kernels(bool p_specialized_kernels) {
+        specialized_kernels = p_specialized_kernels;
+    }
+    bool is_specialized_kernels() const {
+        return specialized_kernels;
+    }
+
+    /**
+     * Whether splitting the faces and building the sliced meshes' surfaces gets spread across
+     * the WorkerThreadPool. The output is exactly the same either way, so this only comes down
+     * to speed, which only really pays off for heavier meshes
+    */
+    void set_parallel(bool p_parallel) {
+        parallel = p_parallel;
+    }
+    bool is_parallel() const {
+        return parallel;
+    }
+
+    /**
+     * Whether meshes get a BVH over their faces, so a slice only has to look at the faces near
+     * the plane. Building one costs more than a single slice saves, so the BVHs live in the cache
+     * and this does nothing without one. Faces come out in a different order than without it
+    */
+    void set_use_bvh(bool p_use_bvh) {
+        use_bvh = p_use_bvh;
+    }
+    bool is_using_bvh() const {
+        return use_bvh;
+    }
+
+    /**
+     * Whether the convex hull of each half gets worked out while it's being built, so the
+     * SlicedMesh can hand out collision shapes without reading the new meshes back or the
+     * engine hulling all of their vertexes again
+    */
+    void set_build_collision_hulls(bool p_build_collision_hulls) {
+        build_collision_hulls = p_build_collision_hulls;
+    }
+    bool is_building_collision_hulls() const {
+        return build_collision_hulls;
+    }
+
+    /**
+     * The most points a collision hull gets, 0 for no limit. Past that only points furthest out
+     * in evenly spread directions are kept, which rounds off the hull a bit
+    */
+    void set_hull_vertex_budget(int p_hull_vertex_budget) {
+        hull_vertex_budget = MAX(p_hull_vertex_budget, 0);
+    }
+    int get_hull_vertex_budget() const {
+        return hull_vertex_budget;
+    }
+
+    /**
+     * Whether the volume, center of mass and inertia tensor of each half get worked out while
+     * it's being built. They're for a density of 1, so scale the inertia by the body's mass
+     * over the volume. Only makes sense for meshes that are closed
+    */
+    void set_compute_mass_properties(bool p_compute_mass_properties) {
+        compute_mass_properties = p_compute_mass_properties;
+    }
+    bool is_computing_mass_properties() const {
+        return compute_mass_properties;
+    }
+
+    /**
+     * Whether the halves get built around their own center of mass rather than the original
+     * mesh's origin, so they can be placed at it (see SlicedMesh's center of mass) and spin
+     * around the right point. Works out the mass properties regardless of the above
+    */
+    void set_recenter_halves(bool p_recenter_halves) {
+        recenter_halves = p_recenter_halves;
+    }
+    bool is_recentering_halves() const {
+        return recenter_halves;
+    }
+
+    /**
+     * Whether slice_by_plane and slice_async time each phase of the slice and count what went
+     * through it, see SliceStats. Every slice timed this way also gets added to the Slicer/
+     * Performance monitors. Nothing gets timed while this is off
+    */
+    void set_collect_stats(bool p_collect_stats) {
+        collect_stats = p_collect_stats;
+    }
+    bool is_collecting_stats() const {
+        return collect_stats;
+    }
+
+    /**
+     * The stats of the last slice_by_plane, slice_mesh or slice call, or null if collect_stats
+     * was off or the plane didn't come near the mesh
+    */
+    Ref<SliceStats> get_last_stats() const {
+        return last_stats;
+    }
+
+    /**
+     * Meshes get parsed through this cache, when set, so slicing the same mesh again doesn't
+     * have to read it back out of the engine
+    */
+    void set_cache(const Ref<SliceableMeshCache> &p_cache) {
+        cache = p_cache;
+    }
+    Ref<SliceableMeshCache> get_cache() const {
+        return cache;
+    }
+
     /**
      * Slice the passed in mesh along the passed in plane, setting the interior cut surface to the passed in material
     */
     Ref<SlicedMesh> slice_by_plane(const Ref<ArrayMesh> mesh, const Plane plane, const Ref<Material> cross_section_material);
 
     /**
-     * Slice the passed in mesh sequentially along every plane in the array
+     * Breaks the mesh up along the Voronoi cells of the seed points, which are in the mesh's own space,
+     * returning a mesh per cell with its cuts capped using the passed in material. If seeds is empty,
+     * seed_count of them are scattered through the mesh instead, always the same ones for the same
+     * rng_seed. Cells that don't overlap the mesh are left out, as are the cells of seeds on top of
+     * an earlier one
     */
-    Ref<SlicedMesh> slice_by_multiple_planes(const Ref<ArrayMesh> mesh, const Array planes, const Ref<Material> cross_section_material);
+    Array fracture_voronoi(const Ref<ArrayMesh> mesh, const PackedVector3Array seeds, int seed_count, int64_t rng_seed, const Ref<Material> cross_section_material);
+
+    /**
+     * Same as slice_by_plane except the heavy lifting happens on the WorkerThreadPool. The returned
+     * job emits completed once the halves have been added to the new meshes on the main thread.
+     * Slicing a mesh that still has a job running cancels that job
+    */
+    Ref<SliceJob> slice_async(const Ref<ArrayMesh> mesh, const Plane plane, const Ref<Material> cross_section_material);
+
+    /**
+     * Slices every mesh by the plane at the same position in planes, in one call. Meshes are placed
+     * by the matching transform and planes are given in the same space as the transforms, like slice.
+     * Meshes are spread across the WorkerThreadPool. Returns a SlicedMesh per mesh, or null where
+     * the plane missed or the mesh isn't an ArrayMesh
+    */
+    Array slice_batch(const TypedArray<Mesh> &meshes, const TypedArray<Transform3D> &mesh_transforms, const TypedArray<Plane> &planes, const Ref<Material> cross_section_material);
+
+    /**
+     * Fractures the passed in mesh by every plane in the array. Each piece left by one plane is
+     * cut again by the ones after it, and every resulting cell is returned as its own mesh with
+     * its cuts capped using the passed in material
+    */
+    Array slice_by_multiple_planes(const Ref<ArrayMesh> mesh, const TypedArray<Plane> &planes, const Ref<Material> cross_section_material);
 
     /**
      * Generates a plane based on the given position and normal and perform a cut along that plane
@@ -43,6 +255,30 @@ public:
      * Generates a plane based on the given position and normal and offsets it by the given Transform before applying the slice
     */
     Ref<SlicedMesh> slice(const Ref<Mesh> mesh, const Transform3D mesh_transform, const Vector3 position, const Vector3 normal, const Ref<Material> cross_section_material);
+
+    /**
+     * Writes out the trace of every slice on every thread since the last clear_trace, as
+     * Chrome trace event JSON that chrome://tracing and Perfetto can open. Only available when
+     * built with trace=yes, see utils/trace.h
+    */
+    static Error dump_trace(const String &path);
+
+    /**
+     * Drops everything traced so far, so the next dump_trace only covers what comes after
+    */
+    static void clear_trace();
+
+    /**
+     * Starts writing every slice_by_plane, slice_mesh and slice call made on this Slicer to a
+     * capture at path, meshes and all, until stop_recording. The capture can be played back
+     * against any build with bench/slice_replay.cpp, without the game that made it. Slices the
+     * plane misses entirely aren't recorded
+    */
+    Error start_recording(const String &path);
+    void stop_recording();
+    bool is_recording() const {
+        return recorder.is_open();
+    }
 };
 
 #endif // SLICER_H
@@ -0,0 +1,419 @@
+#include "convex_hull.h"
+#include "trace.h"
+
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace ConvexHull {
+    /**
+     * Appends the face from a to b to c, facing whichever way its points go around
+     * counterclockwise. Returns false if they're too close to a line to face any way
+    */
+    bool add_face(const LocalVector<Vector3> &points, int a, int b, int c, Workspace &workspace) {
+        double ab[3] = { (double)points[b].x - points[a].x, (double)points[b].y - points[a].y, (double)points[b].z - points[a].z };
+        double ac[3] = { (double)points[c].x - points[a].x, (double)points[c].y - points[a].y, (double)points[c].z - points[a].z };
+        double normal[3] = {
+            ab[1] * ac[2] - ab[2] * ac[1],
+            ab[2] * ac[0] - ab[0] * ac[2],
+            ab[0] * ac[1] - ab[1] * ac[0]
+        };
+
+        double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (!(length > 0)) {
+            return false;
+        }
+
+        Face face;
+        face.vertex[0] = a;
+        face.vertex[1] = b;
+        face.vertex[2] = c;
+        face.neighbor[0] = face.neighbor[1] = face.neighbor[2] = -1;
+        for (int i = 0; i < 3; i++) {
+            face.normal[i] = normal[i] / length;
+        }
+        face.origin = points[a];
+        face.first_outside = -1;
+        face.farthest = -1;
+        face.farthest_distance = 0;
+        face.alive = true;
+        face.visible = false;
+        face.visit_stamp = -1;
+
+        workspace.faces.push_back(face);
+        return true;
+    }
+
+    /**
+     * Hands the point to the first of the faces it's further than epsilon outside of, if any
+    */
+    _FORCE_INLINE_ void assign_outside(const LocalVector<Vector3> &points, int point, const LocalVector<int> &faces, real_t epsilon, Workspace &workspace) {
+        for (uint32_t i = 0; i < faces.size(); i++) {
+            Face &face = workspace.faces[faces[i]];
+            double distance = face.distance_to(points[point]);
+            if (distance <= epsilon) {
+                continue;
+            }
+
+            workspace.next_outside[point] = face.first_outside;
+            face.first_outside = point;
+            if (distance > face.farthest_distance) {
+                face.farthest = point;
+                face.farthest_distance = distance;
+            }
+            return;
+        }
+    }
+
+    /**
+     * Starts the hull off with the tetrahedron of four points that are furthest apart, roughly.
+     * Returns false if the points are all on one plane
+    */
+    bool build_tetrahedron(const LocalVector<Vector3> &points, real_t epsilon, Workspace &workspace) {
+        // The two furthest apart of the points furthest along each axis
+        int extremes[6] = { 0, 0, 0, 0, 0, 0 };
+        for (uint32_t i = 1; i < points.size(); i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                if (points[i][axis] < points[extremes[axis * 2]][axis]) {
+                    extremes[axis * 2] = i;
+                }
+                if (points[i][axis] > points[extremes[axis * 2 + 1]][axis]) {
+                    extremes[axis * 2 + 1] = i;
+                }
+            }
+        }
+
+        int a = 0;
+        int b = 0;
+        real_t farthest = 0;
+        for (int i = 0; i < 6; i++) {
+            for (int j = i + 1; j < 6; j++) {
+                real_t distance = points[extremes[i]].distance_squared_to(points[extremes[j]]);
+                if (distance > farthest) {
+                    farthest = distance;
+                    a = extremes[i];
+                    b = extremes[j];
+                }
+            }
+        }
+
+        if (Math::sqrt(farthest) <= epsilon) {
+            return false;
+        }
+
+        // Then the point furthest from the line through them, and the one furthest from that plane
+        Vector3 direction = (points[b] - points[a]).normalized();
+        int c = -1;
+        farthest = epsilon;
+        for (uint32_t i = 0; i < points.size(); i++) {
+            Vector3 offset = points[i] - points[a];
+            real_t distance = (offset - direction * offset.dot(direction)).length();
+            if (distance > farthest) {
+                farthest = distance;
+                c = i;
+            }
+        }
+
+        if (c == -1) {
+            return false;
+        }
+
+        Vector3 normal = (points[b] - points[a]).cross(points[c] - points[a]).normalized();
+        int d = -1;
+        farthest = epsilon;
+        for (uint32_t i = 0; i < points.size(); i++) {
+            real_t distance = Math::abs(normal.dot(points[i] - points[a]));
+            if (distance > farthest) {
+                farthest = distance;
+                d = i;
+            }
+        }
+
+        if (d == -1) {
+            return false;
+        }
+
+        // Every face has to wind counterclockwise seen from outside, with d below abc
+        if (normal.dot(points[d] - points[a]) > 0) {
+            SWAP(b, c);
+        }
+
+        if (!add_face(points, a, b, c, workspace) || !add_face(points, a, d, b, workspace) ||
+                !add_face(points, b, d, c, workspace) || !add_face(points, c, d, a, workspace)) {
+            return false;
+        }
+
+        // Every edge goes one way on one face and the other way on its neighbor
+        for (int i = 0; i < 4; i++) {
+            Face &face = workspace.faces[i];
+            for (int edge = 0; edge < 3; edge++) {
+                int from = face.vertex[edge];
+                int to = face.vertex[(edge + 1) % 3];
+
+                for (int j = 0; j < 4; j++) {
+                    const Face &other = workspace.faces[j];
+                    for (int other_edge = 0; other_edge < 3 && j != i; other_edge++) {
+                        if (other.vertex[other_edge] == to && other.vertex[(other_edge + 1) % 3] == from) {
+                            face.neighbor[edge] = j;
+                        }
+                    }
+                }
+            }
+        }
+
+        LocalVector<int> &initial = workspace.new_faces;
+        initial.clear();
+        for (int i = 0; i < 4; i++) {
+            initial.push_back(i);
+        }
+
+        for (uint32_t i = 0; i < points.size(); i++) {
+            if ((int)i != a && (int)i != b && (int)i != c && (int)i != d) {
+                assign_outside(points, i, initial, epsilon, workspace);
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Finds every face the point can see, spreading out from one that it can, along with the
+     * horizon around them. Returns false if what it sees isn't a single patch with one horizon.
+     *
+     * Only points further than epsilon out get added, but any face the point is above at all
+     * counts as seen. Leaving out faces it's only a little above would leave the new faces
+     * bending inwards where they meet those, and points added later can end up seeing
+     * patches with holes in them around there
+    */
+    bool find_horizon(const LocalVector<Vector3> &points, int eye, int first_face, int stamp, Workspace &workspace) {
+        workspace.visible.clear();
+        workspace.horizon.clear();
+        workspace.stack.clear();
+
+        Face &first = workspace.faces[first_face];
+        first.visit_stamp = stamp;
+        first.visible = true;
+        workspace.stack.push_back(first_face);
+
+        while (workspace.stack.size() > 0) {
+            int face_idx = workspace.stack[workspace.stack.size() - 1];
+            workspace.stack.resize(workspace.stack.size() - 1);
+            workspace.visible.push_back(face_idx);
+
+            for (int edge = 0; edge < 3; edge++) {
+                int neighbor_idx = workspace.faces[face_idx].neighbor[edge];
+                Face &neighbor = workspace.faces[neighbor_idx];
+
+                if (neighbor.visit_stamp != stamp) {
+                    neighbor.visit_stamp = stamp;
+                    neighbor.visible = neighbor.distance_to(points[eye]) > 0;
+                    if (neighbor.visible) {
+                        workspace.stack.push_back(neighbor_idx);
+                    }
+                }
+
+                if (neighbor.visible) {
+                    continue;
+                }
+
+                const Face &face = workspace.faces[face_idx];
+                HorizonEdge horizon_edge = { face.vertex[edge], face.vertex[(edge + 1) % 3], neighbor_idx, -1 };
+                for (int other_edge = 0; other_edge < 3; other_edge++) {
+                    if (neighbor.neighbor[other_edge] == face_idx) {
+                        horizon_edge.outer_edge = other_edge;
+                    }
+                }
+                workspace.horizon.push_back(horizon_edge);
+            }
+        }
+
+        uint32_t edge_count = workspace.horizon.size();
+        workspace.fan.clear();
+        for (uint32_t i = 0; i < edge_count; i++) {
+            if (workspace.horizon[i].outer_edge == -1 || workspace.fan.has(workspace.horizon[i].from)) {
+                return false;
+            }
+            workspace.fan.insert(workspace.horizon[i].from, i);
+        }
+
+        // A single horizon goes all the way around, edge to edge, back to where it started
+        uint32_t edge = 0;
+        for (uint32_t i = 0; i < edge_count; i++) {
+            const int *next = workspace.fan.getptr(workspace.horizon[edge].to);
+            if (!next || (*next == 0) != (i == edge_count - 1)) {
+                return false;
+            }
+            edge = *next;
+        }
+
+        return edge_count >= 3;
+    }
+
+    /**
+     * Replaces the faces the eye can see with a fan of new ones from the horizon to it. Returns
+     * false, leaving the hull as it was, if the eye is too close to a line through one of the
+     * horizon edges to make a face with it
+    */
+    bool add_point(const LocalVector<Vector3> &points, int eye, real_t epsilon, Workspace &workspace) {
+        LocalVector<int> &new_faces = workspace.new_faces;
+        new_faces.clear();
+
+        uint32_t face_count = workspace.faces.size();
+        for (uint32_t i = 0; i < workspace.horizon.size(); i++) {
+            const HorizonEdge &edge = workspace.horizon[i];
+            if (!add_face(points, edge.from, edge.to, eye, workspace)) {
+                workspace.faces.resize(face_count);
+                return false;
+            }
+            new_faces.push_back(face_count + i);
+        }
+
+        for (uint32_t i = 0; i < new_faces.size(); i++) {
+            const HorizonEdge &edge = workspace.horizon[i];
+            workspace.faces[new_faces[i]].neighbor[0] = edge.outer_face;
+            workspace.faces[edge.outer_face].neighbor[edge.outer_edge] = new_faces[i];
+        }
+
+        // The edge from the end of each horizon edge to the eye is shared with the new face on
+        // the next horizon edge, which starts where this one ends
+        for (uint32_t i = 0; i < new_faces.size(); i++) {
+            int next_face = new_faces[*workspace.fan.getptr(workspace.horizon[i].to)];
+            workspace.faces[new_faces[i]].neighbor[1] = next_face;
+            workspace.faces[next_face].neighbor[2] = new_faces[i];
+        }
+
+        // Whatever was outside the faces that are gone is either outside one of the new ones,
+        // or inside the hull now
+        for (uint32_t i = 0; i < workspace.visible.size(); i++) {
+            Face &face = workspace.faces[workspace.visible[i]];
+            face.alive = false;
+
+            int point = face.first_outside;
+            while (point != -1) {
+                int next = workspace.next_outside[point];
+                if (point != eye) {
+                    assign_outside(points, point, new_faces, epsilon, workspace);
+                }
+                point = next;
+            }
+            face.first_outside = -1;
+        }
+
+        for (uint32_t i = 0; i < new_faces.size(); i++) {
+            if (workspace.faces[new_faces[i]].first_outside != -1) {
+                workspace.pending.push_back(new_faces[i]);
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Takes a point the hull can't be grown out to off of the face it's outside of, counting it
+     * as part of the hull as it is
+    */
+    void set_aside(const LocalVector<Vector3> &points, int face_idx, int point, Workspace &workspace) {
+        Face &face = workspace.faces[face_idx];
+        workspace.marks[point] = 1;
+
+        int *link = &face.first_outside;
+        while (*link != point) {
+            link = &workspace.next_outside[*link];
+        }
+        *link = workspace.next_outside[point];
+
+        face.farthest = -1;
+        face.farthest_distance = 0;
+        for (int other = face.first_outside; other != -1; other = workspace.next_outside[other]) {
+            double distance = face.distance_to(points[other]);
+            if (distance > face.farthest_distance) {
+                face.farthest = other;
+                face.farthest_distance = distance;
+            }
+        }
+
+        if (face.first_outside != -1) {
+            workspace.pending.push_back(face_idx);
+        }
+    }
+
+    bool compute(const LocalVector<Vector3> &points, Workspace &workspace, LocalVector<int> &r_hull) {
+        TRACE_ZONE_COUNT("ConvexHull::compute", points.size());
+        r_hull.clear();
+        workspace.faces.clear();
+        workspace.pending.clear();
+
+        if (points.size() < 4) {
+            return false;
+        }
+
+        // About how far rounding errors can put a point from a plane through the others
+        Vector3 largest;
+        for (uint32_t i = 0; i < points.size(); i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                largest[axis] = MAX(largest[axis], Math::abs(points[i][axis]));
+            }
+        }
+        real_t epsilon = 3 * FLT_EPSILON * (largest.x + largest.y + largest.z);
+
+        workspace.next_outside.resize(points.size());
+        workspace.marks.resize(points.size());
+        memset(workspace.marks.ptr(), 0, workspace.marks.size());
+        if (!build_tetrahedron(points, epsilon, workspace)) {
+            return false;
+        }
+
+        for (int i = 0; i < 4; i++) {
+            if (workspace.faces[i].first_outside != -1) {
+                workspace.pending.push_back(i);
+            }
+        }
+
+        int stamp = 0;
+        while (workspace.pending.size() > 0) {
+            int face_idx = workspace.pending[workspace.pending.size() - 1];
+            workspace.pending.resize(workspace.pending.size() - 1);
+
+            const Face &face = workspace.faces[face_idx];
+            if (!face.alive || face.first_outside == -1) {
+                continue;
+            }
+
+            // Where rounding errors leave no telling which faces it can see, the hull stays as
+            // it is and the point is kept along with it, so nothing gets cut off of it
+            int eye = face.farthest;
+            if (!find_horizon(points, eye, face_idx, stamp++, workspace) || !add_point(points, eye, epsilon, workspace)) {
+                set_aside(points, face_idx, eye, workspace);
+            }
+        }
+
+        for (uint32_t i = 0; i < workspace.faces.size(); i++) {
+            const Face &face = workspace.faces[i];
+            if (face.alive) {
+                workspace.marks[face.vertex[0]] = 1;
+                workspace.marks[face.vertex[1]] = 1;
+                workspace.marks[face.vertex[2]] = 1;
+            }
+        }
+
+        for (uint32_t i = 0; i < points.size(); i++) {
+            if (workspace.marks[i]) {
+                r_hull.push_back(i);
+            }
+        }
+
+        return true;
+    }
+
+    void Workspace::track_memory(MemoryTracker &tracker) const {
+        tracker.add(faces);
+        tracker.add(next_outside);
+        tracker.add(pending);
+        tracker.add(stack);
+        tracker.add(visible);
+        tracker.add(horizon);
+        tracker.add(new_faces);
+        tracker.add(marks);
+        tracker.add(fan);
+    }
+} // ConvexHull
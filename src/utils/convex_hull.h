@@ -0,0 +1,86 @@
+#ifndef CONVEX_HULL_H
+#define CONVEX_HULL_H
+
+#include "core_types.h"
+#include "index_map.h"
+#include "memory_tracker.h"
+
+/**
+ * Finds which points are vertexes of their 3D convex hull, Quickhull style. Starting from a
+ * tetrahedron of extreme points, the point furthest outside of any face gets added one at a
+ * time, replacing every face it can see with a fan of new ones out to the edge of what it
+ * sees. Each point outside the hull is only kept with one face it's outside of, and is never
+ * looked at again once the hull has grown around it
+*/
+namespace ConvexHull {
+    struct Face {
+        int vertex[3];
+
+        // The face on the other side of each edge, the one from vertex[i] to vertex[(i + 1) % 3]
+        int neighbor[3];
+
+        // Pointing out of the hull. Kept in doubles, since near a flat stretch of the hull the
+        // planes of thin faces come out too far off in floats to tell which side points are on
+        double normal[3];
+
+        // The first vertex. Distances are measured from it rather than from the origin, since
+        // points on the plane of a face far from the origin would otherwise come out off of it
+        Vector3 origin;
+
+        // Linked list, through Workspace::next_outside, of the points outside of this face
+        int first_outside;
+        int farthest;
+        double farthest_distance;
+
+        // Faces the hull has grown past stay in Workspace::faces, they just aren't part of it anymore
+        bool alive;
+
+        // Whether the point being added can see the face, as of the iteration in visit_stamp
+        bool visible;
+        int visit_stamp;
+
+        _FORCE_INLINE_ double distance_to(Vector3 point) const {
+            return normal[0] * ((double)point.x - origin.x) + normal[1] * ((double)point.y - origin.y) +
+                    normal[2] * ((double)point.z - origin.z);
+        }
+    };
+
+    // An edge of a face the point being added can see whose other face it can't
+    struct HorizonEdge {
+        int from;
+        int to;
+        int outer_face;
+        int outer_edge;
+    };
+
+    /**
+     * The scratch memory of compute, which can be kept around between calls
+    */
+    struct Workspace {
+        LocalVector<Face> faces;
+        LocalVector<int> next_outside;
+        LocalVector<int> pending;
+        LocalVector<int> stack;
+        LocalVector<int> visible;
+        LocalVector<HorizonEdge> horizon;
+        LocalVector<int> new_faces;
+        LocalVector<uint8_t> marks;
+
+        // The new face along each edge of the horizon, by the vertex the edge starts at
+        IndexMap fan;
+
+        void track_memory(MemoryTracker &tracker) const;
+    };
+
+    /**
+     * Fills r_hull with the indices of the points that are vertexes of their convex hull, in
+     * the same order as the points. Points closer than rounding errors to the hull of the
+     * others, like ones in the middle of a flat side, don't count, while ones so close to
+     * being on a face or an edge of it that rounding errors leave no telling how to add them
+     * get kept as they are. Returns false, with r_hull left empty, if the points don't enclose
+     * any volume
+    */
+    bool compute(const LocalVector<Vector3> &points, Workspace &workspace, LocalVector<int> &r_hull);
+} // ConvexHull
+
+#endif // CONVEX_HULL_H
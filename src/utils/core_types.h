@@ -0,0 +1,32 @@
+#ifndef CORE_TYPES_H
+#define CORE_TYPES_H
+
+/**
+ * Where the slicing core (the mesh buffers, intersector, triangulator and the like) gets its
+ * math and container types from. Built into the extension these are godot-cpp's own. Built
+ * with SLICER_STANDALONE, like the core target in SConstruct, they come from a stand-in for
+ * the handful of godot-cpp types the core uses instead, so it can be built and profiled
+ * without Godot, see core/standalone_types.h
+*/
+#ifdef SLICER_STANDALONE
+#include "core/standalone_types.h"
+#else
+#include <godot_cpp/core/math.hpp>
+#include <godot_cpp/core/error_macros.hpp>
+
+#include <godot_cpp/variant/vector2.hpp>
+#include <godot_cpp/variant/vector3.hpp>
+#include <godot_cpp/variant/color.hpp>
+#include <godot_cpp/variant/plane.hpp>
+#include <godot_cpp/variant/aabb.hpp>
+#include <godot_cpp/variant/basis.hpp>
+
+#include <godot_cpp/templates/local_vector.hpp>
+#include <godot_cpp/templates/hash_map.hpp>
+
+#include <godot_cpp/classes/mesh.hpp>
+#endif
+
+using namespace godot;
+
+#endif // CORE_TYPES_H
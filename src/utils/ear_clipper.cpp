@@ -0,0 +1,692 @@
+// The ear clipping here follows Mapbox's earcut (https://github.com/mapbox/earcut),
+// which is distributed under the following license:
+//
+// ISC License
+//
+// Copyright (c) 2016, Mapbox
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose
+// with or without fee is hereby granted, provided that the above copyright notice
+// and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD TO
+// THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+// CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA
+// OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION,
+// ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#include "ear_clipper.h"
+
+#include <algorithm>
+#include <limits>
+
+_FORCE_INLINE_ bool point_in_triangle(real_t ax, real_t ay, real_t bx, real_t by, real_t cx, real_t cy, real_t px, real_t py) {
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+        (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+        (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+_FORCE_INLINE_ int sign(real_t value) {
+    return value > 0 ? 1 : (value < 0 ? -1 : 0);
+}
+
+void EarClipper::triangulate(const LocalVector<Vector2> &p_points, const LocalVector<int> &hole_starts, LocalVector<int> &r_triangles) {
+    nodes.clear();
+    points = &p_points;
+    triangles = &r_triangles;
+
+    int outer_length = hole_starts.size() > 0 ? hole_starts[0] : p_points.size();
+    int outer_node = linked_list(0, outer_length, true);
+    if (outer_node == -1 || nodes[outer_node].next == nodes[outer_node].prev) {
+        return;
+    }
+
+    if (hole_starts.size() > 0) {
+        outer_node = eliminate_holes(hole_starts, outer_node);
+    }
+
+    // Small polygons aren't worth the trouble of sorting along the curve
+    inv_size = 0;
+    if (p_points.size() > 80) {
+        min_x = p_points[0].x;
+        min_y = p_points[0].y;
+        real_t max_x = min_x;
+        real_t max_y = min_y;
+
+        for (int i = 1; i < outer_length; i++) {
+            min_x = MIN(min_x, p_points[i].x);
+            min_y = MIN(min_y, p_points[i].y);
+            max_x = MAX(max_x, p_points[i].x);
+            max_y = MAX(max_y, p_points[i].y);
+        }
+
+        inv_size = MAX(max_x - min_x, max_y - min_y);
+        inv_size = inv_size != 0 ? 32767 / inv_size : 0;
+    }
+
+    clip(outer_node, 0);
+}
+
+int EarClipper::insert_node(int i, int last) {
+    const Vector2 &point = (*points)[i];
+    Node node = { i, point.x, point.y, -1, -1, 0, -1, -1, false };
+
+    int p = nodes.size();
+    nodes.push_back(node);
+
+    if (last == -1) {
+        nodes[p].prev = p;
+        nodes[p].next = p;
+    } else {
+        nodes[p].next = nodes[last].next;
+        nodes[p].prev = last;
+        nodes[nodes[last].next].prev = p;
+        nodes[last].next = p;
+    }
+
+    return p;
+}
+
+void EarClipper::remove_node(int p) {
+    const Node &node = nodes[p];
+
+    nodes[node.next].prev = node.prev;
+    nodes[node.prev].next = node.next;
+
+    if (node.prev_z != -1) {
+        nodes[node.prev_z].next_z = node.next_z;
+    }
+
+    if (node.next_z != -1) {
+        nodes[node.next_z].prev_z = node.prev_z;
+    }
+}
+
+int EarClipper::linked_list(int start, int end, bool clockwise) {
+    const LocalVector<Vector2> &ring = *points;
+
+    real_t signed_area = 0;
+    for (int i = start, j = end - 1; i < end; j = i++) {
+        signed_area += (ring[j].x - ring[i].x) * (ring[i].y + ring[j].y);
+    }
+
+    // Rings get linked in whichever direction makes them wind the way we want
+    int last = -1;
+    if (clockwise == (signed_area > 0)) {
+        for (int i = start; i < end; i++) {
+            last = insert_node(i, last);
+        }
+    } else {
+        for (int i = end - 1; i >= start; i--) {
+            last = insert_node(i, last);
+        }
+    }
+
+    if (last != -1 && equals(last, nodes[last].next)) {
+        remove_node(last);
+        last = nodes[last].next;
+    }
+
+    return last;
+}
+
+int EarClipper::filter_points(int start, int end) {
+    if (start == -1) {
+        return start;
+    }
+
+    if (end == -1) {
+        end = start;
+    }
+
+    // Drops duplicated and collinear points
+    int p = start;
+    bool again;
+    do {
+        again = false;
+
+        if (!nodes[p].steiner && (equals(p, nodes[p].next) || area(nodes[p].prev, p, nodes[p].next) == 0)) {
+            remove_node(p);
+            p = end = nodes[p].prev;
+            if (p == nodes[p].next) {
+                break;
+            }
+            again = true;
+        } else {
+            p = nodes[p].next;
+        }
+    } while (again || p != end);
+
+    return end;
+}
+
+void EarClipper::clip(int ear, int pass) {
+    if (ear == -1) {
+        return;
+    }
+
+    if (pass == 0 && inv_size != 0) {
+        index_curve(ear);
+    }
+
+    int stop = ear;
+
+    while (nodes[ear].prev != nodes[ear].next) {
+        int prev = nodes[ear].prev;
+        int next = nodes[ear].next;
+
+        if (inv_size != 0 ? is_ear_hashed(ear) : is_ear(ear)) {
+            emit(prev, ear, next);
+            remove_node(ear);
+
+            // Skipping the next vertex leads to less sliver triangles
+            ear = nodes[next].next;
+            stop = nodes[next].next;
+            continue;
+        }
+
+        ear = next;
+
+        // Went all the way around without finding an ear, things need some cleaning up first
+        if (ear == stop) {
+            if (pass == 0) {
+                clip(filter_points(ear), 1);
+            } else if (pass == 1) {
+                // The ring may be crossing over itself
+                ear = cure_local_intersections(filter_points(ear));
+                clip(ear, 2);
+            } else if (pass == 2) {
+                // Last resort, cut the ring in two and go at each half separately
+                split_clip(ear);
+            }
+
+            break;
+        }
+    }
+}
+
+bool EarClipper::is_ear(int ear) const {
+    int a = nodes[ear].prev;
+    int c = nodes[ear].next;
+
+    // Reflex, can't be an ear
+    if (area(a, ear, c) >= 0) {
+        return false;
+    }
+
+    real_t ax = nodes[a].x, ay = nodes[a].y;
+    real_t bx = nodes[ear].x, by = nodes[ear].y;
+    real_t cx = nodes[c].x, cy = nodes[c].y;
+
+    real_t x0 = MIN(ax, MIN(bx, cx)), y0 = MIN(ay, MIN(by, cy));
+    real_t x1 = MAX(ax, MAX(bx, cx)), y1 = MAX(ay, MAX(by, cy));
+
+    // It's only an ear if no other point of the ring is inside it
+    int p = nodes[c].next;
+    while (p != a) {
+        const Node &node = nodes[p];
+        if (node.x >= x0 && node.x <= x1 && node.y >= y0 && node.y <= y1 &&
+                point_in_triangle(ax, ay, bx, by, cx, cy, node.x, node.y) &&
+                area(node.prev, p, node.next) >= 0) {
+            return false;
+        }
+        p = node.next;
+    }
+
+    return true;
+}
+
+bool EarClipper::is_ear_hashed(int ear) const {
+    int a = nodes[ear].prev;
+    int c = nodes[ear].next;
+
+    if (area(a, ear, c) >= 0) {
+        return false;
+    }
+
+    real_t ax = nodes[a].x, ay = nodes[a].y;
+    real_t bx = nodes[ear].x, by = nodes[ear].y;
+    real_t cx = nodes[c].x, cy = nodes[c].y;
+
+    real_t x0 = MIN(ax, MIN(bx, cx)), y0 = MIN(ay, MIN(by, cy));
+    real_t x1 = MAX(ax, MAX(bx, cx)), y1 = MAX(ay, MAX(by, cy));
+
+    // Only the points whose Z-order falls within that of the triangle's bounds can be inside it
+    uint32_t min_z = z_order(x0, y0);
+    uint32_t max_z = z_order(x1, y1);
+
+    int p = nodes[ear].prev_z;
+    int n = nodes[ear].next_z;
+
+    // Looking both ways along the curve at once
+    while (p != -1 && nodes[p].z >= min_z && n != -1 && nodes[n].z <= max_z) {
+        const Node &pn = nodes[p];
+        if (pn.x >= x0 && pn.x <= x1 && pn.y >= y0 && pn.y <= y1 && p != a && p != c &&
+                point_in_triangle(ax, ay, bx, by, cx, cy, pn.x, pn.y) && area(pn.prev, p, pn.next) >= 0) {
+            return false;
+        }
+        p = pn.prev_z;
+
+        const Node &nn = nodes[n];
+        if (nn.x >= x0 && nn.x <= x1 && nn.y >= y0 && nn.y <= y1 && n != a && n != c &&
+                point_in_triangle(ax, ay, bx, by, cx, cy, nn.x, nn.y) && area(nn.prev, n, nn.next) >= 0) {
+            return false;
+        }
+        n = nn.next_z;
+    }
+
+    while (p != -1 && nodes[p].z >= min_z) {
+        const Node &pn = nodes[p];
+        if (pn.x >= x0 && pn.x <= x1 && pn.y >= y0 && pn.y <= y1 && p != a && p != c &&
+                point_in_triangle(ax, ay, bx, by, cx, cy, pn.x, pn.y) && area(pn.prev, p, pn.next) >= 0) {
+            return false;
+        }
+        p = pn.prev_z;
+    }
+
+    while (n != -1 && nodes[n].z <= max_z) {
+        const Node &nn = nodes[n];
+        if (nn.x >= x0 && nn.x <= x1 && nn.y >= y0 && nn.y <= y1 && n != a && n != c &&
+                point_in_triangle(ax, ay, bx, by, cx, cy, nn.x, nn.y) && area(nn.prev, n, nn.next) >= 0) {
+            return false;
+        }
+        n = nn.next_z;
+    }
+
+    return true;
+}
+
+int EarClipper::cure_local_intersections(int start) {
+    int p = start;
+
+    do {
+        int a = nodes[p].prev;
+        int b = nodes[nodes[p].next].next;
+
+        if (!equals(a, b) && intersects(a, p, nodes[p].next, b) && locally_inside(a, b) && locally_inside(b, a)) {
+            emit(a, p, b);
+
+            remove_node(p);
+            remove_node(nodes[p].next);
+
+            p = start = b;
+        }
+
+        p = nodes[p].next;
+    } while (p != start);
+
+    return filter_points(p);
+}
+
+void EarClipper::split_clip(int start) {
+    int a = start;
+
+    do {
+        int b = nodes[nodes[a].next].next;
+
+        while (b != nodes[a].prev) {
+            if (nodes[a].i != nodes[b].i && is_valid_diagonal(a, b)) {
+                int c = split_polygon(a, b);
+
+                a = filter_points(a, nodes[a].next);
+                c = filter_points(c, nodes[c].next);
+
+                clip(a, 0);
+                clip(c, 0);
+                return;
+            }
+
+            b = nodes[b].next;
+        }
+
+        a = nodes[a].next;
+    } while (a != start);
+}
+
+int EarClipper::eliminate_holes(const LocalVector<int> &hole_starts, int outer_node) {
+    hole_queue.clear();
+
+    for (uint32_t i = 0; i < hole_starts.size(); i++) {
+        int start = hole_starts[i];
+        int end = i + 1 < hole_starts.size() ? hole_starts[i + 1] : (int)points->size();
+
+        int list = linked_list(start, end, false);
+        if (list == -1) {
+            continue;
+        }
+
+        if (list == nodes[list].next) {
+            nodes[list].steiner = true;
+        }
+
+        hole_queue.push_back(get_leftmost(list));
+    }
+
+    // Bridging from left to right keeps the bridges from crossing each other
+    const LocalVector<Node> &hole_nodes = nodes;
+    std::sort(hole_queue.ptr(), hole_queue.ptr() + hole_queue.size(), [&hole_nodes](int a, int b) {
+        return hole_nodes[a].x < hole_nodes[b].x;
+    });
+
+    for (uint32_t i = 0; i < hole_queue.size(); i++) {
+        outer_node = eliminate_hole(hole_queue[i], outer_node);
+    }
+
+    return outer_node;
+}
+
+int EarClipper::eliminate_hole(int hole, int outer_node) {
+    int bridge = find_hole_bridge(hole, outer_node);
+    if (bridge == -1) {
+        return outer_node;
+    }
+
+    int bridge_reverse = split_polygon(bridge, hole);
+
+    filter_points(bridge_reverse, nodes[bridge_reverse].next);
+    return filter_points(bridge, nodes[bridge].next);
+}
+
+int EarClipper::find_hole_bridge(int hole, int outer_node) const {
+    real_t hx = nodes[hole].x;
+    real_t hy = nodes[hole].y;
+    real_t qx = -std::numeric_limits<real_t>::infinity();
+    int m = -1;
+
+    // Find the closest edge of the outline to the left of the hole's leftmost point,
+    // and the endpoint of it that's furthest to the left
+    int p = outer_node;
+    do {
+        const Node &pn = nodes[p];
+        const Node &nn = nodes[pn.next];
+
+        if (hy <= pn.y && hy >= nn.y && nn.y != pn.y) {
+            real_t x = pn.x + (hy - pn.y) * (nn.x - pn.x) / (nn.y - pn.y);
+            if (x <= hx && x > qx) {
+                qx = x;
+                m = pn.x < nn.x ? p : pn.next;
+                if (x == hx) {
+                    // The hole touches the outline
+                    return m;
+                }
+            }
+        }
+
+        p = pn.next;
+    } while (p != outer_node);
+
+    if (m == -1) {
+        return -1;
+    }
+
+    // Any point of the outline inside the triangle between the hole's point, the crossing
+    // and that endpoint would block the bridge. If there's some, go with the one that makes
+    // the smallest angle with the ray instead
+    int stop = m;
+    real_t mx = nodes[m].x;
+    real_t my = nodes[m].y;
+    real_t tan_min = std::numeric_limits<real_t>::infinity();
+
+    p = m;
+    do {
+        const Node &pn = nodes[p];
+
+        if (hx >= pn.x && pn.x >= mx && hx != pn.x &&
+                point_in_triangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, pn.x, pn.y)) {
+            real_t tan = Math::abs(hy - pn.y) / (hx - pn.x);
+
+            if (locally_inside(p, hole) &&
+                    (tan < tan_min || (tan == tan_min && (pn.x > nodes[m].x || (pn.x == nodes[m].x && sector_contains_sector(m, p)))))) {
+                m = p;
+                tan_min = tan;
+            }
+        }
+
+        p = pn.next;
+    } while (p != stop);
+
+    return m;
+}
+
+int EarClipper::get_leftmost(int start) const {
+    int p = start;
+    int leftmost = start;
+
+    do {
+        if (nodes[p].x < nodes[leftmost].x || (nodes[p].x == nodes[leftmost].x && nodes[p].y < nodes[leftmost].y)) {
+            leftmost = p;
+        }
+        p = nodes[p].next;
+    } while (p != start);
+
+    return leftmost;
+}
+
+void EarClipper::index_curve(int start) {
+    int p = start;
+
+    do {
+        Node &node = nodes[p];
+        if (node.z == 0) {
+            node.z = z_order(node.x, node.y);
+        }
+        node.prev_z = node.prev;
+        node.next_z = node.next;
+        p = node.next;
+    } while (p != start);
+
+    nodes[nodes[p].prev_z].next_z = -1;
+    nodes[p].prev_z = -1;
+
+    sort_linked(p);
+}
+
+void EarClipper::sort_linked(int list) {
+    // Bottom up merge sort of the z links
+    int in_size = 1;
+    int merges;
+
+    do {
+        int p = list;
+        int tail = -1;
+        list = -1;
+        merges = 0;
+
+        while (p != -1) {
+            merges++;
+
+            int q = p;
+            int p_size = 0;
+            for (int i = 0; i < in_size; i++) {
+                p_size++;
+                q = nodes[q].next_z;
+                if (q == -1) {
+                    break;
+                }
+            }
+
+            int q_size = in_size;
+
+            while (p_size > 0 || (q_size > 0 && q != -1)) {
+                int e;
+                if (p_size != 0 && (q_size == 0 || q == -1 || nodes[p].z <= nodes[q].z)) {
+                    e = p;
+                    p = nodes[p].next_z;
+                    p_size--;
+                } else {
+                    e = q;
+                    q = nodes[q].next_z;
+                    q_size--;
+                }
+
+                if (tail != -1) {
+                    nodes[tail].next_z = e;
+                } else {
+                    list = e;
+                }
+
+                nodes[e].prev_z = tail;
+                tail = e;
+            }
+
+            p = q;
+        }
+
+        nodes[tail].next_z = -1;
+        in_size *= 2;
+    } while (merges > 1);
+}
+
+uint32_t EarClipper::z_order(real_t px, real_t py) const {
+    uint32_t x = (uint32_t)((px - min_x) * inv_size);
+    uint32_t y = (uint32_t)((py - min_y) * inv_size);
+
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+
+    y = (y | (y << 8)) & 0x00FF00FF;
+    y = (y | (y << 4)) & 0x0F0F0F0F;
+    y = (y | (y << 2)) & 0x33333333;
+    y = (y | (y << 1)) & 0x55555555;
+
+    return x | (y << 1);
+}
+
+real_t EarClipper::area(int p, int q, int r) const {
+    const Node &pn = nodes[p];
+    const Node &qn = nodes[q];
+    const Node &rn = nodes[r];
+    return (qn.y - pn.y) * (rn.x - qn.x) - (qn.x - pn.x) * (rn.y - qn.y);
+}
+
+bool EarClipper::equals(int a, int b) const {
+    return nodes[a].x == nodes[b].x && nodes[a].y == nodes[b].y;
+}
+
+bool EarClipper::on_segment(int p, int q, int r) const {
+    const Node &pn = nodes[p];
+    const Node &qn = nodes[q];
+    const Node &rn = nodes[r];
+    return qn.x <= MAX(pn.x, rn.x) && qn.x >= MIN(pn.x, rn.x) && qn.y <= MAX(pn.y, rn.y) && qn.y >= MIN(pn.y, rn.y);
+}
+
+bool EarClipper::intersects(int p1, int q1, int p2, int q2) const {
+    int o1 = sign(area(p1, q1, p2));
+    int o2 = sign(area(p1, q1, q2));
+    int o3 = sign(area(p2, q2, p1));
+    int o4 = sign(area(p2, q2, q1));
+
+    if (o1 != o2 && o3 != o4) {
+        return true;
+    }
+
+    // Collinear and overlapping
+    return (o1 == 0 && on_segment(p1, p2, q1)) ||
+        (o2 == 0 && on_segment(p1, q2, q1)) ||
+        (o3 == 0 && on_segment(p2, p1, q2)) ||
+        (o4 == 0 && on_segment(p2, q1, q2));
+}
+
+bool EarClipper::intersects_polygon(int a, int b) const {
+    int p = a;
+
+    do {
+        const Node &node = nodes[p];
+        if (node.i != nodes[a].i && nodes[node.next].i != nodes[a].i && node.i != nodes[b].i && nodes[node.next].i != nodes[b].i &&
+                intersects(p, node.next, a, b)) {
+            return true;
+        }
+        p = node.next;
+    } while (p != a);
+
+    return false;
+}
+
+bool EarClipper::locally_inside(int a, int b) const {
+    const Node &an = nodes[a];
+
+    if (area(an.prev, a, an.next) < 0) {
+        return area(a, b, an.next) >= 0 && area(a, an.prev, b) >= 0;
+    }
+
+    return area(a, b, an.prev) < 0 || area(a, an.next, b) < 0;
+}
+
+bool EarClipper::middle_inside(int a, int b) const {
+    real_t px = (nodes[a].x + nodes[b].x) / 2;
+    real_t py = (nodes[a].y + nodes[b].y) / 2;
+    bool inside = false;
+
+    int p = a;
+    do {
+        const Node &pn = nodes[p];
+        const Node &nn = nodes[pn.next];
+
+        if (((pn.y > py) != (nn.y > py)) && nn.y != pn.y && (px < (nn.x - pn.x) * (py - pn.y) / (nn.y - pn.y) + pn.x)) {
+            inside = !inside;
+        }
+
+        p = pn.next;
+    } while (p != a);
+
+    return inside;
+}
+
+bool EarClipper::sector_contains_sector(int m, int p) const {
+    return area(nodes[m].prev, m, nodes[p].prev) < 0 && area(nodes[p].next, m, nodes[m].next) < 0;
+}
+
+bool EarClipper::is_valid_diagonal(int a, int b) const {
+    const Node &an = nodes[a];
+    const Node &bn = nodes[b];
+
+    if (nodes[an.next].i == bn.i || nodes[an.prev].i == bn.i || intersects_polygon(a, b)) {
+        return false;
+    }
+
+    bool visible = locally_inside(a, b) && locally_inside(b, a) && middle_inside(a, b) &&
+        (area(an.prev, a, bn.prev) != 0 || area(a, bn.prev, b) != 0);
+
+    // Two coincident points with the ring going through both
+    bool zero_length = equals(a, b) && area(an.prev, a, an.next) > 0 && area(bn.prev, b, bn.next) > 0;
+
+    return visible || zero_length;
+}
+
+int EarClipper::split_polygon(int a, int b) {
+    // Links a and b with a diagonal, splitting the ring in two. Each of them gets a
+    // copy so both rings have their own
+    Node a_copy = { nodes[a].i, nodes[a].x, nodes[a].y, -1, -1, 0, -1, -1, false };
+    Node b_copy = { nodes[b].i, nodes[b].x, nodes[b].y, -1, -1, 0, -1, -1, false };
+
+    int a2 = nodes.size();
+    nodes.push_back(a_copy);
+    int b2 = nodes.size();
+    nodes.push_back(b_copy);
+
+    int an = nodes[a].next;
+    int bp = nodes[b].prev;
+
+    nodes[a].next = b;
+    nodes[b].prev = a;
+
+    nodes[a2].next = an;
+    nodes[an].prev = a2;
+
+    nodes[b2].next = a2;
+    nodes[a2].prev = b2;
+
+    nodes[bp].next = b2;
+    nodes[b2].prev = bp;
+
+    return b2;
+}
+
+void EarClipper::emit(int a, int b, int c) {
+    triangles->push_back(nodes[a].i);
+    triangles->push_back(nodes[b].i);
+    triangles->push_back(nodes[c].i);
+}
@@ -0,0 +1,104 @@
+// The ear clipping here follows Mapbox's earcut (https://github.com/mapbox/earcut),
+// which is distributed under the following license:
+//
+// ISC License
+//
+// Copyright (c) 2016, Mapbox
+//
+// Permission to use, copy, modify, and/or distribute this software for any purpose
+// with or without fee is hereby granted, provided that the above copyright notice
+// and this permission notice appear in all copies.
+//
+// THE SOFTWARE IS PROVIDED "AS IS" AND ISC DISCLAIMS ALL WARRANTIES WITH REGARD TO
+// THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS.
+// IN NO EVENT SHALL ISC BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR
+// CONSEQUENTIAL DAMAGES OR ANY DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA
+// OR PROFITS, WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION,
+// ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+#ifndef EAR_CLIPPER_H
+#define EAR_CLIPPER_H
+
+#include "core_types.h"
+#include "memory_tracker.h"
+
+/**
+ * Triangulates simple polygons, holes and all, by clipping ears. Holes get bridged into
+ * the outline first so there's only a single ring left to clip. Past a handful of points,
+ * the ring also gets threaded along a Z-order curve so checking whether an ear is empty
+ * only has to look at the points near it rather than every point of the polygon. Based
+ * on Mapbox's earcut. Keep one around to reuse its memory from one polygon to the next
+*/
+struct EarClipper {
+    /**
+     * Triangulates the polygon whose outline is made of points up to the first of hole_starts,
+     * with each hole running from its start up to the next one. Appends three indices into
+     * points for every triangle to r_triangles, all wound counterclockwise. Rings can be
+     * given in either winding
+    */
+    void triangulate(const LocalVector<Vector2> &points, const LocalVector<int> &hole_starts, LocalVector<int> &r_triangles);
+
+    void track_memory(MemoryTracker &tracker) const {
+        tracker.add(nodes);
+        tracker.add(hole_queue);
+    }
+
+private:
+    // A vertex in one of the doubly linked rings being clipped. The z links thread the
+    // same vertexes in Z-order, -1 marks the ends
+    struct Node {
+        int i;
+        real_t x;
+        real_t y;
+        int prev;
+        int next;
+        uint32_t z;
+        int prev_z;
+        int next_z;
+        bool steiner;
+    };
+
+    LocalVector<Node> nodes;
+    LocalVector<int> hole_queue;
+
+    const LocalVector<Vector2> *points = nullptr;
+    LocalVector<int> *triangles = nullptr;
+
+    real_t min_x = 0;
+    real_t min_y = 0;
+    real_t inv_size = 0;
+
+    int insert_node(int i, int last);
+    void remove_node(int p);
+    int linked_list(int start, int end, bool clockwise);
+    int filter_points(int start, int end = -1);
+
+    void clip(int ear, int pass);
+    bool is_ear(int ear) const;
+    bool is_ear_hashed(int ear) const;
+    int cure_local_intersections(int start);
+    void split_clip(int start);
+
+    int eliminate_holes(const LocalVector<int> &hole_starts, int outer_node);
+    int eliminate_hole(int hole, int outer_node);
+    int find_hole_bridge(int hole, int outer_node) const;
+    int get_leftmost(int start) const;
+
+    void index_curve(int start);
+    void sort_linked(int list);
+    uint32_t z_order(real_t x, real_t y) const;
+
+    real_t area(int p, int q, int r) const;
+    bool equals(int a, int b) const;
+    bool intersects(int p1, int q1, int p2, int q2) const;
+    bool on_segment(int p, int q, int r) const;
+    bool intersects_polygon(int a, int b) const;
+    bool locally_inside(int a, int b) const;
+    bool middle_inside(int a, int b) const;
+    bool sector_contains_sector(int m, int p) const;
+    bool is_valid_diagonal(int a, int b) const;
+    int split_polygon(int a, int b);
+    void emit(int a, int b, int c);
+};
+
+#endif // EAR_CLIPPER_H
@@ -1,7 +1,7 @@
 #ifndef FACE_FILLER_H
 #define FACE_FILLER_H
 
-#include "slicer_face.h"
+#include "mesh_buffer.h"
 
 // This just mimics logic found in TriangleMesh#Create
 _FORCE_INLINE_ Vector3 snap_vertex(Vector3 v) {
@@ -10,11 +10,12 @@ _FORCE_INLINE_ Vector3 snap_vertex(Vector3 v) {
 
 /**
  * Responsible for serializing data from vertex arrays, as they are
- * given from the visual server, into an array of SlicerFaces while
- * maintaining info about things such as normals and uvs etc.
+ * given from the visual server, into the attribute streams of a
+ * MeshBuffer while maintaining info about things such as normals
+ * and uvs etc.
 */
 struct FaceFiller {
-    SlicerFace *faces_writer;
+    MeshBuffer *buffer;
     const Vector3 *vertices_reader;
 
     bool has_normals;
@@ -38,17 +39,30 @@ struct FaceFiller {
     bool has_uv2s;
     const Vector2 *uv2s_reader;
 
+    // The vertexes run fills, all of them unless set otherwise
+    int first;
+    int end;
+
     // Yuck. What an eye sore this constructor is
-    FaceFiller(Vector<SlicerFace> &faces, const Array &surface_arrays) {
-        faces_writer = faces.ptrw();
+    //
+    // The readers point into the packed arrays held by surface_arrays, so it
+    // needs to outlive the filler
+    FaceFiller(MeshBuffer &p_buffer, const Array &surface_arrays, uint32_t format) {
+        buffer = &p_buffer;
 
         PackedVector3Array vertices = surface_arrays[Mesh::ARRAY_VERTEX];
         vertices_reader = vertices.ptr();
+        int vertex_count = vertices.size();
 
+        has_normals = false;
+        if (format & Mesh::ARRAY_FORMAT_NORMAL) {
         PackedVector3Array normals = surface_arrays[Mesh::ARRAY_NORMAL];
         normals_reader = normals.ptr();
-        has_normals = normals.size() > 0 && normals.size() == vertices.size();
+        has_normals = normals.size() > 0 && normals.size() == vertex_count;
+        }
 
+        has_tangents = false;
+        if (format & Mesh::ARRAY_FORMAT_TANGENT) {
         #ifdef REAL_T_IS_DOUBLE
         PackedFloat64Array tangents;
         #else
@@ -56,19 +70,18 @@ struct FaceFiller {
         #endif
         tangents = surface_arrays[Mesh::ARRAY_TANGENT];
         tangents_reader = tangents.ptr();
-        has_tangents = tangents.size() > 0 && tangents.size() == vertices.size() * 4;
-        
-        if (!surface_arrays[Mesh::ARRAY_COLOR]) {
+        has_tangents = tangents.size() > 0 && tangents.size() == vertex_count * 4;
+        }
+
         has_colors = false;
-        } else {
+        if (format & Mesh::ARRAY_FORMAT_COLOR) {
         PackedColorArray colors = surface_arrays[Mesh::ARRAY_COLOR];
         colors_reader = colors.ptr();
-        has_colors = colors.size() > 0 && colors.size() == vertices.size();
+        has_colors = colors.size() > 0 && colors.size() == vertex_count;
         }
 
-        if (!surface_arrays[Mesh::ARRAY_BONES]) {
         has_bones = false;
-        } else {
+        if (format & Mesh::ARRAY_FORMAT_BONES) {
         #ifdef REAL_T_IS_DOUBLE
         PackedFloat64Array bones;
         #else
@@ -76,12 +89,11 @@ struct FaceFiller {
         #endif
         bones = surface_arrays[Mesh::ARRAY_BONES];
         bones_reader = bones.ptr();
-        has_bones = bones.size() > 0 && bones.size() == vertices.size() * 4;
+        has_bones = bones.size() > 0 && bones.size() == vertex_count * 4;
         }
 
-        if (!surface_arrays[Mesh::ARRAY_WEIGHTS]) {
         has_weights = false;
-        } else {
+        if (format & Mesh::ARRAY_FORMAT_WEIGHTS) {
         #ifdef REAL_T_IS_DOUBLE
         PackedFloat64Array weights;
         #else
@@ -89,91 +101,100 @@ struct FaceFiller {
         #endif
         weights = surface_arrays[Mesh::ARRAY_WEIGHTS];
         weights_reader = weights.ptr();
-        has_weights = weights.size() > 0 && weights.size() == vertices.size() * 4;
+        has_weights = weights.size() > 0 && weights.size() == vertex_count * 4;
         }
 
+        has_uvs = false;
+        if (format & Mesh::ARRAY_FORMAT_TEX_UV) {
         PackedVector2Array uvs = surface_arrays[Mesh::ARRAY_TEX_UV];
         uvs_reader = uvs.ptr();
-        has_uvs = uvs.size() > 0 && uvs.size() == vertices.size();
+        has_uvs = uvs.size() > 0 && uvs.size() == vertex_count;
+        }
 
-        if (!surface_arrays[Mesh::ARRAY_TEX_UV2]) {
         has_uv2s = false;
-        } else {
+        if (format & Mesh::ARRAY_FORMAT_TEX_UV2) {
         PackedVector2Array uv2s = surface_arrays[Mesh::ARRAY_TEX_UV2];
         uv2s_reader = uv2s.ptr();
-        has_uv2s = uv2s.size() > 0 && uv2s.size() == vertices.size();
+        has_uv2s = uv2s.size() > 0 && uv2s.size() == vertex_count;
         }
+
+        // Only keep the streams we were actually able to read
+        buffer->format = 0;
+        buffer->format |= has_normals ? Mesh::ARRAY_FORMAT_NORMAL : 0;
+        buffer->format |= has_tangents ? Mesh::ARRAY_FORMAT_TANGENT : 0;
+        buffer->format |= has_colors ? Mesh::ARRAY_FORMAT_COLOR : 0;
+        buffer->format |= has_bones ? Mesh::ARRAY_FORMAT_BONES : 0;
+        buffer->format |= has_weights ? Mesh::ARRAY_FORMAT_WEIGHTS : 0;
+        buffer->format |= has_uvs ? Mesh::ARRAY_FORMAT_TEX_UV : 0;
+        buffer->format |= has_uv2s ? Mesh::ARRAY_FORMAT_TEX_UV2 : 0;
+
+        buffer->resize_vertices(vertex_count);
+        first = 0;
+        end = vertex_count;
     }
 
     /**
-     * Takes data from the vertex array using the lookup_idx and puts it into
-     * our face vector using set_idx
-    */ 
-    _FORCE_INLINE_ void fill(int set_idx, int lookup_idx) {
-        // Having this function work vertex by vertex makes the code a bit nicer,
-        // especially with having to support indexed and non-indexed vertexes,
-        // but just performance-wise I hate it. There's no reason, besides uglier
-        // and more complicated code, why we can't be doing these has_* checks on
-        // a per face basis. Maybe even a per mesh basis. Admitidly it'll probably
-        // all come out in the wash, but it bothers me conceptually. Let's put in
-        // a TODO about it. Maybe there's something incredibly clever we can do with
-        // macros that *won't* make me want to tear out what's left of my hair.
-        int face_idx = set_idx / 3;
-        int set_offset = set_idx % 3;
-
-        if (set_offset == 0) {
-            faces_writer[face_idx].has_normals = has_normals;
-            faces_writer[face_idx].has_tangents = has_tangents;
-            faces_writer[face_idx].has_colors = has_colors;
-            faces_writer[face_idx].has_bones = has_bones;
-            faces_writer[face_idx].has_weights = has_weights;
-            faces_writer[face_idx].has_uvs = has_uvs;
-            faces_writer[face_idx].has_uv2s = has_uv2s;
+     * Takes the vertex at idx from the vertex arrays and puts it into
+     * the same slot of our buffer's streams. FORMAT is the buffer's format,
+     * or VertexFormat::DYNAMIC to have it checked vertex by vertex
+    */
+    template <uint32_t FORMAT>
+    _FORCE_INLINE_ void fill(int idx) {
+        const uint32_t format = buffer->format;
+
+        buffer->vertices[idx] = snap_vertex(vertices_reader[idx]);
+
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_NORMAL)) {
+            buffer->normals[idx] = normals_reader[idx];
         }
 
-        faces_writer[face_idx].vertex[set_offset] = snap_vertex(vertices_reader[lookup_idx]);
-
-        if (has_normals) {
-            faces_writer[face_idx].normal[set_offset] = normals_reader[lookup_idx];
-        }
-
-        if (has_tangents) {
-            faces_writer[face_idx].tangent[set_offset] = SlicerVector4(
-                tangents_reader[lookup_idx * 4],
-                tangents_reader[lookup_idx * 4 + 1],
-                tangents_reader[lookup_idx * 4 + 2],
-                tangents_reader[lookup_idx * 4 + 3]
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TANGENT)) {
+            buffer->tangents[idx] = SlicerVector4(
+                tangents_reader[idx * 4],
+                tangents_reader[idx * 4 + 1],
+                tangents_reader[idx * 4 + 2],
+                tangents_reader[idx * 4 + 3]
             );
         }
 
-        if (has_colors) {
-            faces_writer[face_idx].color[set_offset] = colors_reader[lookup_idx];
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_COLOR)) {
+            buffer->colors[idx] = colors_reader[idx];
         }
 
-        if (has_bones) {
-            faces_writer[face_idx].bones[set_offset] = SlicerVector4(
-                bones_reader[lookup_idx * 4],
-                bones_reader[lookup_idx * 4 + 1],
-                bones_reader[lookup_idx * 4 + 2],
-                bones_reader[lookup_idx * 4 + 3]
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_BONES)) {
+            buffer->bones[idx] = SlicerVector4(
+                bones_reader[idx * 4],
+                bones_reader[idx * 4 + 1],
+                bones_reader[idx * 4 + 2],
+                bones_reader[idx * 4 + 3]
             );
         }
 
-        if (has_weights) {
-            faces_writer[face_idx].weights[set_offset] = SlicerVector4(
-                weights_reader[lookup_idx],
-                weights_reader[lookup_idx * 4 + 1],
-                weights_reader[lookup_idx * 4 + 2],
-                weights_reader[lookup_idx * 4 + 3]
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_WEIGHTS)) {
+            buffer->weights[idx] = SlicerVector4(
+                weights_reader[idx * 4],
+                weights_reader[idx * 4 + 1],
+                weights_reader[idx * 4 + 2],
+                weights_reader[idx * 4 + 3]
             );
         }
 
-        if (has_uvs) {
-            faces_writer[face_idx].uv[set_offset] = uvs_reader[lookup_idx];
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TEX_UV)) {
+            buffer->uvs[idx] = uvs_reader[idx];
+        }
+
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TEX_UV2)) {
+            buffer->uv2s[idx] = uv2s_reader[idx];
         }
+    }
 
-        if (has_uv2s) {
-            faces_writer[face_idx].uv2[set_offset] = uv2s_reader[lookup_idx];
+    /**
+     * Fills the vertexes from first up to end, see VertexFormat::dispatch
+    */
+    template <uint32_t FORMAT>
+    void run() {
+        for (int i = first; i < end; i++) {
+            fill<FORMAT>(i);
         }
     }
 };
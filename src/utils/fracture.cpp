@@ -0,0 +1,483 @@
+#include "fracture.h"
+#include <atomic>
+#include <godot_cpp/classes/os.hpp>
+#include "parallel.h"
+#include "random.h"
+#include "trace.h"
+
+namespace Fracture {
+    /**
+     * Adds the faces of the cap to the side. They go into the surface that already has the
+     * cap's material and streams, which after the first cut is the cap of an earlier one, so
+     * a piece only ever has the one surface (and draw call) for its caps however many cuts
+     * it took to make it
+    */
+    void add_cap(Piece &side, const MeshBuffer &cap, const Ref<Material> cap_material, bool is_upper) {
+        if (cap.face_count() == 0) {
+            return;
+        }
+
+        Ref<Material> material = cap_material.is_valid() ? cap_material : side.surfaces[0].material;
+
+        // As with SlicedMesh, the cap of the upper side is wound the other way around so
+        // that its normal faces outwards
+        for (uint32_t i = 0; i < side.surfaces.size(); i++) {
+            MeshBuffer &surface = side.surfaces[i].surface;
+            if (side.surfaces[i].material == material && surface.format == cap.format) {
+                surface.append(cap, cap.indices, is_upper);
+                return;
+            }
+        }
+
+        int idx = side.surfaces.size();
+        side.surfaces.resize(idx + 1);
+        side.surfaces[idx].material = material;
+        side.surfaces[idx].surface.extract(cap, cap.indices, is_upper);
+    }
+
+    /**
+     * Builds one side of a cut piece out of the faces on that side of every surface
+     * plus the cap. Returns null if there's nothing on that side
+    */
+    Piece *build_side(const Piece &piece, const MeshBuffer &cap, const Ref<Material> cap_material, bool is_upper) {
+        Piece *side = memnew(Piece);
+
+        for (uint32_t i = 0; i < piece.surfaces.size(); i++) {
+            const Intersector::SplitResult &split = piece.surfaces[i];
+            const LocalVector<int> &indices = is_upper ? split.upper_indices : split.lower_indices;
+            if (indices.size() == 0) {
+                continue;
+            }
+
+            int idx = side->surfaces.size();
+            side->surfaces.resize(idx + 1);
+            side->surfaces[idx].material = split.material;
+            side->surfaces[idx].surface.extract(split.surface, indices);
+        }
+
+        if (side->surfaces.size() == 0) {
+            memdelete(side);
+            return nullptr;
+        }
+
+        add_cap(*side, cap, cap_material, is_upper);
+        return side;
+    }
+
+    /**
+     * Splits every surface of the piece by the plane, gathering up the intersection points
+     * and cut segments into the workspace. Returns whether any face ended up above the plane
+    */
+    bool cut(Piece &piece, const Plane &plane, bool specialized, Workspace &workspace) {
+        LocalVector<Vector3> &r_intersection_points = workspace.intersection_points;
+        LocalVector<Vector3> &r_segments = workspace.segments;
+        r_intersection_points.clear();
+        r_segments.clear();
+        bool has_upper = false;
+
+        for (uint32_t i = 0; i < piece.surfaces.size(); i++) {
+            Intersector::SplitResult &split = piece.surfaces[i];
+            Intersector::split_surface_by_plane(plane, split, specialized);
+
+            for (uint32_t j = 0; j < split.intersection_points.size(); j++) {
+                r_intersection_points.push_back(split.intersection_points[j]);
+            }
+
+            for (uint32_t j = 0; j < split.cut_segments.size(); j++) {
+                r_segments.push_back(split.cut_segments[j]);
+            }
+
+            has_upper = has_upper || split.upper_indices.size() > 0;
+        }
+
+        return has_upper;
+    }
+
+    /**
+     * For when the plane didn't end up crossing the piece. Nothing was added to the surfaces
+     * so we just need to forget about the split so the next plane starts fresh
+    */
+    void forget_cut(Piece &piece) {
+        for (uint32_t i = 0; i < piece.surfaces.size(); i++) {
+            piece.surfaces[i].upper_indices.clear();
+            piece.surfaces[i].lower_indices.clear();
+            piece.surfaces[i].intersection_points.clear();
+            piece.surfaces[i].cut_segments.clear();
+        }
+    }
+
+    /**
+     * Triangulates the cut gathered by cut() into workspace.cap
+    */
+    _FORCE_INLINE_ void build_cap(const Plane &plane, Workspace &workspace) {
+        Triangulator::cap(workspace.segments, workspace.intersection_points, plane.normal, workspace.triangulator, workspace.cap);
+    }
+
+    _FORCE_INLINE_ bool has_cut(const Workspace &workspace) {
+        // Through a ring of vertexes the plane only leaves segments, see SlicePipeline::gather_cut
+        return workspace.intersection_points.size() > 0 || workspace.segments.size() > 0;
+    }
+
+    bool split_piece(Piece &piece, const Plane &plane, const Ref<Material> cap_material, bool specialized, Workspace &workspace, Piece *&r_upper, Piece *&r_lower) {
+        r_upper = nullptr;
+        r_lower = nullptr;
+
+        bool has_upper = cut(piece, plane, specialized, workspace);
+        if (!has_cut(workspace)) {
+            forget_cut(piece);
+
+            if (has_upper) {
+                r_upper = &piece;
+            } else {
+                r_lower = &piece;
+            }
+            return false;
+        }
+
+        build_cap(plane, workspace);
+
+        r_upper = build_side(piece, workspace.cap, cap_material, true);
+        r_lower = build_side(piece, workspace.cap, cap_material, false);
+        return true;
+    }
+
+    /**
+     * Cuts every piece of one level of the tree by the same plane. The two sides
+     * of pieces[i] go to children[i * 2] and children[i * 2 + 1]
+    */
+    struct LevelSplitter {
+        const LocalVector<Piece *> &pieces;
+        LocalVector<Piece *> &children;
+        const Plane &plane;
+        Ref<Material> cap_material;
+        bool specialized;
+
+        void operator()(uint32_t idx) {
+            TRACE_ZONE("fracture piece");
+            Workspace workspace;
+            Piece *piece = pieces[idx];
+            if (split_piece(*piece, plane, cap_material, specialized, workspace, children[idx * 2], children[idx * 2 + 1])) {
+                memdelete(piece);
+            }
+        }
+    };
+
+    /**
+     * Cuts the piece by planes[plane_idx] and every plane after it, depth first, appending the
+     * cells it ends up as to r_cells. Upper sides come before lower ones, the same order
+     * LevelSplitter leaves them in
+    */
+    void fracture_subtree(Piece *piece, const LocalVector<Plane> &planes, uint32_t plane_idx, const Ref<Material> cap_material, bool specialized, Workspace &workspace, LocalVector<Piece *> &r_cells) {
+        if (plane_idx == planes.size()) {
+            r_cells.push_back(piece);
+            return;
+        }
+
+        Piece *upper;
+        Piece *lower;
+        if (split_piece(*piece, planes[plane_idx], cap_material, specialized, workspace, upper, lower)) {
+            memdelete(piece);
+        }
+
+        if (upper) {
+            fracture_subtree(upper, planes, plane_idx + 1, cap_material, specialized, workspace, r_cells);
+        }
+        if (lower) {
+            fracture_subtree(lower, planes, plane_idx + 1, cap_material, specialized, workspace, r_cells);
+        }
+    }
+
+    /**
+     * Cuts each of the pieces by the rest of the planes as a task of its own, see fracture_subtree
+    */
+    struct SubtreeSplitter {
+        const LocalVector<Piece *> &pieces;
+        LocalVector<LocalVector<Piece *>> &cells;
+        const LocalVector<Plane> &planes;
+        uint32_t plane_idx;
+        Ref<Material> cap_material;
+        bool specialized;
+
+        void operator()(uint32_t idx) {
+            TRACE_ZONE("fracture subtree");
+            Workspace workspace;
+            fracture_subtree(pieces[idx], planes, plane_idx, cap_material, specialized, workspace, cells[idx]);
+        }
+    };
+
+    void fracture(Piece *root, const LocalVector<Plane> &planes, const Ref<Material> cap_material, bool specialized, bool parallel, LocalVector<Piece *> &r_cells) {
+        LocalVector<Piece *> pieces;
+        LocalVector<Piece *> children;
+        pieces.push_back(root);
+
+        // The first few levels of the tree are cut a level at a time, each handed out to the
+        // pool as a whole, until there are a few pieces for every thread. From there every
+        // piece's subtree is a task of its own, so a thread done with a small one just takes
+        // the next rather than the level below waiting on the biggest piece of this one.
+        // Subtrees are handed out as threads free up, which balances them well enough
+        // without stealing work from the middle of one
+        const int SUBTREES_PER_THREAD = 4;
+        uint32_t plane_idx = 0;
+        if (parallel) {
+            uint32_t subtree_count = SUBTREES_PER_THREAD * OS::get_singleton()->get_processor_count();
+
+            for (; plane_idx < planes.size() && pieces.size() < subtree_count; plane_idx++) {
+                children.resize(pieces.size() * 2);
+
+                LevelSplitter splitter = { pieces, children, planes[plane_idx], cap_material, specialized };
+                Parallel::for_each(pieces.size(), splitter, "Slicer fracture");
+
+                pieces.clear();
+                for (uint32_t i = 0; i < children.size(); i++) {
+                    if (children[i]) {
+                        pieces.push_back(children[i]);
+                    }
+                }
+            }
+        }
+
+        LocalVector<LocalVector<Piece *>> cells;
+        cells.resize(pieces.size());
+
+        SubtreeSplitter splitter = { pieces, cells, planes, plane_idx, cap_material, specialized };
+        if (parallel) {
+            Parallel::for_each(pieces.size(), splitter, "Slicer fracture");
+        } else {
+            for (uint32_t i = 0; i < pieces.size(); i++) {
+                splitter(i);
+            }
+        }
+
+        r_cells.clear();
+        for (uint32_t i = 0; i < cells.size(); i++) {
+            for (uint32_t j = 0; j < cells[i].size(); j++) {
+                r_cells.push_back(cells[i][j]);
+            }
+        }
+    }
+
+    void scatter_seeds(const Piece &root, int count, uint64_t rng_seed, LocalVector<Vector3> &r_seeds) {
+        r_seeds.clear();
+
+        // Running total of face areas, so faces can be picked with a binary search
+        // proportionally to how big they are
+        LocalVector<const MeshBuffer *> face_surfaces;
+        LocalVector<int> face_indices;
+        LocalVector<real_t> cumulative_area;
+        real_t total_area = 0;
+        Vector3 center;
+        int vertex_count = 0;
+
+        for (uint32_t i = 0; i < root.surfaces.size(); i++) {
+            const MeshBuffer &surface = root.surfaces[i].surface;
+
+            for (int j = 0; j < surface.face_count(); j++) {
+                Vector3 a = surface.vertices[surface.indices[j * 3]];
+                Vector3 b = surface.vertices[surface.indices[j * 3 + 1]];
+                Vector3 c = surface.vertices[surface.indices[j * 3 + 2]];
+
+                total_area += (b - a).cross(c - a).length() * 0.5f;
+                face_surfaces.push_back(&surface);
+                face_indices.push_back(j);
+                cumulative_area.push_back(total_area);
+            }
+
+            for (int j = 0; j < surface.vertex_count(); j++) {
+                center += surface.vertices[j];
+            }
+            vertex_count += surface.vertex_count();
+        }
+
+        if (face_indices.size() == 0 || total_area <= 0) {
+            return;
+        }
+        center /= vertex_count;
+
+        FastRandom rng(rng_seed);
+        for (int i = 0; i < count; i++) {
+            real_t target = rng.randf() * total_area;
+
+            int low = 0;
+            int high = cumulative_area.size() - 1;
+            while (low < high) {
+                int mid = (low + high) / 2;
+                if (cumulative_area[mid] < target) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+
+            const MeshBuffer &surface = *face_surfaces[low];
+            int face = face_indices[low];
+
+            // Uniform point on the triangle, folding the ones that land outside back in
+            real_t u = rng.randf();
+            real_t v = rng.randf();
+            if (u + v > 1) {
+                u = 1 - u;
+                v = 1 - v;
+            }
+
+            Vector3 a = surface.vertices[surface.indices[face * 3]];
+            Vector3 b = surface.vertices[surface.indices[face * 3 + 1]];
+            Vector3 c = surface.vertices[surface.indices[face * 3 + 2]];
+            Vector3 on_surface = a + (b - a) * u + (c - a) * v;
+
+            r_seeds.push_back(center.lerp(on_surface, rng.randf()));
+        }
+    }
+
+    /**
+     * Keeps whatever is below the plane of the piece, capping the cut. Takes ownership
+     * of the piece and returns what's left of it, which can be null
+    */
+    Piece *clip_piece(Piece *piece, const Plane &plane, const Ref<Material> cap_material, bool specialized, Workspace &workspace) {
+        bool has_upper = cut(*piece, plane, specialized, workspace);
+
+        if (!has_cut(workspace)) {
+            if (has_upper) {
+                memdelete(piece);
+                return nullptr;
+            }
+
+            forget_cut(*piece);
+            return piece;
+        }
+
+        build_cap(plane, workspace);
+
+        // Only the side below the plane is kept, so rather than copying it out into a new
+        // piece every surface is cut down to it where it is. Surfaces left without any
+        // faces stay on as empty ones
+        bool is_empty = true;
+        for (uint32_t i = 0; i < piece->surfaces.size(); i++) {
+            Intersector::SplitResult &split = piece->surfaces[i];
+            split.surface.compact(split.lower_indices, &workspace.remap);
+            is_empty = is_empty && split.surface.face_count() == 0;
+        }
+        forget_cut(*piece);
+
+        if (is_empty) {
+            memdelete(piece);
+            return nullptr;
+        }
+
+        add_cap(*piece, workspace.cap, cap_material, false);
+        return piece;
+    }
+
+    _FORCE_INLINE_ real_t farthest_distance_squared(const Piece &piece, Vector3 from) {
+        real_t farthest = 0;
+
+        for (uint32_t i = 0; i < piece.surfaces.size(); i++) {
+            const MeshBuffer &surface = piece.surfaces[i].surface;
+            for (int j = 0; j < surface.vertex_count(); j++) {
+                farthest = MAX(farthest, from.distance_squared_to(surface.vertices[j]));
+            }
+        }
+
+        return farthest;
+    }
+
+    struct SeedDistance {
+        real_t distance_squared;
+        int seed;
+
+        bool operator<(const SeedDistance &other) const {
+            return distance_squared < other.distance_squared;
+        }
+    };
+
+    /**
+     * Run once per worker. Each one keeps taking the next seed that nobody has started on yet
+     * and clips a copy of root to its cell, see fracture_voronoi, with the same workspace
+     * for every cell it takes
+    */
+    struct VoronoiCellClipper {
+        const Piece &root;
+        const LocalVector<Vector3> &seeds;
+        // The seeds that get a cell, the first of any on top of each other
+        const LocalVector<int> &unique_seeds;
+        LocalVector<Piece *> &cells;
+        Ref<Material> cap_material;
+        bool specialized;
+        std::atomic<uint32_t> next_seed;
+
+        void operator()(uint32_t worker_idx) {
+            Workspace workspace;
+            LocalVector<SeedDistance> others;
+
+            for (uint32_t i = next_seed++; i < unique_seeds.size(); i = next_seed++) {
+                clip_cell(unique_seeds[i], workspace, others);
+            }
+        }
+
+        void clip_cell(int idx, Workspace &workspace, LocalVector<SeedDistance> &others) {
+            TRACE_ZONE("voronoi cell");
+            Vector3 seed = seeds[idx];
+
+            // The cell is bounded by the planes halfway between its seed and each of the others.
+            // Going through the other seeds from nearest to farthest, the only ones whose plane
+            // can still cut the piece are the ones within twice the distance of the piece's farthest
+            // vertex from the seed. Once we're past that none of the rest can either, so in practice
+            // only the cell's actual neighbors ever get tested, without building a Delaunay
+            // triangulation to find them
+            others.clear();
+            for (uint32_t i = 0; i < unique_seeds.size(); i++) {
+                int other = unique_seeds[i];
+                if (other != idx) {
+                    SeedDistance distance = { seed.distance_squared_to(seeds[other]), other };
+                    others.push_back(distance);
+                }
+            }
+            others.sort();
+
+            Piece *piece = memnew(Piece(root));
+            real_t reach_squared = 4 * farthest_distance_squared(*piece, seed);
+
+            for (uint32_t i = 0; i < others.size() && piece; i++) {
+                if (others[i].distance_squared > reach_squared) {
+                    break;
+                }
+
+                // Points above the plane are closer to the other seed
+                Vector3 other = seeds[others[i].seed];
+                Vector3 normal = (other - seed).normalized();
+                Plane bisector(normal, normal.dot((seed + other) * 0.5f));
+
+                piece = clip_piece(piece, bisector, cap_material, specialized, workspace);
+                if (piece) {
+                    reach_squared = 4 * farthest_distance_squared(*piece, seed);
+                }
+            }
+
+            cells[idx] = piece;
+        }
+    };
+
+    void fracture_voronoi(const Piece &root, const LocalVector<Vector3> &seeds, const Ref<Material> cap_material, bool specialized, bool parallel, LocalVector<Piece *> &r_cells) {
+        r_cells.resize(seeds.size());
+
+        // Seeds on top of each other would each get the same cell, so only the first of them does
+        LocalVector<int> unique_seeds;
+        for (uint32_t i = 0; i < seeds.size(); i++) {
+            r_cells[i] = nullptr;
+
+            bool is_duplicate = false;
+            for (uint32_t j = 0; j < unique_seeds.size() && !is_duplicate; j++) {
+                is_duplicate = seeds[i].distance_squared_to(seeds[unique_seeds[j]]) <= CMP_EPSILON;
+            }
+
+            if (!is_duplicate) {
+                unique_seeds.push_back(i);
+            }
+        }
+
+        VoronoiCellClipper clipper = { root, seeds, unique_seeds, r_cells, cap_material, specialized };
+        clipper.next_seed = 0;
+
+        int worker_count = parallel ? MIN((int)unique_seeds.size(), OS::get_singleton()->get_processor_count()) : 1;
+        Parallel::for_each(worker_count, clipper, "Slicer fracture_voronoi");
+    }
+} // Fracture
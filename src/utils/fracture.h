@@ -0,0 +1,65 @@
+#ifndef FRACTURE_H
+#define FRACTURE_H
+
+#include "intersector.h"
+#include "triangulator.h"
+
+/**
+ * Recursively cuts a mesh by a series of planes, BSP style. Every piece left over
+ * from one plane is cut again by the next, so n planes in general position leave
+ * up to 2^n convex cells
+*/
+namespace Fracture {
+    /**
+     * One piece of the mesh being fractured. Holds a surface per surface of the original
+     * mesh plus one for the caps the cuts have added to it, each with their own material
+    */
+    struct Piece {
+        LocalVector<Intersector::SplitResult> surfaces;
+    };
+
+    /**
+     * Scratch memory for cutting pieces. Every task keeps its own for all the cuts it makes,
+     * so it's only allocated again when a cut needs more of it than any before
+    */
+    struct Workspace {
+        LocalVector<Vector3> intersection_points;
+        LocalVector<Vector3> segments;
+        Triangulator::Workspace triangulator;
+        MeshBuffer cap;
+        LocalVector<int> remap;
+    };
+
+    /**
+     * Cuts piece by the plane into the parts above and below it, which get capped along the
+     * cut with cap_material (or the piece's first material if it's null). If the plane doesn't
+     * cross the piece then piece itself is handed back as r_upper or r_lower, whichever side it's
+     * on, and false is returned. Otherwise the caller owns both new pieces, either of which can
+     * be null if it ended up empty
+    */
+    bool split_piece(Piece &piece, const Plane &plane, const Ref<Material> cap_material, bool specialized, Workspace &workspace, Piece *&r_upper, Piece *&r_lower);
+
+    /**
+     * Cuts root by every plane in turn, returning every resulting cell in r_cells in a stable
+     * order. The caller owns the cells, root is consumed. With parallel set, the pieces left
+     * after the first few planes are each cut by the rest of them as tasks on the WorkerThreadPool
+    */
+    void fracture(Piece *root, const LocalVector<Plane> &planes, const Ref<Material> cap_material, bool specialized, bool parallel, LocalVector<Piece *> &r_cells);
+
+    /**
+     * Picks count seed points for fracture_voronoi spread through the volume of root. Points
+     * are sampled uniformly over its faces and pulled a random amount towards its center,
+     * the same rng_seed always giving the same points
+    */
+    void scatter_seeds(const Piece &root, int count, uint64_t rng_seed, LocalVector<Vector3> &r_seeds);
+
+    /**
+     * Clips a copy of root to the Voronoi cell of every seed, capping each cut with cap_material.
+     * r_cells gets a piece per seed, in the same order, which is null if the cell missed root
+     * entirely or the seed is on top of an earlier one. The caller owns the cells, root is left
+     * as is. With parallel set, cells are clipped at the same time on the WorkerThreadPool
+    */
+    void fracture_voronoi(const Piece &root, const LocalVector<Vector3> &seeds, const Ref<Material> cap_material, bool specialized, bool parallel, LocalVector<Piece *> &r_cells);
+} // Fracture
+
+#endif // FRACTURE_H
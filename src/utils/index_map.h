@@ -0,0 +1,172 @@
+#ifndef INDEX_MAP_H
+#define INDEX_MAP_H
+
+#include "core_types.h"
+
+/**
+ * A map of 64 bit keys to ints, for the lookups the core makes over and over every slice
+ * (edges to the vertexes made on them, points of the cut to their ids). HashMap allocates
+ * every element on its own, so it allocates again every slice however much it held before.
+ * This keeps its entries and an open addressed table of them in two flat arrays that clear()
+ * holds onto, so once it has grown to fit a slice the next ones don't allocate at all.
+ *
+ * Iterates in insertion order, skipping erased entries, the same as HashMap does
+*/
+class IndexMap {
+public:
+    struct Entry {
+        uint64_t key;
+        int value;
+        bool erased;
+    };
+
+    class ConstIterator {
+        const Entry *entry;
+        const Entry *end;
+
+        _FORCE_INLINE_ void skip_erased() {
+            while (entry != end && entry->erased) {
+                entry++;
+            }
+        }
+
+    public:
+        ConstIterator(const Entry *p_entry, const Entry *p_end) :
+                entry(p_entry), end(p_end) {
+            skip_erased();
+        }
+
+        _FORCE_INLINE_ const Entry &operator*() const { return *entry; }
+        _FORCE_INLINE_ bool operator!=(const ConstIterator &other) const { return entry != other.entry; }
+
+        _FORCE_INLINE_ ConstIterator &operator++() {
+            entry++;
+            skip_erased();
+            return *this;
+        }
+    };
+
+private:
+    friend class MemoryTracker;
+
+    static const int EMPTY_SLOT = -1;
+
+    // Every entry in the order it was inserted, erased ones included until the next clear()
+    LocalVector<Entry> entries;
+
+    // Indices into entries, a power of two of them, EMPTY_SLOT where there's none
+    LocalVector<int> slots;
+
+    uint32_t live_count = 0;
+
+    _FORCE_INLINE_ static uint32_t hash(uint64_t key) {
+        // The finalizer of MurmurHash3, since keys are often packed pairs of small ints
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return (uint32_t)key;
+    }
+
+    /**
+     * The slot holding the key, or if it isn't in the map the empty slot it would go in.
+     * There has to be at least one slot
+    */
+    _FORCE_INLINE_ uint32_t find_slot(uint64_t key) const {
+        uint32_t mask = slots.size() - 1;
+        uint32_t slot = hash(key) & mask;
+        while (true) {
+            int entry = slots[slot];
+            if (entry == EMPTY_SLOT || (entries[entry].key == key && !entries[entry].erased)) {
+                return slot;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    void grow() {
+        uint32_t capacity = MAX(slots.size() * 2, 16u);
+        slots.resize(capacity);
+        for (uint32_t i = 0; i < capacity; i++) {
+            slots[i] = EMPTY_SLOT;
+        }
+
+        // Erased entries don't need a slot anymore
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            if (!entries[i].erased) {
+                slots[find_slot(entries[i].key)] = i;
+            }
+        }
+    }
+
+public:
+    _FORCE_INLINE_ uint32_t size() const { return live_count; }
+
+    _FORCE_INLINE_ int *getptr(uint64_t key) {
+        if (live_count == 0) {
+            return nullptr;
+        }
+        int entry = slots[find_slot(key)];
+        return entry == EMPTY_SLOT ? nullptr : &entries[entry].value;
+    }
+
+    _FORCE_INLINE_ const int *getptr(uint64_t key) const {
+        return const_cast<IndexMap *>(this)->getptr(key);
+    }
+
+    _FORCE_INLINE_ bool has(uint64_t key) const {
+        return getptr(key) != nullptr;
+    }
+
+    void insert(uint64_t key, int value) {
+        int *existing = getptr(key);
+        if (existing) {
+            *existing = value;
+            return;
+        }
+
+        // Erased entries keep their slots until the table grows, so they count towards its load
+        if ((entries.size() + 1) * 2 > slots.size()) {
+            grow();
+        }
+
+        slots[find_slot(key)] = entries.size();
+        entries.push_back({ key, value, false });
+        live_count++;
+    }
+
+    void erase(uint64_t key) {
+        int *existing = getptr(key);
+        if (existing) {
+            // Left in its slot so whatever got probed past it can still be found
+            entries[slots[find_slot(key)]].erased = true;
+            live_count--;
+        }
+    }
+
+    /**
+     * Empties the map, keeping its memory for whatever gets inserted next
+    */
+    void clear() {
+        if (entries.size() == 0) {
+            return;
+        }
+
+        entries.clear();
+        for (uint32_t i = 0; i < slots.size(); i++) {
+            slots[i] = EMPTY_SLOT;
+        }
+        live_count = 0;
+    }
+
+    ConstIterator begin() const {
+        return ConstIterator(entries.ptr(), entries.ptr() + entries.size());
+    }
+
+    ConstIterator end() const {
+        return ConstIterator(entries.ptr() + entries.size(), entries.ptr() + entries.size());
+    }
+};
+
+#endif // INDEX_MAP_H
@@ -1,4 +1,18 @@
 #include "intersector.h"
+#include "parallel.h"
+#include "trace.h"
+
+#include <cstring>
+
+#ifndef REAL_T_IS_DOUBLE
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SLICER_CLASSIFY_SSE
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SLICER_CLASSIFY_NEON
+#include <arm_neon.h>
+#endif
+#endif
 
 namespace Intersector {
     /**
@@ -7,40 +21,44 @@ namespace Intersector {
      * much as possible to try to reduce long series of conditionals with largely similar
      * blocks for code and hopefully make the actual process that's happening a bit easier
      * to grok.
+     *
+     * points_above/below/on hold corner slots (0, 1 or 2) of the face rather than the
+     * points themselves, which lets us walk around the face without comparing positions
     */
     struct FaceIntersectInfo {
+        int vertex[3];
+        Vector3 point[3];
+        real_t distance[3];
         SideOfPlane sides[3];
 
         int num_of_points_above;
-        Vector3 points_above[3];
+        int points_above[3];
 
         int num_of_points_below;
-        Vector3 points_below[3];
+        int points_below[3];
 
         int num_of_points_on;
-        Vector3 points_on[3];
+        int points_on[3];
 
-        FaceIntersectInfo(const Plane &plane, const SlicerFace &face) {
+        FaceIntersectInfo(const SplitResult &result, int face_idx) {
             num_of_points_above = 0;
             num_of_points_below = 0;
             num_of_points_on = 0;
 
-            SideOfPlane sides_of[3] = {
-                get_side_of(plane, face.vertex[0]),
-                get_side_of(plane, face.vertex[1]),
-                get_side_of(plane, face.vertex[2])
-            };
-
             for (int i = 0; i < 3; i++) {
-                SideOfPlane side = sides_of[i];
+                vertex[i] = result.surface.indices[face_idx * 3 + i];
+                point[i] = result.surface.vertices[vertex[i]];
+                distance[i] = result.distances[vertex[i]];
+
+                SideOfPlane side = (SideOfPlane)result.sides[vertex[i]];
                 sides[i] = side;
 
                 if (side == SideOfPlane::OVER)
-                    points_above[num_of_points_above++] = face.vertex[i];
+                    points_above[num_of_points_above++] = i;
                 else if (side == SideOfPlane::UNDER)
-                    points_below[num_of_points_below++] = face.vertex[i];
+                    points_below[num_of_points_below++] = i;
                 else
-                    points_on[num_of_points_on++] = face.vertex[i];
+                    points_on[num_of_points_on++] = i;
             }
         }
     };
@@ -65,65 +83,232 @@ namespace Intersector {
         return SideOfPlane::ON;
     }
 
-    bool line_intersects(const Plane &plane, const Vector3 a, const Vector3 b, Vector3 &out) {
-        Vector3 ab = b - a;
-        real_t t = (plane.d - plane.normal.dot(a)) / (plane.normal.dot(ab));
+    SideOfPlane get_side_of(const Plane &plane, const AABB &box) {
+        // How far the box reaches towards the plane's normal, either way, from its center
+        Vector3 half_size = box.size * 0.5;
+        real_t radius = Math::abs(plane.normal.x) * half_size.x + Math::abs(plane.normal.y) * half_size.y + Math::abs(plane.normal.z) * half_size.z;
+        real_t dist = plane.distance_to(box.position + half_size);
 
-        if (t >= CMP_EPSILON && t <= (1 + CMP_EPSILON)) {
-            Vector3 intersect_point = a + t * ab;
-            out.x = intersect_point.x;
-            out.y = intersect_point.y;
-            out.z = intersect_point.z;
+        if (dist - radius > CMP_EPSILON) {
+            return SideOfPlane::OVER;
+        }
 
-            return true;
+        if (dist + radius < -CMP_EPSILON) {
+            return SideOfPlane::UNDER;
+        }
+
+        return SideOfPlane::ON;
+    }
+
+    _FORCE_INLINE_ uint8_t side_code(bool over, bool under) {
+        return over ? SideOfPlane::OVER : (under ? SideOfPlane::UNDER : SideOfPlane::ON);
+    }
+
+    void classify_points(const Plane &plane, const Vector3 *points, int count, real_t *r_distances, uint8_t *r_sides) {
+        int i = 0;
+
+#if defined(SLICER_CLASSIFY_SSE) || defined(SLICER_CLASSIFY_NEON)
+        // The SIMD paths read the points as a flat array of floats
+        static_assert(sizeof(Vector3) == sizeof(float) * 3, "Vector3 is expected to be three packed floats");
+        const float *coords = reinterpret_cast<const float *>(points);
+#endif
+
+#if defined(SLICER_CLASSIFY_SSE)
+        const __m128 nx = _mm_set1_ps(plane.normal.x);
+        const __m128 ny = _mm_set1_ps(plane.normal.y);
+        const __m128 nz = _mm_set1_ps(plane.normal.z);
+        const __m128 d = _mm_set1_ps(plane.d);
+        const __m128 over_epsilon = _mm_set1_ps(CMP_EPSILON);
+        const __m128 under_epsilon = _mm_set1_ps(-CMP_EPSILON);
+
+        for (; i + 4 <= count; i += 4) {
+            // Four points are twelve floats: x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3.
+            // Shuffle them around into one register per axis
+            const float *p = coords + i * 3;
+            __m128 a = _mm_loadu_ps(p);
+            __m128 b = _mm_loadu_ps(p + 4);
+            __m128 c = _mm_loadu_ps(p + 8);
+
+            __m128 b2b3c0c1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 3, 2));
+            __m128 a1a2b0b1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+            __m128 b3b3c2c3 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(3, 2, 3, 3));
+
+            __m128 x = _mm_shuffle_ps(a, b2b3c0c1, _MM_SHUFFLE(3, 0, 3, 0));
+            __m128 y = _mm_shuffle_ps(a1a2b0b1, b3b3c2c3, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 z = _mm_shuffle_ps(a1a2b0b1, c, _MM_SHUFFLE(3, 0, 3, 1));
+
+            // Same order of operations as Plane::distance_to so both agree to the bit
+            __m128 dist = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, nx), _mm_mul_ps(y, ny)), _mm_mul_ps(z, nz)), d);
+            _mm_storeu_ps(r_distances + i, dist);
+
+            int over = _mm_movemask_ps(_mm_cmpgt_ps(dist, over_epsilon));
+            int under = _mm_movemask_ps(_mm_cmplt_ps(dist, under_epsilon));
+            for (int j = 0; j < 4; j++) {
+                r_sides[i + j] = side_code((over >> j) & 1, (under >> j) & 1);
+            }
+        }
+#elif defined(SLICER_CLASSIFY_NEON)
+        const float32x4_t d = vdupq_n_f32(plane.d);
+        const float32x4_t over_epsilon = vdupq_n_f32(CMP_EPSILON);
+        const float32x4_t under_epsilon = vdupq_n_f32(-CMP_EPSILON);
+
+        for (; i + 4 <= count; i += 4) {
+            // vld3 does the deinterleaving into one register per axis for us
+            float32x4x3_t p = vld3q_f32(coords + i * 3);
+
+            float32x4_t dist = vmulq_n_f32(p.val[0], plane.normal.x);
+            dist = vaddq_f32(dist, vmulq_n_f32(p.val[1], plane.normal.y));
+            dist = vaddq_f32(dist, vmulq_n_f32(p.val[2], plane.normal.z));
+            dist = vsubq_f32(dist, d);
+            vst1q_f32(r_distances + i, dist);
+
+            uint32_t over[4];
+            uint32_t under[4];
+            vst1q_u32(over, vcgtq_f32(dist, over_epsilon));
+            vst1q_u32(under, vcltq_f32(dist, under_epsilon));
+            for (int j = 0; j < 4; j++) {
+                r_sides[i + j] = side_code(over[j], under[j]);
+            }
+        }
+#endif
+
+        // Whatever is left over (or everything, without SIMD)
+        for (; i < count; i++) {
+            real_t dist = plane.distance_to(points[i]);
+            r_distances[i] = dist;
+            r_sides[i] = side_code(dist > CMP_EPSILON, dist < -CMP_EPSILON);
         }
-        return false;
     }
 
-    bool points_all_on_same_side(const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
+    void classify_surface(const Plane &plane, SplitResult &result) {
+        int count = result.surface.vertex_count();
+        result.distances.resize(count);
+        result.sides.resize(count);
+
+        classify_points(plane, result.surface.vertices.ptr(), count, result.distances.ptr(), result.sides.ptr());
+    }
+
+    _FORCE_INLINE_ void push_face(LocalVector<int> &indices, int a, int b, int c) {
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(c);
+    }
+
+    _FORCE_INLINE_ LocalVector<int> &indices_on_side(SideOfPlane side, SplitResult &result) {
+        return side == SideOfPlane::OVER ? result.upper_indices : result.lower_indices;
+    }
+
+    /**
+     * Where split_face reads a face from and writes its pieces to. Splitting a whole surface on
+     * one thread reads from and appends to the same SplitResult. Splitting in chunks (see
+     * split_surfaces_by_plane_parallel) gives every chunk its own out, whose surface only holds
+     * the vertexes that chunk generated. Those are numbered starting at vertex_base, past the
+     * end of the source, and get recorded in crossings so they can be put in place, or matched
+     * up with the ones other chunks made for the same edges, once every chunk is done
+    */
+    struct SplitTarget {
+        const SplitResult &source;
+        SplitResult &out;
+        int vertex_base;
+        LocalVector<ChunkCrossing> *crossings = nullptr;
+    };
+
+    /**
+     * Finds where the plane crosses the edge running between corners a and b (which should
+     * be on opposite sides of it) and appends a new vertex there, interpolating every
+     * attribute along the edge. Returns the index of the new vertex, or of the one that was
+     * already made for the same edge by the face on its other side
+    */
+    template <uint32_t FORMAT>
+    int intersect_edge(const FaceIntersectInfo &info, int a, int b, SplitTarget &target) {
+        // Always going from the lower vertex index to the higher one means both faces
+        // along the edge would come up with the exact same crossing anyway
+        if (info.vertex[a] > info.vertex[b]) {
+            SWAP(a, b);
+        }
+
+        uint64_t key = ((uint64_t)info.vertex[a] << 32) | (uint32_t)info.vertex[b];
+        const int *existing = target.out.edge_vertices.getptr(key);
+        if (existing) {
+            return *existing;
+        }
+
+        // We already know how far each end is from the plane, which is all we
+        // need to know how far along the edge the crossing is
+        real_t t = info.distance[a] / (info.distance[a] - info.distance[b]);
+
+        int idx = target.out.surface.add_lerped_vertex<FORMAT>(target.source.surface, info.vertex[a], info.vertex[b], t);
+        target.out.intersection_points.push_back(target.out.surface.vertices[idx]);
+
+        if (target.crossings) {
+            ChunkCrossing crossing = { key, (int)target.out.intersection_points.size() - 1, 0, false };
+            target.crossings->push_back(crossing);
+        }
+
+        target.out.edge_vertices.insert(key, target.vertex_base + idx);
+        return target.vertex_base + idx;
+    }
+
+    /**
+     * Where a vertex returned by intersect_edge is
+    */
+    _FORCE_INLINE_ const Vector3 &target_vertex(int idx, const SplitTarget &target) {
+        return target.out.surface.vertices[idx - target.vertex_base];
+    }
+
+    _FORCE_INLINE_ void push_segment(Vector3 a, Vector3 b, SplitTarget &target) {
+        target.out.cut_segments.push_back(a);
+        target.out.cut_segments.push_back(b);
+    }
+
+    bool points_all_on_same_side(const FaceIntersectInfo &info, SplitTarget &target) {
         // This is actually a bit of a divergence from Ezy-Slice, where instead they just return and then handle
         // this case in a different loop. With the way we have things setup though I think we can just handle them
         // while we're here with all of already deduced info
         if (info.num_of_points_above == 3) {
-            result.upper_faces.push_back(face);
+            push_face(target.out.upper_indices, info.vertex[0], info.vertex[1], info.vertex[2]);
             return true;
         } else if (info.num_of_points_below == 3) {
-            result.lower_faces.push_back(face);
+            push_face(target.out.lower_indices, info.vertex[0], info.vertex[1], info.vertex[2]);
             return true;
         } else if (info.num_of_points_on == 3) {
-            result.intersection_points.push_back(face.vertex[0]);
-            result.intersection_points.push_back(face.vertex[1]);
-            result.intersection_points.push_back(face.vertex[2]);
+            target.out.intersection_points.push_back(info.point[0]);
+            target.out.intersection_points.push_back(info.point[1]);
+            target.out.intersection_points.push_back(info.point[2]);
             return true;
         }
 
         return false;
     }
 
-    bool one_side_is_parallel(const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
+    bool one_side_is_parallel(const FaceIntersectInfo &info, SplitTarget &target) {
         // if two points are actually lying *on* the plane then we know there won't be any real intersection,
         // we can just reuse the facd as is after determining if the remaining point is above or below the plane
         if (info.num_of_points_on == 2) {
-            if (info.num_of_points_above == 1) {
-                result.upper_faces.push_back(face);
-            } else {
-                result.lower_faces.push_back(face);
+            // The edge lying on the plane is part of the cut's outline, as long as the face on its other
+            // side doesn't lie below the plane too. Only counting it from the face below keeps it from being
+            // added twice when the face on the other side lies above
+            if (info.num_of_points_below == 1) {
+                push_segment(info.point[info.points_on[0]], info.point[info.points_on[1]], target);
             }
+
+            LocalVector<int> &indices = info.num_of_points_above == 1 ? target.out.upper_indices : target.out.lower_indices;
+            push_face(indices, info.vertex[0], info.vertex[1], info.vertex[2]);
             return true;
         }
 
         return false;
     }
 
-    bool pointed_away(const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
+    bool pointed_away(const FaceIntersectInfo &info, SplitTarget &target) {
         // Similar to one_side_is_parallel except in this case only one point is on the plane
         // and the other 2 are on the same side
         if (info.num_of_points_on == 1) {
             if (info.num_of_points_above == 2) {
-                result.upper_faces.push_back(face);
+                push_face(target.out.upper_indices, info.vertex[0], info.vertex[1], info.vertex[2]);
                 return true;
             } else if (info.num_of_points_below == 2) {
-                result.lower_faces.push_back(face);
+                push_face(target.out.lower_indices, info.vertex[0], info.vertex[1], info.vertex[2]);
                 return true;
             }
         }
@@ -131,48 +316,26 @@ namespace Intersector {
         return false;
     }
 
-    bool face_split_in_half(const Plane &plane, const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
+    template <uint32_t FORMAT>
+    bool face_split_in_half(const FaceIntersectInfo &info, SplitTarget &target) {
         // If one point is lying on the plane and the other 2 points are on either side all we really need to do is split
         // the triangle in half (or, more accurately, in two)
         if (info.num_of_points_on == 1) {
-            Vector3 on = info.points_on[0];
-
             // We know that there is one on either side or else it would have been caught in `pointed_away`
             ERR_FAIL_COND_V(info.num_of_points_above != 1 || info.num_of_points_below != 1, false);
-            Vector3 above = info.points_above[0];
-            Vector3 below = info.points_below[0];
 
-            Vector3 a = face.vertex[0];
-            Vector3 b = face.vertex[1];
-            Vector3 c = face.vertex[2];
+            // Walking around the face starting from the point on the plane keeps the winding of
+            // both new faces the same as the original, so they render correctly
+            int on = info.points_on[0];
+            int next = (on + 1) % 3;
+            int prev = (on + 2) % 3;
 
-            Vector3 intersect_point;
-            if (!line_intersects(plane, above, below, intersect_point)) {
-                ERR_FAIL_V(false);
-            }
+            int intersect_idx = intersect_edge<FORMAT>(info, next, prev, target);
+            target.out.intersection_points.push_back(info.point[on]);
+            push_segment(info.point[on], target_vertex(intersect_idx, target), target);
 
-            result.intersection_points.push_back(on);
-            result.intersection_points.push_back(intersect_point);
-
-            SlicerFace upper_face;
-            SlicerFace lower_face;
-
-            // We need to make sure, for any new triangle we're generating, that the points are created clockwise so that
-            // the face renders correctly. Sadly our FaceIntersectInfo helper fails us here and we need to fall back on
-            // tedious conditionals to manually handle this logic. I'd really love a way of reliably generalizing this
-            if (on == a) {
-                upper_face = face.sub_face(a, b, intersect_point);
-                lower_face = face.sub_face(a, intersect_point, c);
-            } else if (on == b) {
-                upper_face = face.sub_face(b, c, intersect_point);
-                lower_face = face.sub_face(b, intersect_point, a);
-            } else {
-                upper_face = face.sub_face(c, a, intersect_point);
-                lower_face = face.sub_face(c, intersect_point, b);
-            }
-
-            result.upper_faces.push_back(upper_face);
-            result.lower_faces.push_back(lower_face);
+            push_face(indices_on_side(info.sides[next], target.out), info.vertex[on], info.vertex[next], intersect_idx);
+            push_face(indices_on_side(info.sides[prev], target.out), info.vertex[on], intersect_idx, info.vertex[prev]);
 
             return true;
         }
@@ -180,7 +343,8 @@ namespace Intersector {
         return false;
     }
 
-    void full_split(const Plane &plane, const SlicerFace &face, FaceIntersectInfo &info, SplitResult &result) {
+    template <uint32_t FORMAT>
+    void full_split(const FaceIntersectInfo &info, SplitTarget &target) {
         // at this point, all edge cases have been tested and failed, we need to perform
         // full intersection tests against the lines. From this point onwards we will generate
         // 3 triangles
@@ -188,97 +352,498 @@ namespace Intersector {
         ERR_FAIL_COND(info.num_of_points_above == 0);
         ERR_FAIL_COND(info.num_of_points_below == 0);
 
-        Vector3 a = face.vertex[0];
-        Vector3 b = face.vertex[1];
-        Vector3 c = face.vertex[2];
-
         // If we've gotten to this point then we can be able to confidently say that two points lie on one side
         // and one point lies on the other. We just need to find out which is which;
-        Vector3 on_same_side_1;
-        Vector3 on_same_side_2;
-        Vector3 on_lone_side;
-
+        int lone;
         if (info.num_of_points_above == 2) {
-            on_same_side_1 = info.points_above[0];
-            on_same_side_2 = info.points_above[1];
-            on_lone_side = info.points_below[0];
+            lone = info.points_below[0];
         } else if (info.num_of_points_below == 2) {
-            on_same_side_1 = info.points_below[0];
-            on_same_side_2 = info.points_below[1];
-            on_lone_side = info.points_above[0];
+            lone = info.points_above[0];
         } else {
             ERR_FAIL_MSG("Slicer's full_split method was called with unexpected intersection info");
         }
 
-        Vector3 intersection_point_1;
-        Vector3 intersection_point_2;
-        if (!plane.intersects_segment(on_same_side_1, on_lone_side, &intersection_point_1) ||
-            !plane.intersects_segment(on_same_side_2, on_lone_side, &intersection_point_2)) {
-            ERR_FAIL();
-        }
-
-        SlicerFace lone_tri;
-        SlicerFace same_tri_1;
-        SlicerFace same_tri_2;
-
-        // As mentioned in face_split_in_half, we need to make sure that we add our points
-        // clockwise or else it won't render correctly. I'd love some way of generalizing this
-        // to be less redundent
-        if (on_lone_side == a) {
-            lone_tri = face.sub_face(a, intersection_point_1, intersection_point_2);
-            same_tri_1 = face.sub_face(b, intersection_point_2, intersection_point_1);
-            same_tri_2 = face.sub_face(c, intersection_point_2, b);
-        } else if (on_lone_side == b) {
-            lone_tri = face.sub_face(b, intersection_point_2, intersection_point_1);
-            same_tri_1 = face.sub_face(c, intersection_point_1, intersection_point_2);
-            same_tri_2 = face.sub_face(a, intersection_point_1, c);
-        } else {
-            lone_tri = face.sub_face(c, intersection_point_1, intersection_point_2);
-            same_tri_1 = face.sub_face(a, intersection_point_2, intersection_point_1);
-            same_tri_2 = face.sub_face(b, intersection_point_2, a);
-        }
+        // As in face_split_in_half, walking around the face from the lone point keeps the winding
+        // of the new faces consistent with the original
+        int next = (lone + 1) % 3;
+        int prev = (lone + 2) % 3;
 
-        if (info.num_of_points_above == 2) {
-            result.upper_faces.push_back(same_tri_1);
-            result.upper_faces.push_back(same_tri_2);
-            result.lower_faces.push_back(lone_tri);
-        } else {
-            result.lower_faces.push_back(same_tri_1);
-            result.lower_faces.push_back(same_tri_2);
-            result.upper_faces.push_back(lone_tri);
+        int intersect_next = intersect_edge<FORMAT>(info, next, lone, target);
+        int intersect_prev = intersect_edge<FORMAT>(info, prev, lone, target);
+        push_segment(target_vertex(intersect_next, target), target_vertex(intersect_prev, target), target);
 
-        }
+        push_face(indices_on_side(info.sides[lone], target.out), info.vertex[lone], intersect_next, intersect_prev);
 
-        result.intersection_points.push_back(intersection_point_1);
-        result.intersection_points.push_back(intersection_point_2);
+        LocalVector<int> &same_side = indices_on_side(info.sides[next], target.out);
+        push_face(same_side, info.vertex[next], intersect_prev, intersect_next);
+        push_face(same_side, info.vertex[prev], intersect_prev, info.vertex[next]);
     }
 
     // Face3 has its own split_by_plane but we need to make a few modifications to support
-    // all the data that SlicerFace is responsible for holding. Also Ezy-Slice uses a few clever
+    // all the data that MeshBuffer is responsible for holding. Also Ezy-Slice uses a few clever
     // tricks to handle edge cases
     //
-    // Having result passed in and filled out by reference should hopefully allow us to reuse
+    // Having the target passed in and filled out by reference should hopefully allow us to reuse
     // the same one over a series of faces
-    void split_face_by_plane(const Plane &plane, const SlicerFace &face, SplitResult &result) {
-        FaceIntersectInfo info(plane, face);
+    template <uint32_t FORMAT>
+    _FORCE_INLINE_ void split_face(int face_idx, SplitTarget &target) {
+        FaceIntersectInfo info(target.source, face_idx);
 
-        if (points_all_on_same_side(face, info, result)) {
+        if (points_all_on_same_side(info, target)) {
             return;
         }
 
-        if (one_side_is_parallel(face, info, result)) {
+        if (one_side_is_parallel(info, target)) {
             return;
         }
 
-        if (pointed_away(face, info, result)) {
+        if (pointed_away(info, target)) {
             return;
         }
 
-        if (face_split_in_half(plane, face, info, result)) {
+        if (face_split_in_half<FORMAT>(info, target)) {
             return;
         }
 
         // We've tried all of our clever edge cases, time to do a full intersection test
-        full_split(plane, face, info, result);
+        full_split<FORMAT>(info, target);
+    }
+
+    /**
+     * Splits a range of faces of a surface, see VertexFormat::dispatch
+    */
+    struct SurfaceSplitter {
+        SplitTarget &target;
+        int face_start;
+        int face_end;
+
+        template <uint32_t FORMAT>
+        void run() {
+            for (int i = face_start; i < face_end; i++) {
+                split_face<FORMAT>(i, target);
+            }
+        }
+    };
+
+    void split_face_by_plane(int face_idx, SplitResult &result) {
+        SplitTarget target = { result, result, 0 };
+        split_face<VertexFormat::DYNAMIC>(face_idx, target);
+    }
+
+    void SplitResult::track_memory(MemoryTracker &tracker) const {
+        surface.track_memory(tracker);
+        tracker.add(upper_indices);
+        tracker.add(lower_indices);
+        tracker.add(intersection_points);
+        tracker.add(cut_segments);
+        tracker.add(edge_vertices);
+        tracker.add(distances);
+        tracker.add(sides);
+        tracker.add(bvh_leaves);
+    }
+
+    void split_surface_by_plane(const Plane &plane, SplitResult &result, bool specialized, SliceTimings *r_timings) {
+        TRACE_ZONE_COUNT("split_surface_by_plane", result.surface.face_count());
+        result.edge_vertices.clear();
+
+        if (r_timings) {
+            uint64_t start = SliceTimings::now_usec();
+            classify_surface(plane, result);
+            r_timings->add(SliceTimings::PHASE_CLASSIFY, start);
+        } else {
+            classify_surface(plane, result);
+        }
+
+        SplitTarget target = { result, result, 0 };
+        SurfaceSplitter splitter = { target, 0, result.surface.face_count() };
+        VertexFormat::dispatch(result.surface.format, splitter, specialized);
+    }
+
+    /**
+     * Appends the vertex indices of the faces from start to end, in the BVH's order, to indices
+    */
+    _FORCE_INLINE_ void append_faces(const TriangleBVH &bvh, int start, int end, LocalVector<int> &indices) {
+        int offset = indices.size();
+        indices.resize(offset + (end - start) * 3);
+
+        memcpy(indices.ptr() + offset, bvh.indices.ptr() + start * 3, (end - start) * 3 * sizeof(int));
+    }
+
+    /**
+     * Splits the faces of the BVH leaves the plane passes through, see VertexFormat::dispatch
+    */
+    struct LeafSplitter {
+        const Plane &plane;
+        const TriangleBVH &bvh;
+        SplitResult &result;
+        const LocalVector<int> &leaves;
+
+        template <uint32_t FORMAT>
+        void run() {
+            SplitTarget target = { result, result, 0 };
+            const Vector3 *vertices = result.surface.vertices.ptr();
+
+            for (uint32_t i = 0; i < leaves.size(); i++) {
+                const TriangleBVH::Node &leaf = bvh.nodes[leaves[i]];
+
+                // Only the vertexes of these faces ever get looked at, so they're the only ones
+                // worth classifying. Shared ones just end up getting the same answer twice
+                for (int j = leaf.start * 3; j < leaf.end * 3; j++) {
+                    int idx = bvh.indices[j];
+                    real_t dist = plane.distance_to(vertices[idx]);
+                    result.distances[idx] = dist;
+                    result.sides[idx] = side_code(dist > CMP_EPSILON, dist < -CMP_EPSILON);
+                }
+
+                for (int j = leaf.start; j < leaf.end; j++) {
+                    split_face<FORMAT>(bvh.faces[j], target);
+                }
+            }
+        }
+    };
+
+    void split_surface_by_plane(const Plane &plane, SplitResult &result, const TriangleBVH &bvh, bool specialized) {
+        TRACE_ZONE_COUNT("split_surface_by_plane (BVH)", result.surface.face_count());
+        result.edge_vertices.clear();
+        // Left as they are, apart from the vertexes of the faces that do get split
+        result.distances.resize(result.surface.vertex_count());
+        result.sides.resize(result.surface.vertex_count());
+
+        if (bvh.is_empty()) {
+            return;
+        }
+
+        LocalVector<int> &leaves = result.bvh_leaves;
+        leaves.clear();
+
+        // Nodes always get split down the middle, so the tree can't get anywhere near this deep
+        int stack[64];
+        int stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0) {
+            int node_idx = stack[--stack_size];
+            const TriangleBVH::Node &node = bvh.nodes[node_idx];
+
+            switch (get_side_of(plane, node.bounds)) {
+                case SideOfPlane::OVER:
+                    append_faces(bvh, node.start, node.end, result.upper_indices);
+                    break;
+                case SideOfPlane::UNDER:
+                    append_faces(bvh, node.start, node.end, result.lower_indices);
+                    break;
+                case SideOfPlane::ON:
+                    if (node.children == -1) {
+                        leaves.push_back(node_idx);
+                    } else {
+                        // Right first so the left subtree gets handled first
+                        stack[stack_size++] = node.children + 1;
+                        stack[stack_size++] = node.children;
+                    }
+                    break;
+            }
+        }
+
+        LeafSplitter splitter = { plane, bvh, result, leaves };
+        VertexFormat::dispatch(result.surface.format, splitter, specialized);
+    }
+
+    /**
+     * Breaks every surface up into chunks of at most chunk_size faces (or vertexes, when
+     * by_vertex is set), in order
+    */
+    void make_chunks(const SplitResult *results, int result_count, int chunk_size, bool by_vertex, LocalVector<Chunk> &r_chunks) {
+        r_chunks.clear();
+
+        for (int i = 0; i < result_count; i++) {
+            int count = by_vertex ? results[i].surface.vertex_count() : results[i].surface.face_count();
+            for (int start = 0; start < count; start += chunk_size) {
+                Chunk chunk = { i, start, MIN(start + chunk_size, count) };
+                r_chunks.push_back(chunk);
+            }
+        }
+    }
+
+    struct ParallelClassify {
+        const Plane &plane;
+        SplitResult *results;
+        const LocalVector<Chunk> &chunks;
+
+        void operator()(uint32_t idx) {
+            const Chunk &chunk = chunks[idx];
+            SplitResult &result = results[chunk.surface];
+            TRACE_ZONE_COUNT("classify chunk", chunk.end - chunk.start);
+
+            classify_points(
+                plane,
+                result.surface.vertices.ptr() + chunk.start,
+                chunk.end - chunk.start,
+                result.distances.ptr() + chunk.start,
+                result.sides.ptr() + chunk.start
+            );
+        }
+    };
+
+    struct ParallelSplit {
+        SplitResult *results;
+        const LocalVector<Chunk> &chunks;
+        LocalVector<SplitResult> &chunk_results;
+        LocalVector<LocalVector<ChunkCrossing>> &crossings;
+        bool specialized;
+
+        void operator()(uint32_t idx) {
+            const Chunk &chunk = chunks[idx];
+            const SplitResult &source = results[chunk.surface];
+            TRACE_ZONE_COUNT("split_face_by_plane chunk", chunk.end - chunk.start);
+
+            SplitResult &out = chunk_results[idx];
+            out.reset();
+            out.surface.format = source.surface.format;
+            crossings[idx].clear();
+
+            SplitTarget target = { source, out, source.surface.vertex_count(), &crossings[idx] };
+            SurfaceSplitter splitter = { target, chunk.start, chunk.end };
+            VertexFormat::dispatch(source.surface.format, splitter, specialized);
+        }
+    };
+
+    _FORCE_INLINE_ void copy_remapped_indices(const LocalVector<int> &from, LocalVector<int> &to, int offset, int vertex_base, const LocalVector<ChunkCrossing> &crossings) {
+        for (uint32_t i = 0; i < from.size(); i++) {
+            int idx = from[i];
+            to[offset + i] = idx >= vertex_base ? crossings[idx - vertex_base].vertex : idx;
+        }
+    }
+
+    struct ParallelMerge {
+        SplitResult *results;
+        const LocalVector<Chunk> &chunks;
+        const LocalVector<SplitResult> &chunk_results;
+        const LocalVector<LocalVector<ChunkCrossing>> &crossings;
+        const LocalVector<ChunkOffsets> &offsets;
+        const LocalVector<int> &vertex_bases;
+
+        void operator()(uint32_t idx) {
+            const Chunk &chunk = chunks[idx];
+            const SplitResult &from = chunk_results[idx];
+            const LocalVector<ChunkCrossing> &chunk_crossings = crossings[idx];
+            const ChunkOffsets &offset = offsets[idx];
+            SplitResult &to = results[chunk.surface];
+            TRACE_ZONE_COUNT("merge chunk", chunk.end - chunk.start);
+
+            // The chunk made its vertexes in the same order as the crossings, the shared ones
+            // are already in the merged surface
+            int vertex_base = vertex_bases[chunk.surface];
+            for (uint32_t i = 0; i < chunk_crossings.size(); i++) {
+                if (!chunk_crossings[i].shared) {
+                    to.surface.copy_vertex(from.surface, i, chunk_crossings[i].vertex);
+                }
+            }
+
+            copy_remapped_indices(from.upper_indices, to.upper_indices, offset.upper, vertex_base, chunk_crossings);
+            copy_remapped_indices(from.lower_indices, to.lower_indices, offset.lower, vertex_base, chunk_crossings);
+
+            // A single threaded split wouldn't have added the intersection points of shared
+            // vertexes a second time either
+            uint32_t next_crossing = 0;
+            int point = offset.points;
+            for (uint32_t i = 0; i < from.intersection_points.size(); i++) {
+                if (next_crossing < chunk_crossings.size() && chunk_crossings[next_crossing].point == (int)i) {
+                    if (chunk_crossings[next_crossing++].shared) {
+                        continue;
+                    }
+                }
+
+                to.intersection_points[point++] = from.intersection_points[i];
+            }
+
+            for (uint32_t i = 0; i < from.cut_segments.size(); i++) {
+                to.cut_segments[offset.segments + i] = from.cut_segments[i];
+            }
+        }
+    };
+
+    void ParallelWorkspace::track_memory(MemoryTracker &tracker) const {
+        tracker.add(chunks);
+        tracker.add(offsets);
+        tracker.add(vertex_bases);
+        tracker.add(totals);
+
+        for (uint32_t i = 0; i < chunk_results.size(); i++) {
+            chunk_results[i].track_memory(tracker);
+        }
+
+        for (uint32_t i = 0; i < crossings.size(); i++) {
+            tracker.add(crossings[i]);
+        }
+    }
+
+    /**
+     * Readies the workspace for classifying the vertexes of every result a chunk at a time
+    */
+    void prepare_classify(SplitResult *results, int result_count, ParallelWorkspace &scratch) {
+        // Classifying is cheap enough per vertex that it's only worth handing out in big pieces.
+        // Keeping them a multiple of four keeps every chunk but the last on the SIMD path
+        make_chunks(results, result_count, PARALLEL_CHUNK_SIZE * 4, true, scratch.chunks);
+        for (int i = 0; i < result_count; i++) {
+            results[i].distances.resize(results[i].surface.vertex_count());
+            results[i].sides.resize(results[i].surface.vertex_count());
+            results[i].edge_vertices.clear();
+        }
+    }
+
+    /**
+     * Readies the workspace for splitting every chunk of faces into its own SplitResult
+    */
+    void prepare_split(SplitResult *results, int result_count, ParallelWorkspace &scratch) {
+        make_chunks(results, result_count, PARALLEL_CHUNK_SIZE, false, scratch.chunks);
+        scratch.chunk_results.resize(scratch.chunks.size());
+        scratch.crossings.resize(scratch.chunks.size());
+    }
+
+    /**
+     * Works out where the output of each split chunk lands in its surface's merged streams,
+     * and makes room for all of it. Edges split by two chunks keep the vertex of the first,
+     * which means going through every chunk's crossings one after another, but there are only
+     * ever as many of those as edges the plane crosses
+    */
+    void prepare_merge(SplitResult *results, int result_count, ParallelWorkspace &scratch) {
+        // Chunks are laid out in face order so the merged streams come out the same as if the
+        // faces had been split one after another on a single thread
+        const LocalVector<Chunk> &chunks = scratch.chunks;
+        LocalVector<ChunkOffsets> &offsets = scratch.offsets;
+        offsets.resize(chunks.size());
+
+        LocalVector<int> &vertex_bases = scratch.vertex_bases;
+        vertex_bases.resize(result_count);
+
+        LocalVector<ChunkOffsets> &totals = scratch.totals;
+        totals.resize(result_count);
+        for (int i = 0; i < result_count; i++) {
+            vertex_bases[i] = results[i].surface.vertex_count();
+
+            ChunkOffsets total = { 0, (int)results[i].upper_indices.size(), (int)results[i].lower_indices.size(), (int)results[i].intersection_points.size(), (int)results[i].cut_segments.size() };
+            totals[i] = total;
+        }
+
+        for (uint32_t i = 0; i < chunks.size(); i++) {
+            int surface = chunks[i].surface;
+            ChunkOffsets &total = totals[surface];
+            const SplitResult &chunk_result = scratch.chunk_results[i];
+            offsets[i] = total;
+
+            // The surface's edge_vertices end up the same as a single threaded split leaves them
+            IndexMap &edge_vertices = results[surface].edge_vertices;
+            LocalVector<ChunkCrossing> &crossings = scratch.crossings[i];
+            int kept = 0;
+
+            for (uint32_t j = 0; j < crossings.size(); j++) {
+                ChunkCrossing &crossing = crossings[j];
+                const int *existing = edge_vertices.getptr(crossing.edge);
+                crossing.shared = existing != nullptr;
+
+                if (existing) {
+                    crossing.vertex = *existing;
+                } else {
+                    crossing.vertex = vertex_bases[surface] + total.vertex + kept++;
+                    edge_vertices.insert(crossing.edge, crossing.vertex);
+                }
+            }
+
+            total.vertex += kept;
+            total.upper += chunk_result.upper_indices.size();
+            total.lower += chunk_result.lower_indices.size();
+            total.points += chunk_result.intersection_points.size() - (crossings.size() - kept);
+            total.segments += chunk_result.cut_segments.size();
+        }
+
+        for (int i = 0; i < result_count; i++) {
+            SplitResult &result = results[i];
+            result.surface.resize_vertices(vertex_bases[i] + totals[i].vertex);
+            result.upper_indices.resize(totals[i].upper);
+            result.lower_indices.resize(totals[i].lower);
+            result.intersection_points.resize(totals[i].points);
+            result.cut_segments.resize(totals[i].segments);
+        }
+    }
+
+    void split_surfaces_by_plane_parallel(const Plane &plane, SplitResult *results, int result_count, bool specialized, ParallelWorkspace *workspace, SliceTimings *r_timings) {
+        ParallelWorkspace local_workspace;
+        ParallelWorkspace &scratch = workspace ? *workspace : local_workspace;
+
+        prepare_classify(results, result_count, scratch);
+
+        uint64_t classify_start = r_timings ? SliceTimings::now_usec() : 0;
+        ParallelClassify classify = { plane, results, scratch.chunks };
+        Parallel::for_each(scratch.chunks.size(), classify, "Slicer classify");
+
+        if (r_timings) {
+            r_timings->add(SliceTimings::PHASE_CLASSIFY, classify_start);
+        }
+
+        // Every chunk of faces gets split into its own SplitResult, then we count how much each
+        // one produced to know where it lands in the merged result
+        prepare_split(results, result_count, scratch);
+        ParallelSplit split = { results, scratch.chunks, scratch.chunk_results, scratch.crossings, specialized };
+        Parallel::for_each(scratch.chunks.size(), split, "Slicer split");
+
+        prepare_merge(results, result_count, scratch);
+        ParallelMerge merge = { results, scratch.chunks, scratch.chunk_results, scratch.crossings, scratch.offsets, scratch.vertex_bases };
+        Parallel::for_each(scratch.chunks.size(), merge, "Slicer merge");
+    }
+
+    void SteppedSplit::begin(const Plane &p_plane, SplitResult *p_results, int p_result_count, bool p_specialized, ParallelWorkspace &p_workspace) {
+        plane = p_plane;
+        results = p_results;
+        result_count = p_result_count;
+        specialized = p_specialized;
+        workspace = &p_workspace;
+
+        stage = STAGE_CLASSIFY;
+        next_chunk = 0;
+        prepare_classify(results, result_count, *workspace);
+        skip_finished_stages();
+    }
+
+    void SteppedSplit::skip_finished_stages() {
+        while (stage != STAGE_DONE && next_chunk == workspace->chunks.size()) {
+            next_chunk = 0;
+
+            switch (stage) {
+                case STAGE_CLASSIFY:
+                    prepare_split(results, result_count, *workspace);
+                    stage = STAGE_SPLIT;
+                    break;
+                case STAGE_SPLIT:
+                    prepare_merge(results, result_count, *workspace);
+                    stage = STAGE_MERGE;
+                    break;
+                default:
+                    stage = STAGE_DONE;
+            }
+        }
+    }
+
+    bool SteppedSplit::step() {
+        ERR_FAIL_COND_V(stage == STAGE_DONE, true);
+        ParallelWorkspace &scratch = *workspace;
+
+        switch (stage) {
+            case STAGE_CLASSIFY: {
+                ParallelClassify classify = { plane, results, scratch.chunks };
+                classify(next_chunk);
+            } break;
+            case STAGE_SPLIT: {
+                ParallelSplit split = { results, scratch.chunks, scratch.chunk_results, scratch.crossings, specialized };
+                split(next_chunk);
+            } break;
+            default: {
+                ParallelMerge merge = { results, scratch.chunks, scratch.chunk_results, scratch.crossings, scratch.offsets, scratch.vertex_bases };
+                merge(next_chunk);
+            }
+        }
+
+        next_chunk++;
+        skip_finished_stages();
+        return stage == STAGE_DONE;
     }
 }
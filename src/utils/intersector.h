@@ -1,13 +1,18 @@
 #ifndef INTERSECTOR_H
 #define INTERSECTOR_H
 
-#include "slicer_face.h"
+#include "index_map.h"
+#include "mesh_buffer.h"
+#include "triangle_bvh.h"
+#include "slice_timings.h"
 
+#ifndef SLICER_STANDALONE
 #include <godot_cpp/classes/material.hpp>
+#endif
 
 /**
  * Contains functions related to finding intersection points
- * on SlicerFaces
+ * on the faces of a MeshBuffer
 */
 namespace Intersector {
     // Note that this is slightly different than Face3::Side,
@@ -20,17 +25,57 @@ namespace Intersector {
     };
 
     struct SplitResult {
+#ifndef SLICER_STANDALONE
         Ref<Material> material;
-        Vector<SlicerFace> upper_faces;
-        Vector<SlicerFace> lower_faces;
-        Vector<Vector3> intersection_points;
+#endif
+
+        // The parsed surface being split. Any vertex generated by the split gets
+        // appended to it, so both halves can index into the same streams
+        MeshBuffer surface;
+
+        // Hierarchy over the faces of surface, if it has one. See split_surface_by_plane
+        const TriangleBVH *bvh = nullptr;
+
+        // Three indices into surface for every face on either side of the plane
+        LocalVector<int> upper_indices;
+        LocalVector<int> lower_indices;
+        LocalVector<Vector3> intersection_points;
+
+        // Where the plane cut across each face, two points to a segment. Chained end to end
+        // these make up the outline of the cut, see Triangulator::cap
+        LocalVector<Vector3> cut_segments;
+
+        // The vertex made where the plane crossed each edge, keyed by the edge's vertex indices
+        // (lower one first), so the faces on either side of an edge share the same one
+        IndexMap edge_vertices;
+
+        // Signed distance to the plane, and the SideOfPlane, of every vertex of surface.
+        // See classify_surface
+        LocalVector<real_t> distances;
+        LocalVector<uint8_t> sides;
+
+        // The leaves of bvh the plane passed through, kept here so slicing again doesn't have
+        // to allocate them anew. See split_surface_by_plane
+        LocalVector<int> bvh_leaves;
 
         void reset() {
-            upper_faces.resize(0);
-            lower_faces.resize(0);
-            intersection_points.resize(0);
+            surface.clear();
+            bvh = nullptr;
+            upper_indices.clear();
+            lower_indices.clear();
+            intersection_points.clear();
+            cut_segments.clear();
+            distances.clear();
+            sides.clear();
+            bvh_leaves.clear();
+            edge_vertices.clear();
         }
 
+        /**
+         * Adds the surface and every buffer of the split to the tracker, see MemoryTracker
+        */
+        void track_memory(MemoryTracker &tracker) const;
+
         SplitResult() {}
     };
 
@@ -40,10 +85,151 @@ namespace Intersector {
     SideOfPlane get_side_of(const Plane &plane, Vector3 point);
 
     /**
-     * Performs an intersection on the given face using the passed in plane and stores
-     * the result in the result param.
+     * Which side of the plane the whole box falls on, or ON if the plane passes through it
+    */
+    SideOfPlane get_side_of(const Plane &plane, const AABB &box);
+
+    /**
+     * Batched get_side_of. Writes the signed distance to the plane of each of the count points
+     * to r_distances and the SideOfPlane they fall on to r_sides, four points at a time with
+     * SSE or NEON where available
+    */
+    void classify_points(const Plane &plane, const Vector3 *points, int count, real_t *r_distances, uint8_t *r_sides);
+
+    /**
+     * Classifies every vertex of the result's surface against the plane, filling in its
+     * distances and sides. Shared vertexes only ever get looked at once this way, no matter
+     * how many faces they belong to
     */
-    void split_face_by_plane(const Plane &plane, const SlicerFace &face, SplitResult &result);
+    void classify_surface(const Plane &plane, SplitResult &result);
+
+    /**
+     * Performs an intersection on the face at face_idx of the result's surface and stores the
+     * resulting faces and intersection points in the result param. The plane is the one the
+     * surface was last classified against (see classify_surface), and its edge_vertices need
+     * clearing if it was last split by a different one
+    */
+    void split_face_by_plane(int face_idx, SplitResult &result);
+
+    /**
+     * Classifies the result's surface and performs split_face_by_plane on every one of its
+     * faces, using the kernels specialized for the surface's vertex format (see
+     * VertexFormat::dispatch). If given, the time spent classifying is added to r_timings
+    */
+    void split_surface_by_plane(const Plane &plane, SplitResult &result, bool specialized = true, SliceTimings *r_timings = nullptr);
+
+    /**
+     * Same as above, except only the faces in leaves of the BVH that the plane passes through
+     * get classified and split. Every other subtree lands on its side of the plane in one go,
+     * so the faces come out in the BVH's order rather than the surface's. Leaves get classified
+     * as they're reached, so there's no classifying on its own to time here
+    */
+    void split_surface_by_plane(const Plane &plane, SplitResult &result, const TriangleBVH &bvh, bool specialized = true);
+
+    // How many faces each task of split_surfaces_by_plane_parallel splits
+    const int PARALLEL_CHUNK_SIZE = 2048;
+
+    // A contiguous run of faces, or vertexes, of one of the surfaces being split in parallel
+    struct Chunk {
+        int surface;
+        int start;
+        int end;
+    };
+
+    // A vertex a chunk made where the plane crosses an edge, which an earlier chunk might
+    // have made already for the face on the edge's other side
+    struct ChunkCrossing {
+        // The edge's key in edge_vertices
+        uint64_t edge;
+
+        // The entry of the chunk's intersection_points that went along with the vertex
+        int point;
+
+        // Where the vertex lands in the merged surface, worked out once every chunk is split.
+        // If shared, it's the vertex the earlier chunk made and this one gets dropped
+        int vertex;
+        bool shared;
+    };
+
+    // Where each chunk's output starts in its surface's merged streams
+    struct ChunkOffsets {
+        int vertex;
+        int upper;
+        int lower;
+        int points;
+        int segments;
+    };
+
+    /**
+     * The scratch memory of split_surfaces_by_plane_parallel, which can be kept around
+     * between calls so it doesn't have to be allocated again every time
+    */
+    struct ParallelWorkspace {
+        LocalVector<Chunk> chunks;
+        LocalVector<SplitResult> chunk_results;
+        LocalVector<LocalVector<ChunkCrossing>> crossings;
+        LocalVector<ChunkOffsets> offsets;
+        LocalVector<int> vertex_bases;
+        LocalVector<ChunkOffsets> totals;
+
+        void track_memory(MemoryTracker &tracker) const;
+    };
+
+    /**
+     * Does split_surface_by_plane for every one of the result_count results, using the
+     * WorkerThreadPool. Faces are split in chunks into their own SplitResults and then merged
+     * back in face order. An edge between faces of two different chunks keeps the crossing
+     * vertex of the earlier chunk, so the results are exactly what splitting each surface on a
+     * single thread would give. Works out of workspace if one is passed in, and adds the time
+     * spent classifying to r_timings if given
+    */
+    void split_surfaces_by_plane_parallel(const Plane &plane, SplitResult *results, int result_count, bool specialized = true, ParallelWorkspace *workspace = nullptr, SliceTimings *r_timings = nullptr);
+
+    /**
+     * split_surfaces_by_plane_parallel taken apart into steps that each do a single chunk on
+     * the calling thread, so a big split can be spread across frames (see SliceScheduler).
+     * The results come out the same as the parallel split's. The results and the workspace
+     * need to stay put until the split is done
+    */
+    class SteppedSplit {
+        enum Stage {
+            STAGE_CLASSIFY,
+            STAGE_SPLIT,
+            STAGE_MERGE,
+            STAGE_DONE,
+        };
+
+        Plane plane;
+        SplitResult *results = nullptr;
+        int result_count = 0;
+        bool specialized = true;
+        ParallelWorkspace *workspace = nullptr;
+
+        Stage stage = STAGE_DONE;
+        uint32_t next_chunk = 0;
+
+        /**
+         * Moves on to the next stage, readying the workspace for it, for as long as the
+         * current one has no chunks left
+        */
+        void skip_finished_stages();
+
+    public:
+        void begin(const Plane &p_plane, SplitResult *p_results, int p_result_count, bool p_specialized, ParallelWorkspace &p_workspace);
+
+        /**
+         * Classifies, splits or merges the next chunk. Returns true once the split is done
+        */
+        bool step();
+
+        bool is_classifying() const {
+            return stage == STAGE_CLASSIFY;
+        }
+
+        bool is_done() const {
+            return stage == STAGE_DONE;
+        }
+    };
 } // Intersector
 
 
@@ -0,0 +1,111 @@
+#ifndef MASS_PROPERTIES_H
+#define MASS_PROPERTIES_H
+
+#include "core_types.h"
+
+#include <cmath>
+
+/**
+ * Volume, center of mass and inertia tensor of a closed mesh, of uniform density 1, added up
+ * face by face through the divergence theorem. Each face makes a tetrahedron with a reference
+ * point, and adding up their signed volumes (and moments) leaves just what's inside the mesh. See
+ * "Fast and Accurate Computation of Polyhedral Mass Properties" by Brian Mirtich, though this
+ * goes the simpler way of summing up the tetrahedra's covariance
+*/
+struct MassProperties {
+    real_t volume = 0;
+    Vector3 center_of_mass;
+
+    // About the center of mass, set up by finish
+    Basis inertia;
+
+    // Fraction of the volumes of the tetrahedra, all added up regardless of sign, below which
+    // what's left after they cancel out is taken to be rounding error rather than a volume
+    static constexpr real_t VOLUME_PRECISION = 0.000001;
+
+    // The first corner added. Tetrahedra are made with it rather than the origin so they stay
+    // about as big as the mesh, however far from the origin it is, and don't lose the volume
+    // to rounding errors when they cancel each other out
+    Vector3 reference;
+    bool has_reference = false;
+
+    // Running sums, each tetrahedron weighted by six times its signed volume
+    real_t weight_sum = 0;
+    real_t absolute_weight_sum = 0;
+    Vector3 weighted_corners;
+    real_t covariance[6] = { 0, 0, 0, 0, 0, 0 }; // xx yy zz xy xz yz
+
+    /**
+     * Adds the tetrahedron between the face and the reference point
+    */
+    _FORCE_INLINE_ void add_face(Vector3 a, Vector3 b, Vector3 c) {
+        if (!has_reference) {
+            reference = a;
+            has_reference = true;
+        }
+
+        a -= reference;
+        b -= reference;
+        c -= reference;
+
+        real_t det = a.dot(b.cross(c));
+        Vector3 sum = a + b + c;
+
+        weight_sum += det;
+        absolute_weight_sum += Math::abs(det);
+        weighted_corners += sum * det;
+
+        // The covariance of a tetrahedron with a corner on the origin, times 120 / det,
+        // comes down to the outer products of its other corners plus that of their sum
+        covariance[0] += det * (a.x * a.x + b.x * b.x + c.x * c.x + sum.x * sum.x);
+        covariance[1] += det * (a.y * a.y + b.y * b.y + c.y * c.y + sum.y * sum.y);
+        covariance[2] += det * (a.z * a.z + b.z * b.z + c.z * c.z + sum.z * sum.z);
+        covariance[3] += det * (a.x * a.y + b.x * b.y + c.x * c.y + sum.x * sum.y);
+        covariance[4] += det * (a.x * a.z + b.x * b.z + c.x * c.z + sum.x * sum.z);
+        covariance[5] += det * (a.y * a.z + b.y * b.z + c.y * c.z + sum.y * sum.z);
+    }
+
+    /**
+     * Works out the volume, center of mass and inertia from everything added so far. Meshes
+     * can be wound either way around, so the sign of the volume doesn't matter. Flat or open
+     * meshes, whose volume is no bigger than the rounding error of adding it up, get zeroes
+    */
+    void finish() {
+        real_t sign = weight_sum < 0 ? -1.0f : 1.0f;
+        volume = weight_sum * sign / 6.0f;
+
+        // How big the tetrahedra are, rather than any fixed size, decides what's too small to
+        // be a volume, so small debris keeps its mass
+        if (!std::isfinite(volume) || volume * 6.0f <= absolute_weight_sum * VOLUME_PRECISION) {
+            volume = 0;
+            center_of_mass = Vector3();
+            inertia = Basis(0, 0, 0, 0, 0, 0, 0, 0, 0);
+            return;
+        }
+
+        // Covariance about the reference point, moved over to the center of mass
+        Vector3 com = weighted_corners / (4.0f * weight_sum);
+        center_of_mass = reference + com;
+
+        real_t scale = sign / 120.0f;
+        real_t xx = covariance[0] * scale - volume * com.x * com.x;
+        real_t yy = covariance[1] * scale - volume * com.y * com.y;
+        real_t zz = covariance[2] * scale - volume * com.z * com.z;
+        real_t xy = covariance[3] * scale - volume * com.x * com.y;
+        real_t xz = covariance[4] * scale - volume * com.x * com.z;
+        real_t yz = covariance[5] * scale - volume * com.y * com.z;
+
+        real_t trace = xx + yy + zz;
+        inertia = Basis(
+            trace - xx, -xy, -xz,
+            -xy, trace - yy, -yz,
+            -xz, -yz, trace - zz
+        );
+    }
+
+    void clear() {
+        *this = MassProperties();
+    }
+};
+
+#endif // MASS_PROPERTIES_H
@@ -0,0 +1,139 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include "core_types.h"
+#include "index_map.h"
+
+#ifndef SLICER_STANDALONE
+#include <godot_cpp/variant/variant.hpp>
+#endif
+
+/**
+ * Estimates the memory held by the buffers of a slice. An extension has no way into the
+ * engine's allocator, so rather than counting calls to it a tracker gets walked over every
+ * buffer at the end of each phase (see SliceWorkspace::sample_memory) and adds up the capacity
+ * they hold. Whatever a phase allocates and frees again before it ends goes unseen, and so
+ * does the engine's own memory, short of the arrays added with add_fresh_bytes.
+ *
+ * Cleared buffers keep their memory for the next slice, so each buffer is matched up with the
+ * most it held at any earlier walk, by the order buffers get added in, and only counts as
+ * allocating when it grows past that. Growing a buffer can take a few reallocations where this
+ * sees one. The test program (tests/test_memory.cpp) checks these against what the standalone
+ * core actually allocates
+*/
+class MemoryTracker {
+    // The most each buffer has held, by the order they're added in. Kept by whoever owns the buffers
+    LocalVector<uint64_t> &watermarks;
+    uint32_t next_buffer = 0;
+
+public:
+    // In use by the buffers walked so far
+    uint64_t bytes = 0;
+
+    // Allocated since the last walk over the same watermarks
+    uint64_t bytes_allocated = 0;
+    int allocations = 0;
+
+    explicit MemoryTracker(LocalVector<uint64_t> &p_watermarks) :
+            watermarks(p_watermarks) {}
+
+    /**
+     * The number of elements the buffer has room for. godot-cpp's LocalVector doesn't say,
+     * but it always grows to the next power of two of what it's asked to hold
+    */
+    template <typename T>
+    static uint64_t capacity_of(const LocalVector<T> &buffer) {
+#ifdef SLICER_STANDALONE
+        return buffer.capacity();
+#else
+        uint64_t capacity = buffer.size() > 0 ? 1 : 0;
+        while (capacity < buffer.size()) {
+            capacity <<= 1;
+        }
+        return capacity;
+#endif
+    }
+
+    /**
+     * Adds a buffer with room for size bytes that keeps its memory from one slice to the next.
+     * Since clearing it doesn't give any of that back, it holds the most it's held before
+    */
+    void add_bytes(uint64_t size) {
+        if (next_buffer == watermarks.size()) {
+            watermarks.push_back(0);
+        }
+
+        uint64_t &watermark = watermarks[next_buffer++];
+        if (size > watermark) {
+            bytes_allocated += size - watermark;
+            allocations++;
+            watermark = size;
+        }
+
+        bytes += watermark;
+    }
+
+    /**
+     * Adds memory that gets allocated from scratch every slice, like the arrays handed over
+     * to the engine. Only add these once per slice
+    */
+    void add_fresh_bytes(uint64_t size) {
+        if (size == 0) {
+            return;
+        }
+
+        bytes += size;
+        bytes_allocated += size;
+        allocations++;
+    }
+
+    template <typename T>
+    void add(const LocalVector<T> &buffer) {
+        add_bytes(capacity_of(buffer) * sizeof(T));
+    }
+
+    void add(const IndexMap &map) {
+        add(map.entries);
+        add(map.slots);
+    }
+
+#ifndef SLICER_STANDALONE
+    /**
+     * Bytes held by the packed arrays of a surface's arrays, as made by
+     * Mesh::surface_get_arrays or handed over to add_surface_from_arrays
+    */
+    static uint64_t arrays_bytes(const Array &arrays) {
+        uint64_t total = 0;
+        for (int i = 0; i < arrays.size(); i++) {
+            total += packed_array_bytes(arrays[i]);
+        }
+        return total;
+    }
+
+    /**
+     * Bytes held by a packed array, 0 for anything else
+    */
+    static uint64_t packed_array_bytes(const Variant &value) {
+        switch (value.get_type()) {
+            case Variant::PACKED_BYTE_ARRAY:
+                return PackedByteArray(value).size();
+            case Variant::PACKED_INT32_ARRAY:
+                return PackedInt32Array(value).size() * sizeof(int32_t);
+            case Variant::PACKED_FLOAT32_ARRAY:
+                return PackedFloat32Array(value).size() * sizeof(float);
+            case Variant::PACKED_FLOAT64_ARRAY:
+                return PackedFloat64Array(value).size() * sizeof(double);
+            case Variant::PACKED_VECTOR2_ARRAY:
+                return PackedVector2Array(value).size() * sizeof(Vector2);
+            case Variant::PACKED_VECTOR3_ARRAY:
+                return PackedVector3Array(value).size() * sizeof(Vector3);
+            case Variant::PACKED_COLOR_ARRAY:
+                return PackedColorArray(value).size() * sizeof(Color);
+            default:
+                return 0;
+        }
+    }
+#endif
+};
+
+#endif // MEMORY_TRACKER_H
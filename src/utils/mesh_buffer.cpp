@@ -0,0 +1,317 @@
+#include "mesh_buffer.h"
+#include "trace.h"
+
+#ifndef SLICER_STANDALONE
+#include "face_filler.h"
+#endif
+
+/**
+ * This function is similar to Unity's https://docs.unity3d.com/ScriptReference/Vector3.OrthoNormalize.html
+ * Godot has a Gram-Schmidt implementation in Basis::orthonormalize but it doesn't *exactly* meet our needs.
+ * Instead this is taken and modifired (very very slightly) from:
+ * https://www.gamedev.net/forums/topic/585184-orthonormalize-two-vectors/
+*/
+void ortho_normalize(Vector3 &normal, Vector3 &tangent) {
+    normal.normalize();
+    tangent -= normal * tangent.dot(normal);
+    tangent.normalize();
+}
+
+#ifndef SLICER_STANDALONE
+bool MeshBuffer::parse_surface(const ArrayMesh &mesh, int surface_idx, bool specialized) {
+    clear();
+
+    // Slicer functionality really only makes sense in the context of a mesh composed of
+    // triangles
+    if (mesh.surface_get_primitive_type(surface_idx) != Mesh::PRIMITIVE_TRIANGLES) {
+        return false;
+    }
+
+    return parse_arrays(mesh.surface_get_arrays(surface_idx), mesh.surface_get_format(surface_idx), specialized);
+}
+
+bool MeshBuffer::parse_arrays(const Array &arrays, uint32_t surface_format, bool specialized) {
+    TRACE_ZONE("MeshBuffer::parse_arrays");
+
+    if (!begin_parse(arrays, surface_format)) {
+        return false;
+    }
+
+    parse_vertices(arrays, surface_format, 0, vertex_count(), specialized);
+    parse_indices(arrays, surface_format, 0, indices.size());
+    return true;
+}
+
+bool MeshBuffer::begin_parse(const Array &arrays, uint32_t surface_format) {
+    clear();
+
+    if (arrays.size() != Mesh::ARRAY_MAX) {
+        return false;
+    }
+
+    int index_count;
+    if (surface_format & Mesh::ARRAY_FORMAT_INDEX) {
+        PackedInt32Array surface_indices = arrays[Mesh::ARRAY_INDEX];
+        index_count = surface_indices.size();
+    } else {
+        PackedVector3Array surface_vertices = arrays[Mesh::ARRAY_VERTEX];
+        index_count = surface_vertices.size();
+    }
+
+    if (index_count == 0 || index_count % 3 != 0) {
+        return false;
+    }
+
+    // Works out the streams there are and sizes them
+    FaceFiller filler(*this, arrays, surface_format & ATTRIBUTE_MASK);
+    indices.resize(index_count);
+    return true;
+}
+
+void MeshBuffer::parse_vertices(const Array &arrays, uint32_t surface_format, int first, int count, bool specialized) {
+    ERR_FAIL_COND(first < 0 || first + count > vertex_count());
+
+    FaceFiller filler(*this, arrays, surface_format & ATTRIBUTE_MASK);
+    filler.first = first;
+    filler.end = first + count;
+    VertexFormat::dispatch(format, filler, specialized);
+}
+
+void MeshBuffer::parse_indices(const Array &arrays, uint32_t surface_format, int first, int count) {
+    ERR_FAIL_COND(first < 0 || first + count > (int)indices.size());
+
+    if (surface_format & Mesh::ARRAY_FORMAT_INDEX) {
+        PackedInt32Array surface_indices = arrays[Mesh::ARRAY_INDEX];
+        const int *indices_reader = surface_indices.ptr();
+
+        for (int i = first; i < first + count; i++) {
+            indices[i] = indices_reader[i];
+        }
+    } else {
+        for (int i = first; i < first + count; i++) {
+            indices[i] = i;
+        }
+    }
+}
+#endif
+
+void MeshBuffer::copy_vertices(const MeshBuffer &from, int offset, int from_first, int count) {
+    if (count < 0) {
+        count = from.vertex_count() - from_first;
+    }
+    ERR_FAIL_COND(from_first + count > from.vertex_count() || offset + count > vertex_count());
+
+    for (int i = 0; i < count; i++) {
+        vertices[offset + i] = from.vertices[from_first + i];
+    }
+
+    // Streams are only filled for the attributes in format, see resize_vertices
+    if (has(Mesh::ARRAY_FORMAT_NORMAL)) {
+        for (int i = 0; i < count; i++) {
+            normals[offset + i] = from.normals[from_first + i];
+        }
+    }
+
+    if (has(Mesh::ARRAY_FORMAT_TANGENT)) {
+        for (int i = 0; i < count; i++) {
+            tangents[offset + i] = from.tangents[from_first + i];
+        }
+    }
+
+    if (has(Mesh::ARRAY_FORMAT_COLOR)) {
+        for (int i = 0; i < count; i++) {
+            colors[offset + i] = from.colors[from_first + i];
+        }
+    }
+
+    if (has(Mesh::ARRAY_FORMAT_BONES)) {
+        for (int i = 0; i < count; i++) {
+            bones[offset + i] = from.bones[from_first + i];
+        }
+    }
+
+    if (has(Mesh::ARRAY_FORMAT_WEIGHTS)) {
+        for (int i = 0; i < count; i++) {
+            weights[offset + i] = from.weights[from_first + i];
+        }
+    }
+
+    if (has(Mesh::ARRAY_FORMAT_TEX_UV)) {
+        for (int i = 0; i < count; i++) {
+            uvs[offset + i] = from.uvs[from_first + i];
+        }
+    }
+
+    if (has(Mesh::ARRAY_FORMAT_TEX_UV2)) {
+        for (int i = 0; i < count; i++) {
+            uv2s[offset + i] = from.uv2s[from_first + i];
+        }
+    }
+}
+
+void MeshBuffer::copy_vertex(const MeshBuffer &from, int from_idx, int to_idx) {
+    vertices[to_idx] = from.vertices[from_idx];
+
+    if (has(Mesh::ARRAY_FORMAT_NORMAL))
+        normals[to_idx] = from.normals[from_idx];
+
+    if (has(Mesh::ARRAY_FORMAT_TANGENT))
+        tangents[to_idx] = from.tangents[from_idx];
+
+    if (has(Mesh::ARRAY_FORMAT_COLOR))
+        colors[to_idx] = from.colors[from_idx];
+
+    if (has(Mesh::ARRAY_FORMAT_BONES))
+        bones[to_idx] = from.bones[from_idx];
+
+    if (has(Mesh::ARRAY_FORMAT_WEIGHTS))
+        weights[to_idx] = from.weights[from_idx];
+
+    if (has(Mesh::ARRAY_FORMAT_TEX_UV))
+        uvs[to_idx] = from.uvs[from_idx];
+
+    if (has(Mesh::ARRAY_FORMAT_TEX_UV2))
+        uv2s[to_idx] = from.uv2s[from_idx];
+}
+
+void MeshBuffer::track_memory(MemoryTracker &tracker) const {
+    tracker.add(vertices);
+    tracker.add(normals);
+    tracker.add(tangents);
+    tracker.add(colors);
+    tracker.add(bones);
+    tracker.add(weights);
+    tracker.add(uvs);
+    tracker.add(uv2s);
+    tracker.add(indices);
+}
+
+void MeshBuffer::extract(const MeshBuffer &source, const LocalVector<int> &source_indices, bool flip_winding, LocalVector<int> *r_remap) {
+    clear();
+    append(source, source_indices, flip_winding, r_remap);
+}
+
+void MeshBuffer::append(const MeshBuffer &source, const LocalVector<int> &source_indices, bool flip_winding, LocalVector<int> *r_remap) {
+    if (vertex_count() == 0) {
+        format = source.format;
+    }
+    ERR_FAIL_COND_MSG(format != source.format, "Can't append faces of a surface with different streams");
+
+    // Where each of the source's vertexes ended up in this buffer, if it's been copied yet
+    LocalVector<int> local_remap;
+    LocalVector<int> &remap = r_remap ? *r_remap : local_remap;
+    remap.resize(source.vertex_count());
+    for (int i = 0; i < source.vertex_count(); i++) {
+        remap[i] = -1;
+    }
+
+    int index_count = source_indices.size();
+    int second = flip_winding ? 2 : 1;
+    int third = flip_winding ? 1 : 2;
+    int corners[3] = { 0, second, third };
+
+    int first_index = indices.size();
+    indices.resize(first_index + index_count);
+    for (int i = 0; i < index_count; i += 3) {
+        for (int j = 0; j < 3; j++) {
+            int source_idx = source_indices[i + corners[j]];
+
+            if (remap[source_idx] < 0) {
+                remap[source_idx] = vertex_count();
+                resize_vertices(vertex_count() + 1);
+                copy_vertex(source, source_idx, remap[source_idx]);
+            }
+
+            indices[first_index + i + j] = remap[source_idx];
+        }
+    }
+}
+
+void MeshBuffer::compact(const LocalVector<int> &kept_indices, LocalVector<int> *r_remap) {
+    LocalVector<int> local_remap;
+    LocalVector<int> &remap = r_remap ? *r_remap : local_remap;
+    remap.resize(vertex_count());
+    for (int i = 0; i < vertex_count(); i++) {
+        remap[i] = -1;
+    }
+
+    for (uint32_t i = 0; i < kept_indices.size(); i++) {
+        remap[kept_indices[i]] = 0;
+    }
+
+    // Vertexes only ever move towards the front, so copying them over front to back
+    // never overwrites one that hasn't been moved yet
+    int count = 0;
+    for (int i = 0; i < vertex_count(); i++) {
+        if (remap[i] < 0) {
+            continue;
+        }
+
+        remap[i] = count;
+        if (count != i) {
+            copy_vertex(*this, i, count);
+        }
+        count++;
+    }
+
+    indices.resize(kept_indices.size());
+    for (uint32_t i = 0; i < kept_indices.size(); i++) {
+        indices[i] = remap[kept_indices[i]];
+    }
+
+    resize_vertices(count);
+}
+
+/**
+ * Look I'll be honest with you, I'm a college drop out and not in the genius
+ * romantic Bill Gates/Steve Jobs way. The lazy, take-a-semester-in-undeclared-and-barely-show-up
+ * way. I don't know how to compute tangents, I've never heard of barycentric coordinates before.
+ * So I'll hope you'll forgive me if, in regards to this stuff below, I defer to the *actual* smart people
+ * and just resign myself to transcribing their work and commenting where appropriate without any
+ * personal programattic flourishes.
+*/
+
+/**
+ * This is taken almost line for line from Ezy-Slice, which itself derives it from
+ * https://answers.unity.com/questions/7789/calculating-tangents-vector4.html
+*/
+void MeshBuffer::compute_tangents(int face_idx) {
+    // computing tangents requires both UV and normals set
+    if (!has(Mesh::ARRAY_FORMAT_NORMAL) || !has(Mesh::ARRAY_FORMAT_TEX_UV)) {
+        return;
+    }
+
+    if (!has(Mesh::ARRAY_FORMAT_TANGENT)) {
+        format |= Mesh::ARRAY_FORMAT_TANGENT;
+        tangents.resize(vertex_count());
+    }
+
+    int a = indices[face_idx * 3];
+    int b = indices[face_idx * 3 + 1];
+    int c = indices[face_idx * 3 + 2];
+
+    real_t x1 = vertices[b].x - vertices[a].x;
+    real_t x2 = vertices[c].x - vertices[a].x;
+    real_t y1 = vertices[b].y - vertices[a].y;
+    real_t y2 = vertices[c].y - vertices[a].y;
+    real_t z1 = vertices[b].z - vertices[a].z;
+    real_t z2 = vertices[c].z - vertices[a].z;
+
+    real_t s1 = uvs[b].x - uvs[a].x;
+    real_t s2 = uvs[c].x - uvs[a].x;
+    real_t t1 = uvs[b].y - uvs[a].y;
+    real_t t2 = uvs[c].y - uvs[a].y;
+
+    real_t r = 1.0f / (s1 * t2 - s2 * t1);
+
+    Vector3 sdir = Vector3((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r);
+    Vector3 tdir = Vector3((s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r);
+
+    int corners[3] = { a, b, c };
+    for (int i = 0; i < 3; i++) {
+        Vector3 n = normals[corners[i]];
+        Vector3 nt = sdir;
+        ortho_normalize(n, nt);
+        tangents[corners[i]] = SlicerVector4(nt.x, nt.y, nt.z, (n.cross(nt).dot(tdir) < 0.0f) ? -1.0f : 1.0f);
+    }
+}
@@ -0,0 +1,258 @@
+#ifndef MESH_BUFFER_H
+#define MESH_BUFFER_H
+
+#include "core_types.h"
+
+#ifndef SLICER_STANDALONE
+#include <godot_cpp/classes/array_mesh.hpp>
+#endif
+
+#include "memory_tracker.h"
+#include "slicer_vector4.h"
+#include "vertex_format.h"
+
+template <class T>
+_FORCE_INLINE_ T lerp_attribute(const T &a, const T &b, real_t t) {
+    return (a * (1.0f - t)) + (b * t);
+}
+
+/**
+ * Structure of arrays representation of a mesh surface. Rather than keeping a
+ * fat struct per face holding every attribute a vertex could possibly have, each
+ * attribute lives in its own contiguous stream and faces are just triples of
+ * indices into them. Only the streams flagged in `format` are ever filled, so a
+ * surface with nothing but positions and normals doesn't pay for tangents, colors,
+ * bones, weights or uvs.
+*/
+struct MeshBuffer {
+    // The Mesh::ARRAY_FORMAT_* flags a buffer can carry streams for. Positions
+    // are always present so they aren't part of this
+    static const uint32_t ATTRIBUTE_MASK =
+        Mesh::ARRAY_FORMAT_NORMAL |
+        Mesh::ARRAY_FORMAT_TANGENT |
+        Mesh::ARRAY_FORMAT_COLOR |
+        Mesh::ARRAY_FORMAT_BONES |
+        Mesh::ARRAY_FORMAT_WEIGHTS |
+        Mesh::ARRAY_FORMAT_TEX_UV |
+        Mesh::ARRAY_FORMAT_TEX_UV2;
+
+    // Which of the attribute streams below are in use, as Mesh::ARRAY_FORMAT_* flags
+    uint32_t format = 0;
+
+    LocalVector<Vector3> vertices;
+    LocalVector<Vector3> normals;
+    LocalVector<SlicerVector4> tangents;
+    LocalVector<Color> colors;
+    LocalVector<SlicerVector4> bones;
+    LocalVector<SlicerVector4> weights;
+    // Documentation says that uvs can be either Vector2 or Vector3
+    // but glancing through the visual server code it seems its just
+    // handled as a Vector2 (which makes sense). For now this should
+    // be fine
+    LocalVector<Vector2> uvs;
+    LocalVector<Vector2> uv2s;
+
+    // Three indices into the streams above for every face
+    LocalVector<int> indices;
+
+#ifndef SLICER_STANDALONE
+    /**
+     * Parse a mesh's surface into this buffer. This will preserve the mapping associated
+     * with each vertex and can handle both indexed and non indexed vertex arrays. Returns
+     * false, leaving the buffer empty, if the surface isn't made of triangles. See
+     * VertexFormat::dispatch for specialized
+    */
+    bool parse_surface(const ArrayMesh &mesh, int surface_idx, bool specialized = true);
+
+    /**
+     * Same as parse_surface but from a triangle surface's arrays, as returned by
+     * Mesh::surface_get_arrays, and its format. Unlike parse_surface this doesn't
+     * go through the engine so it's safe to call off the main thread
+    */
+    bool parse_arrays(const Array &arrays, uint32_t surface_format, bool specialized = true);
+
+    /**
+     * parse_arrays taken apart, so a big surface can be parsed a range at a time (see
+     * SliceJob::step). begin_parse sizes the buffer's streams and indices to hold the
+     * surface, returning false like parse_arrays does, then parse_vertices and parse_indices
+     * fill in a range of them. The arrays need to be the same for every call
+    */
+    bool begin_parse(const Array &arrays, uint32_t surface_format);
+    void parse_vertices(const Array &arrays, uint32_t surface_format, int first, int count, bool specialized = true);
+    void parse_indices(const Array &arrays, uint32_t surface_format, int first, int count);
+#endif
+
+    /**
+     * Appends a new vertex interpolated along the edge running from vertex a to vertex b,
+     * where t is the fraction of the way from a to b. Returns the new vertex's index.
+     * FORMAT should either match the buffer's format or be VertexFormat::DYNAMIC
+    */
+    template <uint32_t FORMAT = VertexFormat::DYNAMIC>
+    int add_lerped_vertex(int a, int b, real_t t) {
+        return add_lerped_vertex<FORMAT>(*this, a, b, t);
+    }
+
+    /**
+     * Same as above, except a and b are vertexes of source (which can be this buffer),
+     * which should have the same format as this one
+    */
+    template <uint32_t FORMAT = VertexFormat::DYNAMIC>
+    int add_lerped_vertex(const MeshBuffer &source, int a, int b, real_t t);
+
+    /**
+     * Copies count of from's vertexes, starting at from_first, into this buffer's streams
+     * starting at offset. Every vertex from from_first on gets copied if count is negative.
+     * The streams need to be big enough to hold them already
+    */
+    void copy_vertices(const MeshBuffer &from, int offset, int from_first = 0, int count = -1);
+
+    /**
+     * Copies the vertex at from_idx of from into the slot at to_idx of this buffer
+    */
+    void copy_vertex(const MeshBuffer &from, int from_idx, int to_idx);
+
+    /**
+     * Replaces this buffer with the faces of source listed in source_indices, keeping only
+     * the vertexes those faces use. When flip_winding is set the last two corners of every
+     * face are swapped. If given, r_remap holds the scratch memory mapping the source's
+     * vertexes to this buffer's, so extracting again doesn't have to allocate it
+    */
+    void extract(const MeshBuffer &source, const LocalVector<int> &source_indices, bool flip_winding = false, LocalVector<int> *r_remap = nullptr);
+
+    /**
+     * Same as extract but adds the faces after the ones already in this buffer, which should
+     * have the same format as source unless it's empty
+    */
+    void append(const MeshBuffer &source, const LocalVector<int> &source_indices, bool flip_winding = false, LocalVector<int> *r_remap = nullptr);
+
+    /**
+     * Cuts this buffer down to the faces listed in kept_indices, which index into it, dropping
+     * every vertex they don't use. Works in place rather than copying the faces out like extract,
+     * the vertexes that are left keep their order. r_remap is the same as extract's
+    */
+    void compact(const LocalVector<int> &kept_indices, LocalVector<int> *r_remap = nullptr);
+
+    /**
+     * Adds every stream to the tracker, the ones this buffer doesn't carry included so the
+     * same buffer always adds the same number of them
+    */
+    void track_memory(MemoryTracker &tracker) const;
+
+    /**
+     * Uses normal and UV information to generate tangents for each corner of the given face
+    */
+    void compute_tangents(int face_idx);
+
+    /**
+     * Resizes every stream this buffer carries to hold the given number of vertexes
+    */
+    template <uint32_t FORMAT = VertexFormat::DYNAMIC>
+    void resize_vertices(int count);
+
+    void clear() {
+        format = 0;
+        vertices.clear();
+        normals.clear();
+        tangents.clear();
+        colors.clear();
+        bones.clear();
+        weights.clear();
+        uvs.clear();
+        uv2s.clear();
+        indices.clear();
+    }
+
+    _FORCE_INLINE_ bool has(uint32_t p_attribute) const {
+        return (format & p_attribute) != 0;
+    }
+
+    _FORCE_INLINE_ int vertex_count() const {
+        return vertices.size();
+    }
+
+    _FORCE_INLINE_ int face_count() const {
+        return indices.size() / 3;
+    }
+
+    /**
+     * Roughly how many bytes the streams of this buffer take up
+    */
+    int64_t memory_usage() const {
+        return (int64_t)vertices.size() * sizeof(Vector3) +
+            normals.size() * sizeof(Vector3) +
+            tangents.size() * sizeof(SlicerVector4) +
+            colors.size() * sizeof(Color) +
+            bones.size() * sizeof(SlicerVector4) +
+            weights.size() * sizeof(SlicerVector4) +
+            uvs.size() * sizeof(Vector2) +
+            uv2s.size() * sizeof(Vector2) +
+            indices.size() * sizeof(int);
+    }
+};
+
+template <uint32_t FORMAT>
+int MeshBuffer::add_lerped_vertex(const MeshBuffer &source, int a, int b, real_t t) {
+    int idx = vertex_count();
+    resize_vertices<FORMAT>(idx + 1);
+
+    vertices[idx] = lerp_attribute(source.vertices[a], source.vertices[b], t);
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_NORMAL)) {
+        normals[idx] = lerp_attribute(source.normals[a], source.normals[b], t);
+    }
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TANGENT)) {
+        tangents[idx] = lerp_attribute(source.tangents[a], source.tangents[b], t);
+    }
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_COLOR)) {
+        colors[idx] = lerp_attribute(source.colors[a], source.colors[b], t);
+    }
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_BONES)) {
+        bones[idx] = lerp_attribute(source.bones[a], source.bones[b], t);
+    }
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_WEIGHTS)) {
+        weights[idx] = lerp_attribute(source.weights[a], source.weights[b], t);
+    }
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TEX_UV)) {
+        uvs[idx] = lerp_attribute(source.uvs[a], source.uvs[b], t);
+    }
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TEX_UV2)) {
+        uv2s[idx] = lerp_attribute(source.uv2s[a], source.uv2s[b], t);
+    }
+
+    return idx;
+}
+
+template <uint32_t FORMAT>
+void MeshBuffer::resize_vertices(int count) {
+    vertices.resize(count);
+
+    // There's gotta be a less tedious way of doing this
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_NORMAL))
+        normals.resize(count);
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TANGENT))
+        tangents.resize(count);
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_COLOR))
+        colors.resize(count);
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_BONES))
+        bones.resize(count);
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_WEIGHTS))
+        weights.resize(count);
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TEX_UV))
+        uvs.resize(count);
+
+    if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TEX_UV2))
+        uv2s.resize(count);
+}
+
+#endif // MESH_BUFFER_H
@@ -0,0 +1,83 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "core_types.h"
+
+#ifdef SLICER_STANDALONE
+#include <atomic>
+#include <thread>
+#else
+#include <godot_cpp/classes/worker_thread_pool.hpp>
+#include <godot_cpp/variant/string.hpp>
+#endif
+
+/**
+ * Thin wrapper over Godot's WorkerThreadPool for running a functor over a
+ * range of indices. Without Godot (see core_types.h) it spins up a thread
+ * per core for the duration of the call instead
+*/
+namespace Parallel {
+#ifdef SLICER_STANDALONE
+    template <class Task>
+    void for_each(int count, Task &task, const char *description) {
+        // Only there to match the pool's version, threads spun up here go unnamed
+        (void)description;
+
+        if (count <= 0) {
+            return;
+        }
+
+        if (count == 1) {
+            task(0);
+            return;
+        }
+
+        std::atomic<int> next(0);
+        auto worker = [&]() {
+            for (int i = next++; i < count; i = next++) {
+                task(i);
+            }
+        };
+
+        int thread_count = MIN(count, (int)MAX(std::thread::hardware_concurrency(), 1u));
+        std::vector<std::thread> threads;
+        for (int i = 1; i < thread_count; i++) {
+            threads.emplace_back(worker);
+        }
+
+        worker();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+    }
+#else
+    template <class Task>
+    void run_task(void *p_userdata, uint32_t p_index) {
+        (*static_cast<Task *>(p_userdata))(p_index);
+    }
+
+    /**
+     * Calls task(i) for every i in [0, count) across the WorkerThreadPool and blocks
+     * until all of them are done. The calls can happen in any order and on any thread,
+     * so each one should only be writing to its own slice of the output
+    */
+    template <class Task>
+    void for_each(int count, Task &task, const String &description) {
+        if (count <= 0) {
+            return;
+        }
+
+        // Not worth the trip through the pool
+        if (count == 1) {
+            task(0);
+            return;
+        }
+
+        WorkerThreadPool *pool = WorkerThreadPool::get_singleton();
+        int64_t group_id = pool->add_native_group_task(&run_task<Task>, &task, count, -1, true, description);
+        pool->wait_for_group_task_completion(group_id);
+    }
+#endif
+} // Parallel
+
+#endif // PARALLEL_H
@@ -0,0 +1,361 @@
+#include "slice_capture.h"
+#include "slice_timings.h"
+
+#include <cstring>
+
+namespace SliceCapture {
+    _FORCE_INLINE_ void write_u32(FILE *file, uint32_t value) {
+        fwrite(&value, sizeof(value), 1, file);
+    }
+
+    _FORCE_INLINE_ void write_u64(FILE *file, uint64_t value) {
+        fwrite(&value, sizeof(value), 1, file);
+    }
+
+    /**
+     * Writes count reals out as 32 bit floats
+    */
+    void write_reals(FILE *file, const real_t *values, int count) {
+        float buffer[256];
+        for (int i = 0; i < count; i += 256) {
+            int batch = MIN(count - i, 256);
+            for (int j = 0; j < batch; j++) {
+                buffer[j] = values[i + j];
+            }
+            fwrite(buffer, sizeof(float), batch, file);
+        }
+    }
+
+    _FORCE_INLINE_ bool read_u32(FILE *file, uint32_t &r_value) {
+        return fread(&r_value, sizeof(r_value), 1, file) == 1;
+    }
+
+    _FORCE_INLINE_ bool read_u64(FILE *file, uint64_t &r_value) {
+        return fread(&r_value, sizeof(r_value), 1, file) == 1;
+    }
+
+    bool read_reals(FILE *file, real_t *r_values, int count) {
+        float buffer[256];
+        for (int i = 0; i < count; i += 256) {
+            int batch = MIN(count - i, 256);
+            if (fread(buffer, sizeof(float), batch, file) != (size_t)batch) {
+                return false;
+            }
+            for (int j = 0; j < batch; j++) {
+                r_values[i + j] = buffer[j];
+            }
+        }
+        return true;
+    }
+
+    /**
+     * FNV-1a over 64 bit words, with whatever's left over at the end hashed a byte at a time
+    */
+    uint64_t hash_bytes(const void *data, size_t size, uint64_t hash) {
+        const uint64_t PRIME = 0x100000001b3ULL;
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+        size_t words = size / 8;
+        for (size_t i = 0; i < words; i++) {
+            uint64_t word;
+            memcpy(&word, bytes + i * 8, 8);
+            hash = (hash ^ word) * PRIME;
+        }
+
+        for (size_t i = words * 8; i < size; i++) {
+            hash = (hash ^ bytes[i]) * PRIME;
+        }
+
+        return hash;
+    }
+
+    template <class T>
+    _FORCE_INLINE_ uint64_t hash_stream(const LocalVector<T> &stream, uint64_t hash) {
+        return hash_bytes(stream.ptr(), stream.size() * sizeof(T), hash);
+    }
+
+    /**
+     * Hashes everything write_mesh writes out, so meshes only get written once if every
+     * last stream of theirs matches
+    */
+    uint64_t hash_mesh(const LocalVector<const MeshBuffer *> &surfaces) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+
+        uint32_t surface_count = surfaces.size();
+        hash = hash_bytes(&surface_count, sizeof(surface_count), hash);
+
+        for (uint32_t i = 0; i < surfaces.size(); i++) {
+            const MeshBuffer &surface = *surfaces[i];
+            uint32_t header[3] = { surface.format, (uint32_t)surface.vertex_count(), surface.indices.size() };
+
+            hash = hash_bytes(header, sizeof(header), hash);
+            hash = hash_stream(surface.vertices, hash);
+            if (surface.has(Mesh::ARRAY_FORMAT_NORMAL)) {
+                hash = hash_stream(surface.normals, hash);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_TANGENT)) {
+                hash = hash_stream(surface.tangents, hash);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_COLOR)) {
+                hash = hash_stream(surface.colors, hash);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_BONES)) {
+                hash = hash_stream(surface.bones, hash);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_WEIGHTS)) {
+                hash = hash_stream(surface.weights, hash);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_TEX_UV)) {
+                hash = hash_stream(surface.uvs, hash);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_TEX_UV2)) {
+                hash = hash_stream(surface.uv2s, hash);
+            }
+            hash = hash_stream(surface.indices, hash);
+        }
+
+        return hash;
+    }
+
+    bool Writer::open(const char *path) {
+        close();
+
+        file = fopen(path, "wb");
+        if (!file) {
+            return false;
+        }
+
+        write_u32(file, MAGIC);
+        write_u32(file, VERSION);
+        start_usec = SliceTimings::now_usec();
+        return true;
+    }
+
+    void Writer::close() {
+        if (file) {
+            fclose(file);
+            file = nullptr;
+        }
+
+        meshes.clear();
+        materials.clear();
+    }
+
+    void Writer::write_mesh(uint32_t id, const LocalVector<const MeshBuffer *> &surfaces) {
+        write_u32(file, TAG_MESH);
+        write_u32(file, id);
+        write_u32(file, surfaces.size());
+
+        for (uint32_t i = 0; i < surfaces.size(); i++) {
+            const MeshBuffer &surface = *surfaces[i];
+            int count = surface.vertex_count();
+
+            write_u32(file, surface.format);
+            write_u32(file, count);
+            write_u32(file, surface.indices.size());
+
+            write_reals(file, reinterpret_cast<const real_t *>(surface.vertices.ptr()), count * 3);
+            if (surface.has(Mesh::ARRAY_FORMAT_NORMAL)) {
+                write_reals(file, reinterpret_cast<const real_t *>(surface.normals.ptr()), count * 3);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_TANGENT)) {
+                write_reals(file, reinterpret_cast<const real_t *>(surface.tangents.ptr()), count * 4);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_COLOR)) {
+                fwrite(surface.colors.ptr(), sizeof(Color), count, file);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_BONES)) {
+                write_reals(file, reinterpret_cast<const real_t *>(surface.bones.ptr()), count * 4);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_WEIGHTS)) {
+                write_reals(file, reinterpret_cast<const real_t *>(surface.weights.ptr()), count * 4);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_TEX_UV)) {
+                write_reals(file, reinterpret_cast<const real_t *>(surface.uvs.ptr()), count * 2);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_TEX_UV2)) {
+                write_reals(file, reinterpret_cast<const real_t *>(surface.uv2s.ptr()), count * 2);
+            }
+
+            fwrite(surface.indices.ptr(), sizeof(int), surface.indices.size(), file);
+        }
+    }
+
+    uint32_t Writer::add_mesh(const LocalVector<const MeshBuffer *> &surfaces) {
+        ERR_FAIL_NULL_V(file, 0);
+
+        uint64_t hash = hash_mesh(surfaces);
+        const uint32_t *existing = meshes.getptr(hash);
+        if (existing) {
+            return *existing;
+        }
+
+        uint32_t id = meshes.size();
+        meshes.insert(hash, id);
+        write_mesh(id, surfaces);
+        return id;
+    }
+
+    int32_t Writer::add_material(uint64_t key, const std::string &name) {
+        ERR_FAIL_NULL_V(file, -1);
+
+        const int32_t *existing = materials.getptr(key);
+        if (existing) {
+            return *existing;
+        }
+
+        int32_t slot = materials.size();
+        materials.insert(key, slot);
+
+        write_u32(file, TAG_MATERIAL);
+        write_u32(file, slot);
+        write_u32(file, name.size());
+        fwrite(name.data(), 1, name.size(), file);
+        return slot;
+    }
+
+    void Writer::add_call(Call call) {
+        ERR_FAIL_NULL(file);
+        call.time_usec = SliceTimings::now_usec() - start_usec;
+
+        real_t plane[4] = { call.plane.normal.x, call.plane.normal.y, call.plane.normal.z, call.plane.d };
+
+        write_u32(file, TAG_CALL);
+        write_u32(file, call.mesh);
+        write_u32(file, (uint32_t)call.material);
+        write_reals(file, call.transform, 12);
+        write_reals(file, plane, 4);
+        write_u32(file, call.flags);
+        write_u64(file, call.time_usec);
+
+        // A capture is usually wanted right after whatever it caught, and that might be a crash
+        fflush(file);
+    }
+
+    bool read_mesh(FILE *file, Capture &r_capture) {
+        uint32_t id;
+        uint32_t surface_count;
+        if (!read_u32(file, id) || !read_u32(file, surface_count) || id != r_capture.meshes.size()) {
+            return false;
+        }
+
+        r_capture.meshes.resize(id + 1);
+        LocalVector<MeshBuffer> &surfaces = r_capture.meshes[id];
+        surfaces.resize(surface_count);
+
+        for (uint32_t i = 0; i < surface_count; i++) {
+            MeshBuffer &surface = surfaces[i];
+            uint32_t format;
+            uint32_t count;
+            uint32_t index_count;
+            if (!read_u32(file, format) || !read_u32(file, count) || !read_u32(file, index_count)) {
+                return false;
+            }
+
+            surface.format = format & MeshBuffer::ATTRIBUTE_MASK;
+            surface.resize_vertices(count);
+            surface.indices.resize(index_count);
+
+            bool ok = read_reals(file, reinterpret_cast<real_t *>(surface.vertices.ptr()), count * 3);
+            if (surface.has(Mesh::ARRAY_FORMAT_NORMAL)) {
+                ok = ok && read_reals(file, reinterpret_cast<real_t *>(surface.normals.ptr()), count * 3);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_TANGENT)) {
+                ok = ok && read_reals(file, reinterpret_cast<real_t *>(surface.tangents.ptr()), count * 4);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_COLOR)) {
+                ok = ok && fread(surface.colors.ptr(), sizeof(Color), count, file) == count;
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_BONES)) {
+                ok = ok && read_reals(file, reinterpret_cast<real_t *>(surface.bones.ptr()), count * 4);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_WEIGHTS)) {
+                ok = ok && read_reals(file, reinterpret_cast<real_t *>(surface.weights.ptr()), count * 4);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_TEX_UV)) {
+                ok = ok && read_reals(file, reinterpret_cast<real_t *>(surface.uvs.ptr()), count * 2);
+            }
+            if (surface.has(Mesh::ARRAY_FORMAT_TEX_UV2)) {
+                ok = ok && read_reals(file, reinterpret_cast<real_t *>(surface.uv2s.ptr()), count * 2);
+            }
+
+            ok = ok && fread(surface.indices.ptr(), sizeof(int), index_count, file) == index_count;
+            if (!ok) {
+                return false;
+            }
+
+            // Whatever got corrupted along the way shouldn't take the replay down with it
+            for (uint32_t j = 0; j < index_count; j++) {
+                if ((uint32_t)surface.indices[j] >= count) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool read_material(FILE *file, Capture &r_capture) {
+        uint32_t slot;
+        uint32_t length;
+        if (!read_u32(file, slot) || !read_u32(file, length) || slot != r_capture.materials.size()) {
+            return false;
+        }
+
+        std::string name(length, '\0');
+        if (fread(&name[0], 1, length, file) != length) {
+            return false;
+        }
+
+        r_capture.materials.push_back(name);
+        return true;
+    }
+
+    bool read_call(FILE *file, Capture &r_capture) {
+        Call call;
+        uint32_t material;
+        real_t plane[4];
+
+        bool ok = read_u32(file, call.mesh) && read_u32(file, material) &&
+                read_reals(file, call.transform, 12) && read_reals(file, plane, 4) &&
+                read_u32(file, call.flags) && read_u64(file, call.time_usec);
+
+        if (!ok || call.mesh >= r_capture.meshes.size()) {
+            return false;
+        }
+
+        call.material = (int32_t)material;
+        call.plane = Plane(Vector3(plane[0], plane[1], plane[2]), plane[3]);
+        r_capture.calls.push_back(call);
+        return true;
+    }
+
+    bool read(const char *path, Capture &r_capture) {
+        FILE *file = fopen(path, "rb");
+        ERR_FAIL_NULL_V_MSG(file, false, "Couldn't open the capture");
+
+        uint32_t magic;
+        uint32_t version;
+        bool ok = read_u32(file, magic) && read_u32(file, version) && magic == MAGIC && version == VERSION;
+
+        uint32_t tag;
+        while (ok && read_u32(file, tag)) {
+            switch (tag) {
+                case TAG_MESH:
+                    ok = read_mesh(file, r_capture);
+                    break;
+                case TAG_MATERIAL:
+                    ok = read_material(file, r_capture);
+                    break;
+                case TAG_CALL:
+                    ok = read_call(file, r_capture);
+                    break;
+                default:
+                    ok = false;
+            }
+        }
+
+        fclose(file);
+        return ok;
+    }
+} // SliceCapture
@@ -0,0 +1,120 @@
+#ifndef SLICE_CAPTURE_H
+#define SLICE_CAPTURE_H
+
+#include <cstdio>
+#include <string>
+
+#include "mesh_buffer.h"
+
+/**
+ * A recording of slice calls, with the meshes they were made on, that can be played back
+ * later without the game that made them (see Slicer::start_recording and bench/slice_replay.cpp).
+ *
+ * The file is a header followed by a stream of records, each starting with its tag. A mesh is
+ * only written the first time a call uses it, every call after that refers back to it by id.
+ * Everything is little endian, and positions and every other stream are written as 32 bit
+ * floats whatever real_t is, to keep captures small
+*/
+namespace SliceCapture {
+    const uint32_t MAGIC = 0x50414353; // "SCAP"
+    const uint32_t VERSION = 1;
+
+    enum Tag {
+        TAG_MESH = 1,
+        TAG_MATERIAL = 2,
+        TAG_CALL = 3,
+    };
+
+    // The Slicer settings a call was made with, so a replay can follow them
+    enum CallFlags {
+        FLAG_INDEXED_OUTPUT = 1,
+        FLAG_SPECIALIZED_KERNELS = 2,
+        FLAG_PARALLEL = 4,
+        FLAG_USE_BVH = 8,
+    };
+
+    struct Call {
+        uint32_t mesh = 0;
+
+        // Slot of the cross section material in the capture's materials, -1 for none
+        int32_t material = -1;
+
+        // Where the mesh was placed, its basis by rows followed by its origin. The plane is
+        // already in the mesh's own space, the transform is only kept for reference
+        real_t transform[12] = { 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0 };
+        Plane plane;
+
+        uint32_t flags = 0;
+
+        // Since the recording started
+        uint64_t time_usec = 0;
+    };
+
+    /**
+     * Writes a capture out as calls come in. Recording a call only costs hashing its mesh,
+     * plus writing the mesh out the first time it shows up
+    */
+    class Writer {
+        FILE *file = nullptr;
+        uint64_t start_usec = 0;
+
+        // Content hash of every mesh written so far, to its id
+        HashMap<uint64_t, uint32_t> meshes;
+
+        // Whatever identifies each material to the caller, to its slot
+        HashMap<uint64_t, int32_t> materials;
+
+        void write_mesh(uint32_t id, const LocalVector<const MeshBuffer *> &surfaces);
+
+    public:
+        /**
+         * Starts a new capture at path, overwriting whatever was there. Returns false if the
+         * file couldn't be opened
+        */
+        bool open(const char *path);
+        void close();
+
+        bool is_open() const {
+            return file != nullptr;
+        }
+
+        /**
+         * The id of the mesh made of these surfaces, writing it out if no call has used a mesh
+         * just like it before
+        */
+        uint32_t add_mesh(const LocalVector<const MeshBuffer *> &surfaces);
+
+        /**
+         * The slot of the material known to the caller by key, writing its name out the first
+         * time it shows up
+        */
+        int32_t add_material(uint64_t key, const std::string &name);
+
+        /**
+         * Writes the call out, stamping it with the time since the capture was opened
+        */
+        void add_call(Call call);
+
+        ~Writer() {
+            close();
+        }
+    };
+
+    /**
+     * Everything in a capture file, see read
+    */
+    struct Capture {
+        // The surfaces of each mesh, by id
+        LocalVector<LocalVector<MeshBuffer>> meshes;
+        LocalVector<std::string> materials;
+        LocalVector<Call> calls;
+    };
+
+    /**
+     * Reads the whole capture at path into r_capture. Returns false, leaving r_capture with
+     * whatever was read up to that point, if the file can't be read or isn't a capture
+    */
+    bool read(const char *path, Capture &r_capture);
+} // SliceCapture
+
+#endif // SLICE_CAPTURE_H
@@ -0,0 +1,66 @@
+#ifndef SLICE_TIMINGS_H
+#define SLICE_TIMINGS_H
+
+#include <chrono>
+
+#include "core_types.h"
+
+/**
+ * Where the time of a slice went, phase by phase, along with how much it had to go through.
+ * Only filled in when a slice is asked to collect them (see Slicer::set_collect_stats), every
+ * step of the slice takes a pointer to one that's null otherwise so nothing gets timed at all
+*/
+struct SliceTimings {
+    enum Phase {
+        PHASE_PARSE,
+        PHASE_CLASSIFY,
+        PHASE_SPLIT,
+        PHASE_CAP,
+        PHASE_SERIALIZE,
+        PHASE_COMMIT,
+        PHASE_MAX,
+    };
+
+    uint64_t usec[PHASE_MAX] = { 0, 0, 0, 0, 0, 0 };
+
+    int input_triangles = 0;
+    int input_vertices = 0;
+    int output_triangles = 0;
+    int output_vertices = 0;
+    int intersection_points = 0;
+
+    // Estimates of what the slice's buffers allocated, and of the most they held at the end
+    // of any phase. See MemoryTracker for how these are counted and what they miss
+    uint64_t bytes_allocated = 0;
+    int allocations = 0;
+    uint64_t peak_bytes = 0;
+
+    /**
+     * A steady clock that works the same whether or not the core is built with Godot,
+     * and from any thread
+    */
+    static _FORCE_INLINE_ uint64_t now_usec() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Adds the time since start, as given by now_usec, to the phase
+    */
+    _FORCE_INLINE_ void add(Phase phase, uint64_t start) {
+        usec[phase] += now_usec() - start;
+    }
+
+    uint64_t total_usec() const {
+        uint64_t total = 0;
+        for (int i = 0; i < PHASE_MAX; i++) {
+            total += usec[i];
+        }
+        return total;
+    }
+
+    void clear() {
+        *this = SliceTimings();
+    }
+};
+
+#endif // SLICE_TIMINGS_H
@@ -1,10 +1,12 @@
 #ifndef SLICER_VECTOR4_H
 #define SLICER_VECTOR4_H
 
-//#include "core/math/math_funcs.h"
-#include <godot_cpp/core/math.hpp>
+#include "core_types.h"
+
+#ifndef SLICER_STANDALONE
 //#include "core/string/ustring.h"
 #include <godot_cpp/variant/string.hpp>
+#endif
 
 /**
  * Godot does not currently have a 4 dimensional Vector class so we just
@@ -58,9 +60,11 @@ struct SlicerVector4 {
 		return x == other.x && y == other.y && z == other.z && w == other.w;
 	}
 
+#ifndef SLICER_STANDALONE
 	operator String() const {
         return (String::num(x) + ", " + String::num(y) + ", " + String::num(z), + ", " + String::num(w));
     }
+#endif
 
 	_FORCE_INLINE_ SlicerVector4(real_t p_x, real_t p_y, real_t p_z, real_t p_w) {
 		x = p_x;
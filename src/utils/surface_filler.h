@@ -1,14 +1,14 @@
 #ifndef SURFACE_FILLER_H
 #define SURFACE_FILLER_H
 
-#include "slicer_face.h"
+#include "mesh_buffer.h"
 
 #include <godot_cpp/classes/array_mesh.hpp>
 
 /**
  * The inverse of FaceFiller, this struct is responsible for taking
- * SlicerFaces and serializing them back into vertex arrays for Godot
- * to read into a mesh surface
+ * the vertexes of a MeshBuffer and serializing them back into vertex
+ * arrays for Godot to read into a mesh surface
 */
 struct SurfaceFiller {
     bool has_normals;
@@ -19,9 +19,12 @@ struct SurfaceFiller {
     bool has_uvs;
     bool has_uv2s;
 
-    const SlicerFace *faces_reader;
+    const MeshBuffer *buffer;
     Array arrays;
 
+    // Subtracted from every vertex written out
+    Vector3 origin;
+
     PackedVector3Array vertices;
     Vector3 *vertices_writer;
 
@@ -58,22 +61,59 @@ struct SurfaceFiller {
     PackedVector2Array uv2s;
     Vector2 *uv2s_writer;
 
-    SurfaceFiller(const Vector<SlicerFace> &faces) {
-        SlicerFace first_face = faces[0];
+    // Only used when building an indexed surface (see fill_indexed)
+    bool indexed;
+    int vertex_count;
+    int index_count;
+    PackedInt32Array indices;
+    int *indices_writer;
+    LocalVector<int> own_remap;
+    int *remap = nullptr;
 
-        has_normals = first_face.has_normals;
-        has_tangents = first_face.has_tangents;
-        has_colors = first_face.has_colors;
-        has_bones = first_face.has_bones;
-        has_weights = first_face.has_weights;
-        has_uvs = first_face.has_uvs;
-        has_uv2s = first_face.has_uv2s;
+    /**
+     * Prepares arrays big enough to hold index_count corners of the passed in
+     * buffer, either as their own vertexes or, when indexed, shared through an
+     * index array. The indexed remapping is done in p_remap if one is passed in,
+     * so its memory can be reused from one surface to the next
+    */
+    SurfaceFiller(const MeshBuffer &p_buffer, int p_index_count, bool p_indexed = false, LocalVector<int> *p_remap = nullptr) {
+        buffer = &p_buffer;
 
-        faces_reader = faces.ptr();
+        has_normals = buffer->has(Mesh::ARRAY_FORMAT_NORMAL);
+        has_tangents = buffer->has(Mesh::ARRAY_FORMAT_TANGENT);
+        has_colors = buffer->has(Mesh::ARRAY_FORMAT_COLOR);
+        has_bones = buffer->has(Mesh::ARRAY_FORMAT_BONES);
+        has_weights = buffer->has(Mesh::ARRAY_FORMAT_WEIGHTS);
+        has_uvs = buffer->has(Mesh::ARRAY_FORMAT_TEX_UV);
+        has_uv2s = buffer->has(Mesh::ARRAY_FORMAT_TEX_UV2);
 
         arrays.resize(Mesh::ARRAY_MAX);
 
-        int array_length = faces.size() * 3;
+        int array_length = p_index_count;
+
+        indexed = p_indexed;
+        vertex_count = 0;
+        index_count = 0;
+
+        if (indexed) {
+            indices.resize(p_index_count);
+            indices_writer = indices.ptrw();
+
+            // Maps a vertex of the buffer to where we've already written it, so
+            // every face sharing it can point at the same one
+            LocalVector<int> &remap_buffer = p_remap ? *p_remap : own_remap;
+            remap_buffer.resize(buffer->vertex_count());
+            remap = remap_buffer.ptr();
+            for (int i = 0; i < buffer->vertex_count(); i++) {
+                remap[i] = -1;
+            }
+
+            // We can't end up with more vertexes than the buffer has. Either way this is
+            // just an upper bound, get_arrays trims the arrays back down to the vertexes
+            // that were actually written
+            array_length = MIN(array_length, buffer->vertex_count());
+        }
+
         vertices.resize(array_length);
         vertices_writer = vertices.ptrw();
 
@@ -115,76 +155,94 @@ struct SurfaceFiller {
     }
 
     /**
-     * Takes data from the faces using the lookup_idx and stores it
-     * to be saved into vertex arrays (see add_to_mesh for how to attach
-     * that information into a mesh)
+     * Takes data from the buffer's vertex at lookup_idx and stores it
+     * to be saved into vertex arrays (see get_arrays for handing them
+     * over to a mesh). FORMAT is the buffer's format, or
+     * VertexFormat::DYNAMIC to have it checked vertex by vertex
     */
+    template <uint32_t FORMAT = VertexFormat::DYNAMIC>
     _FORCE_INLINE_ void fill(int lookup_idx, int set_idx) {
-        // TODO - I think the function definition here with lookup_idx and set_idx
-        // is reversed from FaceFiller#fill. We should make that more consistant
-        //
-        // As mentioned in the FaceFiller comments, while having this function work
-        // on a vertex by vertex basis helps with cleaner code (especially, in this case,
-        // when it comes to reversing the order of cross section verts), its conceptually
-        // and perhaps performancely drawnback back by having to do these repeated calculations
-        // and boolean checks (I'd hope the force_inline would help with the function invocation
-        // cost but even then who knows).
-        int face_idx = lookup_idx / 3;
-        int idx_offset = lookup_idx % 3;
-
-        SlicerFace face = faces_reader[face_idx];
-
-        vertices_writer[set_idx] = face.vertex[idx_offset];
+        const uint32_t format = buffer->format;
 
-        if (has_normals) {
-            normals_writer[set_idx] = face.normal[idx_offset];
+        vertices_writer[set_idx] = buffer->vertices[lookup_idx] - origin;
+
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_NORMAL)) {
+            normals_writer[set_idx] = buffer->normals[lookup_idx];
         }
 
-        if (has_tangents) {
-            tangents_writer[set_idx * 4] = face.tangent[idx_offset][0];
-            tangents_writer[set_idx * 4 + 1] = face.tangent[idx_offset][1];
-            tangents_writer[set_idx * 4 + 2] = face.tangent[idx_offset][2];
-            tangents_writer[set_idx * 4 + 3] = face.tangent[idx_offset][3];
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TANGENT)) {
+            const SlicerVector4 &tangent = buffer->tangents[lookup_idx];
+            tangents_writer[set_idx * 4] = tangent[0];
+            tangents_writer[set_idx * 4 + 1] = tangent[1];
+            tangents_writer[set_idx * 4 + 2] = tangent[2];
+            tangents_writer[set_idx * 4 + 3] = tangent[3];
         }
 
-        if (has_colors) {
-            colors_writer[set_idx] = face.color[idx_offset];
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_COLOR)) {
+            colors_writer[set_idx] = buffer->colors[lookup_idx];
         }
 
-        if (has_bones) {
-            bones_writer[set_idx * 4] = face.bones[idx_offset][0];
-            bones_writer[set_idx * 4 + 1] = face.bones[idx_offset][1];
-            bones_writer[set_idx * 4 + 2] = face.bones[idx_offset][2];
-            bones_writer[set_idx * 4 + 3] = face.bones[idx_offset][3];
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_BONES)) {
+            const SlicerVector4 &bone = buffer->bones[lookup_idx];
+            bones_writer[set_idx * 4] = bone[0];
+            bones_writer[set_idx * 4 + 1] = bone[1];
+            bones_writer[set_idx * 4 + 2] = bone[2];
+            bones_writer[set_idx * 4 + 3] = bone[3];
         }
 
-        if (has_weights) {
-            weights_writer[set_idx * 4] = face.weights[idx_offset][0];
-            weights_writer[set_idx * 4 + 1] = face.weights[idx_offset][1];
-            weights_writer[set_idx * 4 + 2] = face.weights[idx_offset][2];
-            weights_writer[set_idx * 4 + 3] = face.weights[idx_offset][3];
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_WEIGHTS)) {
+            const SlicerVector4 &weight = buffer->weights[lookup_idx];
+            weights_writer[set_idx * 4] = weight[0];
+            weights_writer[set_idx * 4 + 1] = weight[1];
+            weights_writer[set_idx * 4 + 2] = weight[2];
+            weights_writer[set_idx * 4 + 3] = weight[3];
         }
 
-        if (has_uvs) {
-            uvs_writer[set_idx] = face.uv[idx_offset];
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TEX_UV)) {
+            uvs_writer[set_idx] = buffer->uvs[lookup_idx];
         }
 
-        if (has_uv2s) {
-            uv2s_writer[set_idx] = face.uv2[idx_offset];
+        if (VertexFormat::has<FORMAT>(format, Mesh::ARRAY_FORMAT_TEX_UV2)) {
+            uv2s_writer[set_idx] = buffer->uv2s[lookup_idx];
+        }
+    }
+
+    /**
+     * Indexed counterpart to fill. Each vertex of the buffer is only written out
+     * once and then shared through the index array, so faces that shared a vertex
+     * in the source surface keep sharing it. Vertexes that no face refers to are
+     * never written, so each half only carries what it uses
+    */
+    template <uint32_t FORMAT = VertexFormat::DYNAMIC>
+    _FORCE_INLINE_ void fill_indexed(int lookup_idx) {
+        int set_idx = remap[lookup_idx];
+
+        if (set_idx < 0) {
+            set_idx = vertex_count++;
+            remap[lookup_idx] = set_idx;
+            fill<FORMAT>(lookup_idx, set_idx);
         }
+
+        indices_writer[index_count++] = set_idx;
     }
 
     /**
-     * Adds the vertex information read from the "fill" as a new surface
-     * of the passed in mesh and sets the passed in material to the new
-     * surface
+     * Packs the vertex information read from the "fill" into the vertex
+     * arrays Godot expects for a new surface. Doesn't touch the engine
+     * itself, so it's fine to call off the main thread
     */
-    void add_to_mesh(ArrayMesh &mesh, Ref<Material> material) {
+    Array get_arrays() {
+        if (indexed) {
+            shrink_to(vertex_count);
+            indices.resize(index_count);
+            arrays[Mesh::ARRAY_INDEX] = indices;
+        }
+
         arrays[Mesh::ARRAY_VERTEX] = vertices;
 
         if (has_normals)
             arrays[Mesh::ARRAY_NORMAL] = normals;
-        
+
         if (has_tangents)
             arrays[Mesh::ARRAY_TANGENT] = tangents;
 
@@ -193,18 +251,43 @@ struct SurfaceFiller {
 
         if (has_bones)
             arrays[Mesh::ARRAY_BONES] = bones;
-        
+
         if (has_weights)
             arrays[Mesh::ARRAY_WEIGHTS] = weights;
-        
+
         if (has_uvs)
             arrays[Mesh::ARRAY_TEX_UV] = uvs;
 
         if (has_uv2s)
             arrays[Mesh::ARRAY_TEX_UV2] = uv2s;
 
-        mesh.add_surface_from_arrays(Mesh::PRIMITIVE_TRIANGLES, arrays);
-        mesh.surface_set_material(mesh.get_surface_count() - 1, material);
+        return arrays;
+    }
+
+private:
+    void shrink_to(int length) {
+        vertices.resize(length);
+
+        if (has_normals)
+            normals.resize(length);
+
+        if (has_tangents)
+            tangents.resize(length * 4);
+
+        if (has_colors)
+            colors.resize(length);
+
+        if (has_bones)
+            bones.resize(length * 4);
+
+        if (has_weights)
+            weights.resize(length * 4);
+
+        if (has_uvs)
+            uvs.resize(length);
+
+        if (has_uv2s)
+            uv2s.resize(length);
     }
 };
 
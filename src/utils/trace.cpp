@@ -0,0 +1,134 @@
+#include "trace.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace Trace {
+    struct Event {
+        const char *name;
+        uint64_t start;
+        uint64_t end;
+        int64_t count;
+    };
+
+    // An event as it sits in a ring buffer. Readers can be copying one out while its thread
+    // writes over it, so every field is atomic, see record and write_json
+    struct Slot {
+        std::atomic<const char *> name;
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> end;
+        std::atomic<int64_t> count;
+    };
+
+    struct ThreadBuffer {
+        Slot slots[BUFFER_SIZE];
+
+        // How many events the thread has started and finished writing into the buffer overall,
+        // the next one goes at written % BUFFER_SIZE. Only the owning thread ever changes them
+        std::atomic<uint64_t> started;
+        std::atomic<uint64_t> written;
+
+        uint32_t thread_idx;
+        ThreadBuffer *next;
+    };
+
+    // Every thread that has recorded anything, newest first. Buffers are never freed since
+    // threads can be recording into them right up until the process exits
+    static std::atomic<ThreadBuffer *> buffers(nullptr);
+    static std::atomic<uint32_t> thread_count(0);
+
+    // Events that started before this were cleared
+    static std::atomic<uint64_t> cleared_before(0);
+
+    static thread_local ThreadBuffer *local_buffer = nullptr;
+
+    static ThreadBuffer *create_buffer() {
+        ThreadBuffer *buffer = new ThreadBuffer;
+        buffer->started = 0;
+        buffer->written = 0;
+        buffer->thread_idx = thread_count++;
+
+        buffer->next = buffers.load();
+        while (!buffers.compare_exchange_weak(buffer->next, buffer)) {
+        }
+
+        return buffer;
+    }
+
+    void record(const char *name, uint64_t start, uint64_t end, int64_t count) {
+        if (!local_buffer) {
+            local_buffer = create_buffer();
+        }
+
+        // Works like a seqlock. started moves on before the slot gets touched, so a reader that
+        // sees it past the slot after copying the slot out knows the copy might be torn, and
+        // written only moves on once the event is in
+        uint64_t written = local_buffer->written.load(std::memory_order_relaxed);
+        local_buffer->started.store(written + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Slot &slot = local_buffer->slots[written % BUFFER_SIZE];
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.start.store(start, std::memory_order_relaxed);
+        slot.end.store(end, std::memory_order_relaxed);
+        slot.count.store(count, std::memory_order_relaxed);
+
+        local_buffer->written.store(written + 1, std::memory_order_release);
+    }
+
+    void clear() {
+        cleared_before = SliceTimings::now_usec();
+    }
+
+    static void append_event(std::string &r_json, const Event &event, uint32_t thread_idx, bool &first) {
+        char line[256];
+        if (event.count >= 0) {
+            snprintf(line, sizeof(line), "%s\n{\"name\":\"%s\",\"cat\":\"slicer\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%" PRIu64 ",\"dur\":%" PRIu64 ",\"args\":{\"count\":%" PRId64 "}}",
+                    first ? "" : ",", event.name, thread_idx, event.start, event.end - event.start, event.count);
+        } else {
+            snprintf(line, sizeof(line), "%s\n{\"name\":\"%s\",\"cat\":\"slicer\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%" PRIu64 ",\"dur\":%" PRIu64 "}",
+                    first ? "" : ",", event.name, thread_idx, event.start, event.end - event.start);
+        }
+
+        r_json += line;
+        first = false;
+    }
+
+    void write_json(std::string &r_json) {
+        r_json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        uint64_t since = cleared_before;
+
+        for (ThreadBuffer *buffer = buffers.load(); buffer; buffer = buffer->next) {
+            char line[128];
+            snprintf(line, sizeof(line), "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"Slicer thread %u\"}}",
+                    first ? "" : ",", buffer->thread_idx, buffer->thread_idx);
+            r_json += line;
+            first = false;
+
+            uint64_t written = buffer->written.load(std::memory_order_acquire);
+            uint64_t oldest = written > BUFFER_SIZE ? written - BUFFER_SIZE : 0;
+
+            for (uint64_t i = oldest; i < written; i++) {
+                const Slot &slot = buffer->slots[i % BUFFER_SIZE];
+                Event event;
+                event.name = slot.name.load(std::memory_order_relaxed);
+                event.start = slot.start.load(std::memory_order_relaxed);
+                event.end = slot.end.load(std::memory_order_relaxed);
+                event.count = slot.count.load(std::memory_order_relaxed);
+
+                // The thread kept going while we were copying, and has started writing over this one
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (buffer->started.load(std::memory_order_relaxed) - i > BUFFER_SIZE) {
+                    continue;
+                }
+
+                if (event.start >= since) {
+                    append_event(r_json, event, buffer->thread_idx, first);
+                }
+            }
+        }
+
+        r_json += "\n]}\n";
+    }
+} // Trace
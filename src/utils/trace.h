@@ -0,0 +1,69 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <string>
+
+#include "slice_timings.h"
+
+/**
+ * A timeline of where slicing spent its time on every thread, for reading in chrome://tracing
+ * or Perfetto next to whatever else was going on. Only built in with SLICER_TRACE (trace=yes in
+ * SConstruct), otherwise the TRACE_ZONE macros below compile to nothing.
+ *
+ * Each thread records into a ring buffer of its own, so recording never takes a lock or waits
+ * on another thread. Once a thread has recorded more than BUFFER_SIZE zones the oldest ones
+ * get written over, so a dump holds the last stretch of work on each thread
+*/
+namespace Trace {
+    const uint32_t BUFFER_SIZE = 1 << 14;
+
+    /**
+     * Records a zone on the calling thread. name needs to outlive the trace, a string literal
+     * is what it's meant for. count is shown alongside the zone unless it's negative
+    */
+    void record(const char *name, uint64_t start, uint64_t end, int64_t count = -1);
+
+    /**
+     * Writes everything recorded since the last clear, on every thread, as Chrome's trace
+     * event JSON. Zones that get written over while this reads them are left out
+    */
+    void write_json(std::string &r_json);
+
+    /**
+     * Drops everything recorded so far. Threads can keep recording while this happens
+    */
+    void clear();
+
+    /**
+     * Records the time from its construction to the end of its scope
+    */
+    struct Zone {
+        const char *name;
+        int64_t count;
+        uint64_t start;
+
+        Zone(const char *p_name, int64_t p_count = -1) :
+                name(p_name), count(p_count), start(SliceTimings::now_usec()) {}
+
+        ~Zone() {
+            record(name, start, SliceTimings::now_usec(), count);
+        }
+    };
+} // Trace
+
+#ifdef SLICER_TRACE
+#define TRACE_CONCAT_INNER(m_a, m_b) m_a##m_b
+#define TRACE_CONCAT(m_a, m_b) TRACE_CONCAT_INNER(m_a, m_b)
+
+// Times the rest of the enclosing scope
+#define TRACE_ZONE(m_name) Trace::Zone TRACE_CONCAT(trace_zone_, __LINE__)(m_name)
+
+// Same as TRACE_ZONE, showing how many faces, vertexes or the like the zone went through
+#define TRACE_ZONE_COUNT(m_name, m_count) Trace::Zone TRACE_CONCAT(trace_zone_, __LINE__)(m_name, m_count)
+#else
+#define TRACE_ZONE(m_name)
+#define TRACE_ZONE_COUNT(m_name, m_count)
+#endif
+
+#endif // TRACE_H
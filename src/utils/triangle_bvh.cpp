@@ -0,0 +1,126 @@
+#include "triangle_bvh.h"
+
+/**
+ * A face along with where its centroid falls on the Morton curve
+*/
+struct MortonFace {
+    uint32_t code;
+    int face;
+
+    struct Comparator {
+        _FORCE_INLINE_ bool operator()(const MortonFace &a, const MortonFace &b) const {
+            // Ties are broken by face so the order never depends on the sort
+            return a.code != b.code ? a.code < b.code : a.face < b.face;
+        }
+    };
+};
+
+/**
+ * Spreads the lower 10 bits of v out so there's two zero bits between each of them
+*/
+_FORCE_INLINE_ uint32_t spread_bits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+/**
+ * Interleaves the bits of the point's position within bounds, 10 bits per axis
+*/
+_FORCE_INLINE_ uint32_t morton_code(const Vector3 &point, const AABB &bounds) {
+    uint32_t code = 0;
+
+    for (int axis = 0; axis < 3; axis++) {
+        real_t extent = bounds.size[axis];
+        real_t t = extent > CMP_EPSILON ? (point[axis] - bounds.position[axis]) / extent : 0;
+        uint32_t cell = (uint32_t)CLAMP(t * 1023, 0, 1023);
+        code |= spread_bits(cell) << (2 - axis);
+    }
+
+    return code;
+}
+
+void TriangleBVH::build(const MeshBuffer &surface) {
+    nodes.clear();
+    faces.clear();
+    indices.clear();
+
+    int face_count = surface.face_count();
+    if (face_count == 0) {
+        return;
+    }
+
+    LocalVector<Vector3> centroids;
+    centroids.resize(face_count);
+
+    AABB centroid_bounds;
+    for (int i = 0; i < face_count; i++) {
+        const Vector3 &a = surface.vertices[surface.indices[i * 3]];
+        const Vector3 &b = surface.vertices[surface.indices[i * 3 + 1]];
+        const Vector3 &c = surface.vertices[surface.indices[i * 3 + 2]];
+        centroids[i] = (a + b + c) / 3.0;
+
+        if (i == 0) {
+            centroid_bounds = AABB(centroids[i], Vector3());
+        } else {
+            centroid_bounds.expand_to(centroids[i]);
+        }
+    }
+
+    LocalVector<MortonFace> sorted;
+    sorted.resize(face_count);
+    for (int i = 0; i < face_count; i++) {
+        sorted[i].code = morton_code(centroids[i], centroid_bounds);
+        sorted[i].face = i;
+    }
+    sorted.sort_custom<MortonFace::Comparator>();
+
+    faces.resize(face_count);
+    indices.resize(face_count * 3);
+    for (int i = 0; i < face_count; i++) {
+        int face = sorted[i].face;
+        faces[i] = face;
+        indices[i * 3] = surface.indices[face * 3];
+        indices[i * 3 + 1] = surface.indices[face * 3 + 1];
+        indices[i * 3 + 2] = surface.indices[face * 3 + 2];
+    }
+
+    // Splitting every node's run of faces down the middle keeps the tree balanced, and
+    // since the faces are in Morton order each half is still a compact chunk of space
+    Node root = { AABB(), 0, face_count, -1 };
+    nodes.push_back(root);
+
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        int start = nodes[i].start;
+        int end = nodes[i].end;
+        if (end - start <= LEAF_SIZE) {
+            continue;
+        }
+
+        int middle = (start + end) / 2;
+        nodes[i].children = nodes.size();
+
+        Node left = { AABB(), start, middle, -1 };
+        Node right = { AABB(), middle, end, -1 };
+        nodes.push_back(left);
+        nodes.push_back(right);
+    }
+
+    // Children come after their parents, so going backwards every node's children
+    // already have their bounds by the time we get to it
+    for (int i = nodes.size() - 1; i >= 0; i--) {
+        Node &node = nodes[i];
+
+        if (node.children != -1) {
+            node.bounds = nodes[node.children].bounds.merge(nodes[node.children + 1].bounds);
+            continue;
+        }
+
+        node.bounds = AABB(surface.vertices[indices[node.start * 3]], Vector3());
+        for (int j = node.start * 3; j < node.end * 3; j++) {
+            node.bounds.expand_to(surface.vertices[indices[j]]);
+        }
+    }
+}
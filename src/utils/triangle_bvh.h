@@ -0,0 +1,54 @@
+#ifndef TRIANGLE_BVH_H
+#define TRIANGLE_BVH_H
+
+#include "mesh_buffer.h"
+
+/**
+ * Bounding volume hierarchy over the faces of a MeshBuffer, so a plane can find the
+ * handful of faces it actually crosses without looking at every single one of them.
+ * Faces are sorted along a Morton curve through their centroids, which keeps faces
+ * that are close together in space next to each other, and every node covers a
+ * contiguous run of them. A whole subtree can then be handed out as a single block
+*/
+struct TriangleBVH {
+    // Nodes covering this many faces or less don't get split any further
+    static const int LEAF_SIZE = 16;
+
+    struct Node {
+        AABB bounds;
+
+        // The run of faces, in Morton order, this node covers
+        int start;
+        int end;
+
+        // The left child, with the right one right after it. -1 for leaves
+        int children;
+    };
+
+    // The root is the first node. Children always come after their parent
+    LocalVector<Node> nodes;
+
+    // The index of every face of the surface in Morton order, along with their three
+    // vertex indices in the same order
+    LocalVector<int> faces;
+    LocalVector<int> indices;
+
+    /**
+     * Builds the hierarchy over the faces of surface. The surface's faces are left
+     * alone, the BVH only refers back to them
+    */
+    void build(const MeshBuffer &surface);
+
+    _FORCE_INLINE_ bool is_empty() const {
+        return nodes.size() == 0;
+    }
+
+    /**
+     * Roughly how many bytes the hierarchy takes up
+    */
+    int64_t memory_usage() const {
+        return (int64_t)nodes.size() * sizeof(Node) + faces.size() * sizeof(int) + indices.size() * sizeof(int);
+    }
+};
+
+#endif // TRIANGLE_BVH_H
@@ -1,73 +1,193 @@
 #include "triangulator.h"
+#include "trace.h"
 #include <limits>
 #include <algorithm>
 
-/**
- * Represents a 3D Vertex which has been mapped onto a 2D surface
- * and is used in monotone_chain to triangulate a set of vertices
- * against a flat plane.
- */
-struct Mapped2D {
-    Vector3 original;
-    Vector2 mapped;
+namespace Triangulator {
+    real_t tri_area_2d(real_t x1, real_t y1, real_t x2, real_t y2, real_t x3, real_t y3) {
+        return (x1 - x2) * (y2 - y3) - (x2 - x3) * (y1 - y2);
+    }
 
-    Mapped2D() {}
+    /**
+     * The axes, along the plane, that points on it get mapped onto
+    */
+    _FORCE_INLINE_ void plane_basis(Vector3 plane_normal, Vector3 &r_u, Vector3 &r_v) {
+        r_u = plane_normal.cross(Vector3( 0, 1, 0 )).normalized();
+        if (r_u == Vector3(0, 0, 0)) {
+            r_u = plane_normal.cross(Vector3(0, 0, -1)).normalized();
+        }
+        r_v = r_u.cross(plane_normal);
+    }
 
-    Mapped2D(Vector3 newOriginal, Vector3 u, Vector3 v) {
-        original = newOriginal;
-        mapped = Vector2(newOriginal.dot(u), newOriginal.dot(v));
+    /**
+     * Caps are flat, with their UVs running along u and v, so every one of their vertexes gets
+     * the same tangent. Same as calling MeshBuffer::compute_tangents on every face, only once
+    */
+    void set_flat_tangents(Vector3 plane_normal, Vector3 u, Vector3 v, MeshBuffer &result) {
+        real_t handedness = plane_normal.cross(u).dot(v) < 0.0f ? -1.0f : 1.0f;
+        SlicerVector4 tangent(u.x, u.y, u.z, handedness);
+
+        result.format |= Mesh::ARRAY_FORMAT_TANGENT;
+        result.tangents.resize(result.vertex_count());
+        for (int i = 0; i < result.vertex_count(); i++) {
+            result.tangents[i] = tangent;
+        }
     }
 
-    struct Comparator {
-        _FORCE_INLINE_ bool operator()(const Mapped2D &a, const Mapped2D &b) const {
-            Vector2 x = a.mapped;
-            Vector2 p = b.mapped;
+    /**
+     * Sorts the keys, carrying the values along with them, with an LSD radix sort a byte at a
+     * time. Any byte that's the same for every key doesn't need a pass, which for keys packed
+     * from two coordinates of a small cut is most of them
+    */
+    void radix_sort(LocalVector<uint64_t> &keys, LocalVector<uint32_t> &values, LocalVector<uint64_t> &key_scratch, LocalVector<uint32_t> &value_scratch) {
+        uint32_t count = keys.size();
+        key_scratch.resize(count);
+        value_scratch.resize(count);
+
+        uint32_t histograms[8][256] = {};
+        for (uint32_t i = 0; i < count; i++) {
+            for (int pass = 0; pass < 8; pass++) {
+                histograms[pass][(keys[i] >> (pass * 8)) & 0xFF]++;
+            }
+        }
 
-            if (x.x != p.x) {
-                return x.x < p.x;
-            } else {
-                 return x.y < p.y;
+        uint64_t *keys_from = keys.ptr();
+        uint64_t *keys_to = key_scratch.ptr();
+        uint32_t *values_from = values.ptr();
+        uint32_t *values_to = value_scratch.ptr();
+
+        for (int pass = 0; pass < 8; pass++) {
+            uint32_t *histogram = histograms[pass];
+            int shift = pass * 8;
+
+            if (histogram[(keys_from[0] >> shift) & 0xFF] == count) {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (int i = 0; i < 256; i++) {
+                uint32_t bucket_count = histogram[i];
+                histogram[i] = offset;
+                offset += bucket_count;
+            }
+
+            for (uint32_t i = 0; i < count; i++) {
+                uint32_t slot = histogram[(keys_from[i] >> shift) & 0xFF]++;
+                keys_to[slot] = keys_from[i];
+                values_to[slot] = values_from[i];
             }
+
+            SWAP(keys_from, keys_to);
+            SWAP(values_from, values_to);
         }
-    };
-};
 
-namespace Triangulator {
-    real_t tri_area_2d(real_t x1, real_t y1, real_t x2, real_t y2, real_t x3, real_t y3) {
-        return (x1 - x2) * (y2 - y3) - (x2 - x3) * (y1 - y2);
+        if (keys_from != keys.ptr()) {
+            memcpy(keys.ptr(), keys_from, count * sizeof(uint64_t));
+            memcpy(values.ptr(), values_from, count * sizeof(uint32_t));
+        }
+    }
+
+    // Points of a cut closer together than this fraction of its width are taken to be the same point
+    const double CAP_POINT_SNAP = 0.00001;
+
+    // Nor can points be told apart any closer than this fraction of how far they are from the
+    // origin, which is about as close as a few rounding errors in their positions can add up to
+    const double CAP_POINT_PRECISION = 0.000001;
+
+    /**
+     * How close together points of a cut spanning min to max on the plane, at most magnitude
+     * away from the origin along any axis, are taken to be the same point. Scales with the cut,
+     * so the points of small ones don't all get merged together
+    */
+    _FORCE_INLINE_ double cap_point_snap(Vector2 min, Vector2 max, real_t magnitude) {
+        double extent = MAX((double)max.x - min.x, (double)max.y - min.y);
+        return MAX(extent * CAP_POINT_SNAP, magnitude * CAP_POINT_PRECISION);
+    }
+
+    _FORCE_INLINE_ real_t largest_axis(Vector3 point) {
+        return MAX(MAX(Math::abs(point.x), Math::abs(point.y)), Math::abs(point.z));
+    }
+
+    /**
+     * Writes the points to r_sorted ordered by x and then y, the way monotone_chain needs them,
+     * keeping only one of any points that fall within the same snap sized cell. Returns how
+     * many points were kept
+    */
+    int sort_unique(const LocalVector<Mapped2D> &points, real_t min_x, real_t min_y, real_t max_x, real_t max_y, double snap, Workspace &workspace, LocalVector<Mapped2D> &r_sorted) {
+        int count = points.size();
+
+        // Each coordinate gets 32 bits of the key, x above y, so sorting the keys sorts the points.
+        // The cells only get any bigger than snap for cuts too wide to fit otherwise
+        double extent = MAX((double)max_x - min_x, (double)max_y - min_y);
+        double inv_cell = 1.0 / MAX(snap, extent / (double)UINT32_MAX);
+
+        LocalVector<uint64_t> &keys = workspace.keys;
+        LocalVector<uint32_t> &order = workspace.order;
+        keys.resize(count);
+        order.resize(count);
+
+        for (int i = 0; i < count; i++) {
+            Vector2 point = points[i].mapped;
+            uint64_t x = (uint64_t)(((double)point.x - min_x) * inv_cell);
+            uint64_t y = (uint64_t)(((double)point.y - min_y) * inv_cell);
+
+            keys[i] = (MIN(x, (uint64_t)UINT32_MAX) << 32) | MIN(y, (uint64_t)UINT32_MAX);
+            order[i] = i;
+        }
+
+        radix_sort(keys, order, workspace.key_scratch, workspace.order_scratch);
+
+        r_sorted.resize(count);
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (i > 0 && keys[i] == keys[i - 1]) {
+                continue;
+            }
+
+            r_sorted[kept++] = points[order[i]];
+        }
+
+        return kept;
     }
     
     // Godot has a QuickHull function (along with VHACD bindings which I'm sure has all kind of crazy smart stuff in it)
     // But as this is primarily a learning exercise (and because monotone chain has a slightly different time complexity
     // and our need to support uv mappings and such) let's try to implement this ourselves (or, more accurately, copy
     // it over from Ezy-Slice)
-    Vector<SlicerFace> monotone_chain(const PackedVector3Array &interception_points, Vector3 plane_normal) {
+    MeshBuffer monotone_chain(const LocalVector<Vector3> &interception_points, Vector3 plane_normal) {
+        MeshBuffer result;
+        Workspace workspace;
+        monotone_chain(interception_points, plane_normal, workspace, result);
+        return result;
+    }
+
+    void monotone_chain(const LocalVector<Vector3> &interception_points, Vector3 plane_normal, Workspace &workspace, MeshBuffer &result) {
         // We'll be using the monotone_chain algorithm to try to get a convex hull from our assortment of
         // interception_points along our plane
 
+        TRACE_ZONE_COUNT("monotone_chain", interception_points.size());
         int count = interception_points.size();
-        Vector<SlicerFace> result;
+        result.clear();
 
         if (count < 3) {
-            return result;
+            return;
         }
 
         // First we map from 3D points into a 2D plane represented by the normal we used to cut our mesh
-        Vector3 u = plane_normal.cross(Vector3( 0, 1, 0 )).normalized();
-        if (u == Vector3(0, 0, 0)) {
-            u = plane_normal.cross(Vector3(0, 0, -1)).normalized();
-        }
-        Vector3 v = u.cross(plane_normal);
+        Vector3 u;
+        Vector3 v;
+        plane_basis(plane_normal, u, v);
 
         // Generate an array of mapped values
-        Vector<Mapped2D> mapped;
-        mapped.resize(count);
+        LocalVector<Mapped2D> &unsorted = workspace.unsorted;
+        unsorted.resize(count);
 
         // These values will be used to generate new UV coordinates later on
-        real_t max_div_x = std::numeric_limits<real_t>::min() ;
-        real_t max_div_y = std::numeric_limits<real_t>::min() ;
+        real_t max_div_x = std::numeric_limits<real_t>::lowest() ;
+        real_t max_div_y = std::numeric_limits<real_t>::lowest() ;
         real_t min_div_x = std::numeric_limits<real_t>::max() ;
         real_t min_div_y = std::numeric_limits<real_t>::max() ;
+        real_t magnitude = 0;
 
         // Map the 3D vertices into the 2D mapped values
         for (int i = 0; i < count; i++) {
@@ -80,17 +200,27 @@ namespace Triangulator {
             max_div_y = std::max(max_div_y, map_val.y);
             min_div_x = std::min(min_div_x, map_val.x);
             min_div_y = std::min(min_div_y, map_val.y);
+            magnitude = MAX(magnitude, largest_axis(vert_to_add));
 
-            mapped.set(i, new_mapped_value);
+            unsorted[i] = new_mapped_value;
         }
 
-        // Sort our newly generated array values
-        mapped.sort_custom<Mapped2D::Comparator>();
+        // Sort our newly generated array values. Every crossed edge is shared by two faces so
+        // most points show up twice, which the sort lines up next to each other to be dropped
+        LocalVector<Mapped2D> &mapped = workspace.mapped;
+        double snap = cap_point_snap(Vector2(min_div_x, min_div_y), Vector2(max_div_x, max_div_y), magnitude);
+        count = sort_unique(unsorted, min_div_x, min_div_y, max_div_x, max_div_y, snap, workspace, mapped);
+
+        if (count < 3) {
+            return;
+        }
 
-        // Our final hull mappings will end up in here
-        Vector<Mapped2D> hulls;
-        hulls.resize(count + 1);
-        Mapped2D *hulls_writer = hulls.ptrw();
+        // Our final hull mappings will end up in here. A convex hull never has more than count + 1
+        // points, but with thousands of nearly collinear points around a fine cut the orientation
+        // tests can disagree with each other, so leave room for both chains in full
+        LocalVector<Mapped2D> &hulls = workspace.hulls;
+        hulls.resize(count * 2);
+        Mapped2D *hulls_writer = hulls.ptr();
 
         int k = 0;
 
@@ -135,53 +265,401 @@ namespace Triangulator {
 
         // This should not happen, but here just in case
         if (vert_count < 3) {
-            return result;
+            return;
         }
 
-        result.resize(tri_count / 3);
-        SlicerFace *result_writer = result.ptrw();
+        result.format = Mesh::ARRAY_FORMAT_NORMAL | Mesh::ARRAY_FORMAT_TEX_UV;
+        result.resize_vertices(vert_count);
+        result.indices.resize(tri_count);
 
         float width = max_div_x - min_div_x;
         float height = max_div_y - min_div_y;
 
+        // Generate both the vertices and uv's in this loop
+        for (int i = 0; i < vert_count; i++) {
+            Vector2 uv = hulls[i].mapped;
+            uv.x = (uv.x - min_div_x) / width;
+            uv.y = (uv.y - min_div_y) / height;
+
+            result.vertices[i] = hulls[i].original;
+
+            // TODO - Ezy-Slice support the ability to map these uv values to a specific region
+            // of the texture for atlasing.
+            result.uvs[i] = uv;
+
+            // The normals is the same for all vertices since the final mesh is completely flat
+            result.normals[i] = plane_normal;
+        }
+
         int index_count = 1;
 
-        // Generate both the vertices and uv's in this loop
         for (int i = 0; i < tri_count; i += 3) {
             // The vertices in our triangle
-            Mapped2D pos_a = hulls[0];
-            Mapped2D pos_b = hulls[index_count];
-            Mapped2D pos_c = hulls[index_count + 1];
+            result.indices[i] = 0;
+            result.indices[i + 1] = index_count;
+            result.indices[i + 2] = index_count + 1;
+
+            index_count++;
+        }
+
+        set_flat_tangents(plane_normal, u, v, result);
+    }
 
-            // Generate UV Maps
-            Vector2 uv_a = pos_a.mapped;
-            Vector2 uv_b = pos_b.mapped;
-            Vector2 uv_c = pos_c.mapped;
+    /**
+     * The id of the point of the cut at point, adding it if there isn't one within inv_snap
+     * of it yet. Points are snapped relative to min, the lowest corner of the cut on the plane
+    */
+    int loop_point_id(Vector3 point, Vector3 u, Vector3 v, Vector2 min, double inv_snap, Workspace &workspace) {
+        Vector2 mapped(point.dot(u), point.dot(v));
 
-            uv_a.x = (uv_a.x - min_div_x) / width;
-            uv_a.y = (uv_a.y - min_div_y) / height;
+        uint64_t x = (uint64_t)Math::round(((double)mapped.x - min.x) * inv_snap);
+        uint64_t y = (uint64_t)Math::round(((double)mapped.y - min.y) * inv_snap);
+        uint64_t key = (MIN(x, (uint64_t)UINT32_MAX) << 32) | MIN(y, (uint64_t)UINT32_MAX);
 
-            uv_b.x = (uv_b.x - min_div_x) / width;
-            uv_b.y = (uv_b.y - min_div_y) / height;
+        const int *existing = workspace.point_ids.getptr(key);
+        if (existing) {
+            return *existing;
+        }
 
-            uv_c.x = (uv_c.x - min_div_x) / width;
-            uv_c.y = (uv_c.y - min_div_y) / height;
+        int id = workspace.loop_points.size();
+        workspace.loop_points.push_back(point);
+        workspace.loop_mapped.push_back(mapped);
+        workspace.point_ids.insert(key, id);
 
-            SlicerFace new_face = SlicerFace(pos_a.original, pos_b.original, pos_c.original);
+        return id;
+    }
 
-            // TODO - Ezy-Slice support the ability to map these uv values to a specific region
-            // of the texture for atlasing.
-            new_face.set_uvs(uv_a, uv_b, uv_c);
+    /**
+     * Chains the segments up into loops, returning false if they don't all close up. r_snap
+     * is set to how close points of the cut had to be to be taken as one, see cap_point_snap
+    */
+    bool chain_loops(const LocalVector<Vector3> &segments, Vector3 u, Vector3 v, Workspace &workspace, double &r_snap) {
+        workspace.point_ids.clear();
+        workspace.loop_points.clear();
+        workspace.loop_mapped.clear();
+        workspace.edges.clear();
+        workspace.edge_ends.clear();
+        workspace.loop_ids.clear();
+        workspace.loops.clear();
+
+        if (segments.size() == 0) {
+            return false;
+        }
 
-            // The normals is the same for all vertices since the final mesh is completely flat
-            new_face.set_normals(plane_normal, plane_normal, plane_normal);
-            new_face.compute_tangents();
+        Vector2 min(segments[0].dot(u), segments[0].dot(v));
+        Vector2 max = min;
+        real_t magnitude = 0;
+        for (uint32_t i = 0; i < segments.size(); i++) {
+            Vector2 mapped(segments[i].dot(u), segments[i].dot(v));
+            min = min.min(mapped);
+            max = max.max(mapped);
+            magnitude = MAX(magnitude, largest_axis(segments[i]));
+        }
 
-            result_writer[i / 3] = new_face;
+        // The cells only get any bigger than the snap for cuts too wide to fit otherwise
+        r_snap = cap_point_snap(min, max, magnitude);
+        double extent = MAX((double)max.x - min.x, (double)max.y - min.y);
+        double inv_snap = 1.0 / MAX(r_snap, extent / (double)UINT32_MAX);
 
-            index_count++;
+        for (uint32_t i = 0; i + 1 < segments.size(); i += 2) {
+            int a = loop_point_id(segments[i], u, v, min, inv_snap, workspace);
+            int b = loop_point_id(segments[i + 1], u, v, min, inv_snap, workspace);
+            if (a == b) {
+                continue;
+            }
+
+            // A segment showing up twice is where the plane runs along a crease of the mesh
+            // without actually going into it, which isn't part of any loop
+            uint64_t key = ((uint64_t)MIN(a, b) << 32) | (uint32_t)MAX(a, b);
+            if (workspace.edges.has(key)) {
+                workspace.edges.erase(key);
+            } else {
+                workspace.edges.insert(key, 0);
+            }
         }
 
-        return result;
+        if (workspace.edges.size() == 0) {
+            return false;
+        }
+
+        int point_count = workspace.loop_points.size();
+        LocalVector<int> &offsets = workspace.adjacency_offsets;
+        LocalVector<int> &cursors = workspace.adjacency_cursors;
+
+        offsets.resize(point_count + 1);
+        for (int i = 0; i <= point_count; i++) {
+            offsets[i] = 0;
+        }
+
+        for (const IndexMap::Entry &E : workspace.edges) {
+            int a = E.key >> 32;
+            int b = E.key & 0xFFFFFFFF;
+            workspace.edge_ends.push_back(a);
+            workspace.edge_ends.push_back(b);
+            offsets[a + 1]++;
+            offsets[b + 1]++;
+        }
+
+        // Every point of a closed loop has a segment coming in and one going out
+        for (int i = 0; i < point_count; i++) {
+            if (offsets[i + 1] % 2 != 0) {
+                return false;
+            }
+            offsets[i + 1] += offsets[i];
+        }
+
+        int edge_count = workspace.edge_ends.size() / 2;
+        workspace.adjacency.resize(offsets[point_count]);
+        cursors.resize(point_count);
+        for (int i = 0; i < point_count; i++) {
+            cursors[i] = offsets[i];
+        }
+
+        for (int i = 0; i < edge_count; i++) {
+            int a = workspace.edge_ends[i * 2];
+            int b = workspace.edge_ends[i * 2 + 1];
+            workspace.adjacency[cursors[a]++] = i;
+            workspace.adjacency[cursors[b]++] = i;
+        }
+
+        for (int i = 0; i < point_count; i++) {
+            cursors[i] = offsets[i];
+        }
+
+        workspace.edge_used.resize(edge_count);
+        for (int i = 0; i < edge_count; i++) {
+            workspace.edge_used[i] = 0;
+        }
+
+        // Walk from segment to segment until we're back where we started. With every point
+        // having an even number of segments there's always a way out of one we walk into
+        for (int i = 0; i < edge_count; i++) {
+            if (workspace.edge_used[i]) {
+                continue;
+            }
+            workspace.edge_used[i] = 1;
+
+            CapLoop loop;
+            loop.start = workspace.loop_ids.size();
+
+            int first = workspace.edge_ends[i * 2];
+            int current = workspace.edge_ends[i * 2 + 1];
+            workspace.loop_ids.push_back(first);
+
+            while (current != first) {
+                workspace.loop_ids.push_back(current);
+
+                int next_edge = -1;
+                while (cursors[current] < offsets[current + 1]) {
+                    int edge = workspace.adjacency[cursors[current]++];
+                    if (!workspace.edge_used[edge]) {
+                        next_edge = edge;
+                        break;
+                    }
+                }
+
+                if (next_edge == -1) {
+                    return false;
+                }
+
+                workspace.edge_used[next_edge] = 1;
+                int a = workspace.edge_ends[next_edge * 2];
+                current = a == current ? workspace.edge_ends[next_edge * 2 + 1] : a;
+            }
+
+            loop.end = workspace.loop_ids.size();
+            if (loop.end - loop.start < 3) {
+                workspace.loop_ids.resize(loop.start);
+                continue;
+            }
+
+            workspace.loops.push_back(loop);
+        }
+
+        return workspace.loops.size() > 0;
+    }
+
+    bool point_in_loop(Vector2 point, const CapLoop &loop, const Workspace &workspace) {
+        bool inside = false;
+
+        for (int i = loop.start, j = loop.end - 1; i < loop.end; j = i++) {
+            Vector2 a = workspace.loop_mapped[workspace.loop_ids[i]];
+            Vector2 b = workspace.loop_mapped[workspace.loop_ids[j]];
+
+            if ((a.y > point.y) != (b.y > point.y) && point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x) {
+                inside = !inside;
+            }
+        }
+
+        return inside;
+    }
+
+    /**
+     * Works out which loops are outlines and which are holes, by how many others they're inside of
+    */
+    void nest_loops(Workspace &workspace) {
+        LocalVector<CapLoop> &loops = workspace.loops;
+
+        for (uint32_t i = 0; i < loops.size(); i++) {
+            CapLoop &loop = loops[i];
+            loop.area = 0;
+            loop.min = workspace.loop_mapped[workspace.loop_ids[loop.start]];
+            loop.max = loop.min;
+
+            for (int j = loop.start, k = loop.end - 1; j < loop.end; k = j++) {
+                Vector2 a = workspace.loop_mapped[workspace.loop_ids[j]];
+                Vector2 b = workspace.loop_mapped[workspace.loop_ids[k]];
+                loop.area += (b.x - a.x) * (b.y + a.y);
+                loop.min = loop.min.min(a);
+                loop.max = loop.max.max(a);
+            }
+
+            loop.area = Math::abs(loop.area * 0.5f);
+        }
+
+        // Only a bigger loop can contain a smaller one. There's rarely more than a few loops
+        // to a cut so checking each against all the others is fine
+        for (uint32_t i = 0; i < loops.size(); i++) {
+            CapLoop &loop = loops[i];
+            Vector2 probe = workspace.loop_mapped[workspace.loop_ids[loop.start]];
+            loop.depth = 0;
+            loop.parent = -1;
+
+            for (uint32_t j = 0; j < loops.size(); j++) {
+                const CapLoop &other = loops[j];
+                if (j == i || other.area <= loop.area) {
+                    continue;
+                }
+
+                if (probe.x < other.min.x || probe.y < other.min.y || probe.x > other.max.x || probe.y > other.max.y) {
+                    continue;
+                }
+
+                if (point_in_loop(probe, other, workspace)) {
+                    loop.depth++;
+                    if (loop.parent == -1 || other.area < loops[loop.parent].area) {
+                        loop.parent = j;
+                    }
+                }
+            }
+        }
+    }
+
+    _FORCE_INLINE_ void add_to_polygon(const CapLoop &loop, Workspace &workspace) {
+        for (int i = loop.start; i < loop.end; i++) {
+            int id = workspace.loop_ids[i];
+            workspace.polygon.push_back(workspace.loop_mapped[id]);
+            workspace.polygon_ids.push_back(id);
+        }
+    }
+
+    /**
+     * Builds the cap out of the loops of the cut, returning false if they didn't give us any faces
+    */
+    bool fill_loops(const LocalVector<Vector3> &segments, Vector3 plane_normal, Workspace &workspace, MeshBuffer &result) {
+        Vector3 u;
+        Vector3 v;
+        plane_basis(plane_normal, u, v);
+
+        double snap;
+        if (!chain_loops(segments, u, v, workspace, snap)) {
+            return false;
+        }
+
+        nest_loops(workspace);
+
+        // Any loop smaller than the cells points get snapped to is just noise along the cut
+        real_t min_area = snap * snap;
+
+        const LocalVector<CapLoop> &loops = workspace.loops;
+        for (uint32_t i = 0; i < loops.size(); i++) {
+            const CapLoop &outline = loops[i];
+            if (outline.depth % 2 != 0 || outline.area <= min_area) {
+                continue;
+            }
+
+            workspace.polygon.clear();
+            workspace.polygon_ids.clear();
+            workspace.hole_starts.clear();
+            add_to_polygon(outline, workspace);
+
+            for (uint32_t j = 0; j < loops.size(); j++) {
+                if (loops[j].parent == (int)i && loops[j].depth % 2 != 0) {
+                    workspace.hole_starts.push_back(workspace.polygon.size());
+                    add_to_polygon(loops[j], workspace);
+                }
+            }
+
+            workspace.triangles.clear();
+            workspace.ear_clipper.triangulate(workspace.polygon, workspace.hole_starts, workspace.triangles);
+
+            for (uint32_t j = 0; j < workspace.triangles.size(); j++) {
+                result.indices.push_back(workspace.polygon_ids[workspace.triangles[j]]);
+            }
+        }
+
+        if (result.indices.size() == 0) {
+            return false;
+        }
+
+        int point_count = workspace.loop_points.size();
+        result.format = Mesh::ARRAY_FORMAT_NORMAL | Mesh::ARRAY_FORMAT_TEX_UV;
+        result.resize_vertices(point_count);
+
+        Vector2 min = workspace.loop_mapped[0];
+        Vector2 max = min;
+        for (int i = 1; i < point_count; i++) {
+            min = min.min(workspace.loop_mapped[i]);
+            max = max.max(workspace.loop_mapped[i]);
+        }
+
+        Vector2 size = max - min;
+        for (int i = 0; i < point_count; i++) {
+            Vector2 uv = workspace.loop_mapped[i] - min;
+            uv.x = size.x > 0 ? uv.x / size.x : 0;
+            uv.y = size.y > 0 ? uv.y / size.y : 0;
+
+            result.vertices[i] = workspace.loop_points[i];
+            result.uvs[i] = uv;
+            result.normals[i] = plane_normal;
+        }
+
+        set_flat_tangents(plane_normal, u, v, result);
+        return true;
+    }
+
+    void Workspace::track_memory(MemoryTracker &tracker) const {
+        tracker.add(unsorted);
+        tracker.add(mapped);
+        tracker.add(hulls);
+        tracker.add(keys);
+        tracker.add(key_scratch);
+        tracker.add(order);
+        tracker.add(order_scratch);
+        tracker.add(point_ids);
+        tracker.add(loop_points);
+        tracker.add(loop_mapped);
+        tracker.add(edges);
+        tracker.add(edge_ends);
+        tracker.add(edge_used);
+        tracker.add(adjacency_offsets);
+        tracker.add(adjacency_cursors);
+        tracker.add(adjacency);
+        tracker.add(loop_ids);
+        tracker.add(loops);
+        tracker.add(polygon);
+        tracker.add(polygon_ids);
+        tracker.add(hole_starts);
+        tracker.add(triangles);
+        ear_clipper.track_memory(tracker);
+    }
+
+    void cap(const LocalVector<Vector3> &segments, const LocalVector<Vector3> &points, Vector3 plane_normal, Workspace &workspace, MeshBuffer &result) {
+        TRACE_ZONE_COUNT("cap", segments.size() / 2);
+        result.clear();
+
+        if (!fill_loops(segments, plane_normal, workspace, result)) {
+            monotone_chain(points, plane_normal, workspace, result);
+        }
     }
 }
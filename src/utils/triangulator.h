@@ -1,7 +1,26 @@
 #ifndef TRIANGULATOR_H
 #define TRIANGULATOR_H
 
-#include "slicer_face.h"
+#include "ear_clipper.h"
+#include "index_map.h"
+#include "mesh_buffer.h"
+
+/**
+ * Represents a 3D Vertex which has been mapped onto a 2D surface
+ * and is used in monotone_chain to triangulate a set of vertices
+ * against a flat plane.
+ */
+struct Mapped2D {
+    Vector3 original;
+    Vector2 mapped;
+
+    Mapped2D() {}
+
+    Mapped2D(Vector3 newOriginal, Vector3 u, Vector3 v) {
+        original = newOriginal;
+        mapped = Vector2(newOriginal.dot(u), newOriginal.dot(v));
+    }
+};
 
 /**
  * Contains functions related to performing generative
@@ -14,9 +33,83 @@ namespace Triangulator {
     real_t tri_area_2d(real_t x1, real_t y1, real_t x2, real_t y2, real_t x3, real_t y3);
 
     /**
-     * Uses a monotone chain algorithm to generate the faces of a convex hull from a set of points
+     * Uses a monotone chain algorithm to generate the faces of a convex hull from a set of points.
+     * The hull's points become the vertexes of the returned buffer, which carries normals, uvs
+     * and tangents, and its faces fan out from the first of them. Points closer together than a
+     * small fraction of the width of the cut are only counted once
+    */
+    MeshBuffer monotone_chain(const LocalVector<Vector3> &interception_points, Vector3 plane_normal);
+
+    // One closed loop of the cut, see cap
+    struct CapLoop {
+        // The run of Workspace::loop_ids making up the loop
+        int start;
+        int end;
+
+        real_t area;
+        Vector2 min;
+        Vector2 max;
+
+        // How many other loops this one is inside of, and the smallest of them
+        int depth;
+        int parent;
+    };
+
+    /**
+     * The scratch memory of monotone_chain and cap, which can be kept around between calls
+    */
+    struct Workspace {
+        LocalVector<Mapped2D> unsorted;
+        LocalVector<Mapped2D> mapped;
+        LocalVector<Mapped2D> hulls;
+
+        // The quantized positions of the points, radix sorted along with where they came from
+        LocalVector<uint64_t> keys;
+        LocalVector<uint64_t> key_scratch;
+        LocalVector<uint32_t> order;
+        LocalVector<uint32_t> order_scratch;
+
+        // Every distinct point of the cut, by its snapped position on the plane. How close points
+        // get snapped together scales with the cut
+        IndexMap point_ids;
+        LocalVector<Vector3> loop_points;
+        LocalVector<Vector2> loop_mapped;
+
+        // Every segment of the cut, by the ids of its points, and who's next to who
+        IndexMap edges;
+        LocalVector<int> edge_ends;
+        LocalVector<uint8_t> edge_used;
+        LocalVector<int> adjacency_offsets;
+        LocalVector<int> adjacency_cursors;
+        LocalVector<int> adjacency;
+
+        LocalVector<int> loop_ids;
+        LocalVector<CapLoop> loops;
+
+        // One outline along with its holes at a time, as handed to the ear clipper
+        LocalVector<Vector2> polygon;
+        LocalVector<int> polygon_ids;
+        LocalVector<int> hole_starts;
+        LocalVector<int> triangles;
+        EarClipper ear_clipper;
+
+        void track_memory(MemoryTracker &tracker) const;
+    };
+
+    /**
+     * Same as above but builds the hull into result, reusing the memory held by it and
+     * by workspace
+    */
+    void monotone_chain(const LocalVector<Vector3> &interception_points, Vector3 plane_normal, Workspace &workspace, MeshBuffer &result);
+
+    /**
+     * Builds the cross section of a cut into result out of the segments the plane left across the
+     * faces it crossed, two points each. The segments get chained up into closed loops and any
+     * loop inside another becomes a hole in it, so cuts through concave or hollow meshes get capped
+     * properly. The faces are wound the same way as monotone_chain's. If the segments don't close
+     * up, like when the mesh itself has holes, this falls back to monotone_chain over points
     */
-    Vector<SlicerFace> monotone_chain(const PackedVector3Array &interception_points, Vector3 plane_normal);
+    void cap(const LocalVector<Vector3> &segments, const LocalVector<Vector3> &points, Vector3 plane_normal, Workspace &workspace, MeshBuffer &result);
 } // Triangulator
 
 
@@ -0,0 +1,66 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include "core_types.h"
+
+/**
+ * Helpers for compiling the per vertex kernels (parsing, interpolating and
+ * serializing) once per attribute format. Kernels take the format as a template
+ * parameter and ask `has<FORMAT>` which streams to touch, which the compiler
+ * folds away entirely for the common formats listed here. Anything else falls
+ * back to the DYNAMIC instantiation, which checks the buffer's format at runtime
+ * the same way the kernels always used to.
+*/
+namespace VertexFormat {
+    enum : uint32_t {
+        POSITION_NORMAL = Mesh::ARRAY_FORMAT_NORMAL,
+        POSITION_NORMAL_UV = Mesh::ARRAY_FORMAT_NORMAL | Mesh::ARRAY_FORMAT_TEX_UV,
+        POSITION_NORMAL_UV_TANGENT = POSITION_NORMAL_UV | Mesh::ARRAY_FORMAT_TANGENT,
+        SKINNED = POSITION_NORMAL_UV | Mesh::ARRAY_FORMAT_BONES | Mesh::ARRAY_FORMAT_WEIGHTS,
+        SKINNED_TANGENT = SKINNED | Mesh::ARRAY_FORMAT_TANGENT,
+
+        // Not an actual format, selects the kernels that look at the format at runtime
+        DYNAMIC = 0xFFFFFFFF,
+    };
+
+    template <uint32_t FORMAT>
+    _FORCE_INLINE_ bool has(uint32_t runtime_format, uint32_t attribute) {
+        return ((FORMAT == DYNAMIC ? runtime_format : FORMAT) & attribute) != 0;
+    }
+
+    /**
+     * Calls kernel.run<FORMAT>() with the instantiation matching the passed in format,
+     * or the DYNAMIC one if there's no specialization for it (or specialized is false,
+     * which is mostly useful for benchmarking the two against each other)
+    */
+    template <class Kernel>
+    void dispatch(uint32_t format, Kernel &kernel, bool specialized = true) {
+        if (!specialized) {
+            kernel.template run<DYNAMIC>();
+            return;
+        }
+
+        switch (format) {
+            case POSITION_NORMAL:
+                kernel.template run<POSITION_NORMAL>();
+                break;
+            case POSITION_NORMAL_UV:
+                kernel.template run<POSITION_NORMAL_UV>();
+                break;
+            case POSITION_NORMAL_UV_TANGENT:
+                kernel.template run<POSITION_NORMAL_UV_TANGENT>();
+                break;
+            case SKINNED:
+                kernel.template run<SKINNED>();
+                break;
+            case SKINNED_TANGENT:
+                kernel.template run<SKINNED_TANGENT>();
+                break;
+            default:
+                kernel.template run<DYNAMIC>();
+                break;
+        }
+    }
+} // VertexFormat
+
+#endif // VERTEX_FORMAT_H
@@ -0,0 +1,85 @@
+#include "counting_allocator.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    // The parallel split allocates from its worker threads
+    std::atomic<uint64_t> allocation_count(0);
+    std::atomic<uint64_t> live(0);
+    std::atomic<uint64_t> peak(0);
+
+    // Every block starts with its size, padded out so what comes after stays aligned
+    const size_t HEADER_SIZE = alignof(std::max_align_t);
+
+    void *allocate(size_t size) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+        char *block = static_cast<char *>(malloc(HEADER_SIZE + size));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        *reinterpret_cast<size_t *>(block) = size;
+
+        uint64_t now = live.fetch_add(size, std::memory_order_relaxed) + size;
+        uint64_t highest = peak.load(std::memory_order_relaxed);
+        while (now > highest && !peak.compare_exchange_weak(highest, now, std::memory_order_relaxed)) {
+        }
+
+        return block + HEADER_SIZE;
+    }
+
+    void deallocate(void *ptr) {
+        if (ptr == nullptr) {
+            return;
+        }
+
+        char *block = static_cast<char *>(ptr) - HEADER_SIZE;
+        live.fetch_sub(*reinterpret_cast<size_t *>(block), std::memory_order_relaxed);
+        free(block);
+    }
+} // namespace
+
+namespace CountingAllocator {
+    uint64_t allocations() {
+        return allocation_count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t live_bytes() {
+        return live.load(std::memory_order_relaxed);
+    }
+
+    uint64_t peak_bytes() {
+        return peak.load(std::memory_order_relaxed);
+    }
+
+    void reset_peak() {
+        peak.store(live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+} // CountingAllocator
+
+void *operator new(size_t size) {
+    return allocate(size);
+}
+
+void *operator new[](size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    deallocate(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    deallocate(ptr);
+}
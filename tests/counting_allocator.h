@@ -0,0 +1,33 @@
+#ifndef COUNTING_ALLOCATOR_H
+#define COUNTING_ALLOCATOR_H
+
+#include <cstdint>
+
+/**
+ * The test program replaces the global operator new and delete with ones that count what
+ * goes through them, so tests can check what the core allocates. Everything the core holds
+ * is in LocalVectors, which allocate through new in the standalone build
+*/
+namespace CountingAllocator {
+    /**
+     * How many times new has been called since the program started
+    */
+    uint64_t allocations();
+
+    /**
+     * Bytes allocated with new and not yet deleted
+    */
+    uint64_t live_bytes();
+
+    /**
+     * The most live_bytes has been since the last reset_peak
+    */
+    uint64_t peak_bytes();
+
+    /**
+     * Starts peak_bytes over from what's live right now
+    */
+    void reset_peak();
+} // CountingAllocator
+
+#endif // COUNTING_ALLOCATOR_H
@@ -0,0 +1,282 @@
+#include "fixtures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace Fixtures {
+    int Mesh::add_vertex(Vector3 position, Vector3 normal, Vector2 uv) {
+        positions.insert(positions.end(), { position.x, position.y, position.z });
+        normals.insert(normals.end(), { normal.x, normal.y, normal.z });
+        uvs.insert(uvs.end(), { uv.x, uv.y });
+        return positions.size() / 3 - 1;
+    }
+
+    void Mesh::add_face(int a, int b, int c) {
+        // Whichever way the face was given, it gets wound clockwise as seen from the side its
+        // vertex normals point to
+        Vector3 pa(positions[a * 3], positions[a * 3 + 1], positions[a * 3 + 2]);
+        Vector3 pb(positions[b * 3], positions[b * 3 + 1], positions[b * 3 + 2]);
+        Vector3 pc(positions[c * 3], positions[c * 3 + 1], positions[c * 3 + 2]);
+        Vector3 normal(normals[a * 3] + normals[b * 3] + normals[c * 3], normals[a * 3 + 1] + normals[b * 3 + 1] + normals[c * 3 + 1], normals[a * 3 + 2] + normals[b * 3 + 2] + normals[c * 3 + 2]);
+
+        if ((pb - pa).cross(pc - pa).dot(normal) > 0) {
+            std::swap(b, c);
+        }
+
+        indices.insert(indices.end(), { a, b, c });
+    }
+
+    SlicerCore::MeshView Mesh::view() const {
+        SlicerCore::MeshView view;
+        view.positions = positions.data();
+        view.normals = normals.data();
+        view.uvs = uvs.data();
+        view.vertex_count = positions.size() / 3;
+        view.indices = indices.data();
+        view.index_count = indices.size();
+        return view;
+    }
+
+    Mesh box(Vector3 size, int subdivisions) {
+        Mesh mesh;
+        Vector3 half = size * 0.5;
+
+        for (int axis = 0; axis < 3; axis++) {
+            for (int sign = -1; sign <= 1; sign += 2) {
+                Vector3 normal;
+                normal[axis] = sign;
+                int u_axis = (axis + 1) % 3;
+                int v_axis = (axis + 2) % 3;
+
+                int first = mesh.positions.size() / 3;
+                for (int i = 0; i <= subdivisions; i++) {
+                    for (int j = 0; j <= subdivisions; j++) {
+                        Vector2 uv(real_t(i) / subdivisions, real_t(j) / subdivisions);
+                        Vector3 position;
+                        position[axis] = half[axis] * sign;
+                        position[u_axis] = -half[u_axis] + size[u_axis] * uv.x;
+                        position[v_axis] = -half[v_axis] + size[v_axis] * uv.y;
+                        mesh.add_vertex(position, normal, uv);
+                    }
+                }
+
+                for (int i = 0; i < subdivisions; i++) {
+                    for (int j = 0; j < subdivisions; j++) {
+                        int a = first + i * (subdivisions + 1) + j;
+                        int b = a + subdivisions + 1;
+                        mesh.add_face(a, b, b + 1);
+                        mesh.add_face(a, b + 1, a + 1);
+                    }
+                }
+            }
+        }
+
+        return mesh;
+    }
+
+    Mesh torus(real_t radius, real_t tube_radius, int rings, int sides) {
+        Mesh mesh;
+
+        for (int i = 0; i < rings; i++) {
+            double around = 2 * Math_PI * i / rings;
+            Vector3 direction(std::sin(around), 0, std::cos(around));
+
+            for (int j = 0; j < sides; j++) {
+                double along = 2 * Math_PI * j / sides;
+                Vector3 normal = direction * std::cos(along) + Vector3(0, std::sin(along), 0);
+                mesh.add_vertex(direction * radius + normal * tube_radius, normal, Vector2(real_t(i) / rings, real_t(j) / sides));
+            }
+        }
+
+        for (int i = 0; i < rings; i++) {
+            for (int j = 0; j < sides; j++) {
+                int a = i * sides + j;
+                int b = ((i + 1) % rings) * sides + j;
+                int c = ((i + 1) % rings) * sides + (j + 1) % sides;
+                int d = i * sides + (j + 1) % sides;
+                mesh.add_face(a, b, c);
+                mesh.add_face(a, c, d);
+            }
+        }
+
+        return mesh;
+    }
+
+    Mesh l_beam(real_t length) {
+        // Counterclockwise around the L, centered on the origin
+        const Vector2 outline[6] = {
+            Vector2(-1, -1.5), Vector2(1, -1.5), Vector2(1, -0.5), Vector2(0, -0.5), Vector2(0, 1.5), Vector2(-1, 1.5),
+        };
+        const int end_faces[4][3] = { { 0, 1, 2 }, { 0, 2, 3 }, { 0, 3, 4 }, { 0, 4, 5 } };
+
+        Mesh mesh;
+        for (int side = -1; side <= 1; side += 2) {
+            int first = mesh.positions.size() / 3;
+            for (int i = 0; i < 6; i++) {
+                mesh.add_vertex(Vector3(outline[i].x, outline[i].y, length * 0.5 * side), Vector3(0, 0, side), outline[i]);
+            }
+            for (int i = 0; i < 4; i++) {
+                mesh.add_face(first + end_faces[i][0], first + end_faces[i][1], first + end_faces[i][2]);
+            }
+        }
+
+        for (int i = 0; i < 6; i++) {
+            Vector2 from = outline[i];
+            Vector2 to = outline[(i + 1) % 6];
+            Vector3 normal = Vector3(to.y - from.y, from.x - to.x, 0).normalized();
+
+            int a = mesh.add_vertex(Vector3(from.x, from.y, -length * 0.5), normal, Vector2(0, 0));
+            int b = mesh.add_vertex(Vector3(to.x, to.y, -length * 0.5), normal, Vector2(1, 0));
+            int c = mesh.add_vertex(Vector3(to.x, to.y, length * 0.5), normal, Vector2(1, 1));
+            int d = mesh.add_vertex(Vector3(from.x, from.y, length * 0.5), normal, Vector2(0, 1));
+            mesh.add_face(a, b, c);
+            mesh.add_face(a, c, d);
+        }
+
+        return mesh;
+    }
+
+    Mesh icosphere(int subdivisions) {
+        const real_t t = (1.0 + std::sqrt(5.0)) / 2.0;
+        std::vector<Vector3> points = {
+            Vector3(-1, t, 0), Vector3(1, t, 0), Vector3(-1, -t, 0), Vector3(1, -t, 0),
+            Vector3(0, -1, t), Vector3(0, 1, t), Vector3(0, -1, -t), Vector3(0, 1, -t),
+            Vector3(t, 0, -1), Vector3(t, 0, 1), Vector3(-t, 0, -1), Vector3(-t, 0, 1),
+        };
+        std::vector<int> faces = {
+            0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+            1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+            3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+            4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+        };
+
+        for (int level = 0; level < subdivisions; level++) {
+            std::map<std::pair<int, int>, int> midpoints;
+            auto midpoint = [&](int a, int b) {
+                std::pair<int, int> key(std::min(a, b), std::max(a, b));
+                auto found = midpoints.find(key);
+                if (found != midpoints.end()) {
+                    return found->second;
+                }
+                points.push_back((points[a] + points[b]) * 0.5);
+                midpoints[key] = points.size() - 1;
+                return (int)points.size() - 1;
+            };
+
+            std::vector<int> subdivided;
+            for (size_t i = 0; i < faces.size(); i += 3) {
+                int a = faces[i];
+                int b = faces[i + 1];
+                int c = faces[i + 2];
+                int ab = midpoint(a, b);
+                int bc = midpoint(b, c);
+                int ca = midpoint(c, a);
+                subdivided.insert(subdivided.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+            }
+            faces.swap(subdivided);
+        }
+
+        Mesh mesh;
+        for (const Vector3 &point : points) {
+            Vector3 normal = point.normalized();
+            mesh.add_vertex(normal, normal, Vector2(0.5 + std::atan2(normal.z, normal.x) / (2 * Math_PI), 0.5 - std::asin(normal.y) / Math_PI));
+        }
+        for (size_t i = 0; i < faces.size(); i += 3) {
+            mesh.add_face(faces[i], faces[i + 1], faces[i + 2]);
+        }
+
+        return mesh;
+    }
+
+    _FORCE_INLINE_ Vector3 position_of(const SlicerCore::MeshView &mesh, int idx) {
+        return Vector3(mesh.positions[idx * 3], mesh.positions[idx * 3 + 1], mesh.positions[idx * 3 + 2]);
+    }
+
+    _FORCE_INLINE_ int index_of(const SlicerCore::MeshView &mesh, int corner) {
+        return mesh.indices ? mesh.indices[corner] : corner;
+    }
+
+    _FORCE_INLINE_ int corner_count(const SlicerCore::MeshView &mesh) {
+        return mesh.indices ? mesh.index_count : mesh.vertex_count;
+    }
+
+    double volume(const SlicerCore::MeshView &mesh) {
+        double total = 0;
+        for (int i = 0; i + 2 < corner_count(mesh); i += 3) {
+            Vector3 a = position_of(mesh, index_of(mesh, i));
+            Vector3 b = position_of(mesh, index_of(mesh, i + 1));
+            Vector3 c = position_of(mesh, index_of(mesh, i + 2));
+            total += a.dot(b.cross(c)) / 6.0;
+        }
+        return total;
+    }
+
+    double volume(const SlicerCore::HalfView &half) {
+        return volume(half.surface) + volume(half.cap);
+    }
+
+    int open_edges(const SlicerCore::HalfView &half) {
+        const SlicerCore::MeshView *parts[2] = { &half.surface, &half.cap };
+
+        // Every vertex of both parts gets the id of the first one at the same spot. Sorting
+        // along x keeps the search for those down to a narrow band
+        std::vector<Vector3> points;
+        for (const SlicerCore::MeshView *part : parts) {
+            for (int i = 0; i < part->vertex_count; i++) {
+                points.push_back(position_of(*part, i));
+            }
+        }
+
+        std::vector<int> order(points.size());
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return points[a].x < points[b].x; });
+
+        const real_t tolerance = 1e-4;
+        std::vector<int> ids(points.size(), -1);
+        for (size_t i = 0; i < order.size(); i++) {
+            int point = order[i];
+            if (ids[point] != -1) {
+                continue;
+            }
+
+            ids[point] = point;
+            for (size_t j = i + 1; j < order.size() && points[order[j]].x - points[point].x <= tolerance; j++) {
+                if (ids[order[j]] == -1 && (points[order[j]] - points[point]).length() <= tolerance) {
+                    ids[order[j]] = point;
+                }
+            }
+        }
+
+        std::map<std::pair<int, int>, int> edges;
+        int offset = 0;
+        for (const SlicerCore::MeshView *part : parts) {
+            for (int i = 0; i + 2 < corner_count(*part); i += 3) {
+                int corners[3];
+                for (int j = 0; j < 3; j++) {
+                    corners[j] = ids[offset + index_of(*part, i + j)];
+                }
+
+                // Slivers that collapse onto a line or a point don't enclose anything
+                if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0]) {
+                    continue;
+                }
+
+                for (int j = 0; j < 3; j++) {
+                    edges[std::make_pair(corners[j], corners[(j + 1) % 3])]++;
+                }
+            }
+            offset += part->vertex_count;
+        }
+
+        int open = 0;
+        for (const auto &edge : edges) {
+            auto opposite = edges.find(std::make_pair(edge.first.second, edge.first.first));
+            int matched = opposite == edges.end() ? 0 : opposite->second;
+            open += MAX(edge.second - matched, 0);
+        }
+        return open;
+    }
+} // Fixtures
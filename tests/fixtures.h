@@ -0,0 +1,71 @@
+#ifndef FIXTURES_H
+#define FIXTURES_H
+
+#include "core/slicer_core.h"
+
+#include <vector>
+
+/**
+ * Meshes for the tests to slice, along with what to check the halves with
+*/
+namespace Fixtures {
+    /**
+     * An indexed mesh with a normal and uv per vertex, wound clockwise from the outside
+     * the same way Godot's front faces are
+    */
+    struct Mesh {
+        std::vector<real_t> positions;
+        std::vector<real_t> normals;
+        std::vector<real_t> uvs;
+        std::vector<int> indices;
+
+        int add_vertex(Vector3 position, Vector3 normal, Vector2 uv);
+        void add_face(int a, int b, int c);
+
+        int face_count() const {
+            return indices.size() / 3;
+        }
+
+        SlicerCore::MeshView view() const;
+    };
+
+    /**
+     * An axis aligned box around the origin, with each side split into a grid of
+     * subdivisions by subdivisions quads
+    */
+    Mesh box(Vector3 size, int subdivisions);
+
+    /**
+     * A torus around the y axis with rings around the axis and sides around its tube. Ring 0
+     * starts on the z axis, so an even number of rings puts a ring of vertexes on x = 0
+    */
+    Mesh torus(real_t radius, real_t tube_radius, int rings, int sides);
+
+    /**
+     * An L shaped beam running along z, which doesn't come out convex on every cut
+    */
+    Mesh l_beam(real_t length);
+
+    /**
+     * A unit icosphere made of 20 * 4^subdivisions faces
+    */
+    Mesh icosphere(int subdivisions);
+
+    /**
+     * Volume enclosed by the faces of the view, which only means something if they're closed
+    */
+    double volume(const SlicerCore::MeshView &mesh);
+
+    /**
+     * The volume of a half, surface and cap together
+    */
+    double volume(const SlicerCore::HalfView &half);
+
+    /**
+     * How many edges of the half, surface and cap together, have no face on their other side
+     * going the opposite way. Vertexes are matched up by position, as the cap has its own
+    */
+    int open_edges(const SlicerCore::HalfView &half);
+} // Fixtures
+
+#endif // FIXTURES_H
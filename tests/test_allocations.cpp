@@ -0,0 +1,78 @@
+#include "counting_allocator.h"
+#include "fixtures.h"
+#include "test_harness.h"
+
+#include "intersector.h"
+#include "triangle_bvh.h"
+
+namespace {
+    /**
+     * Puts the split back the way it was before splitting, down to the vertexes it added to
+     * the surface, without giving up any of its memory
+    */
+    void rewind(Intersector::SplitResult &split, int vertex_count) {
+        split.surface.resize_vertices(vertex_count);
+        split.upper_indices.clear();
+        split.lower_indices.clear();
+        split.intersection_points.clear();
+        split.cut_segments.clear();
+    }
+} // namespace
+
+TEST_CASE(slicing_again_allocates_nothing) {
+    // Once the first slice has grown every buffer to fit, the same slice again has nothing to grow
+    Fixtures::Mesh mesh = Fixtures::torus(1, 0.3, 64, 24);
+    const real_t plane[4] = { 0, 1, 0, 0.05 };
+
+    SlicerCore::Slicer slicer;
+    CHECK(slicer.slice(mesh.view(), plane));
+
+    for (int i = 0; i < 3; i++) {
+        uint64_t before = CountingAllocator::allocations();
+        CHECK(slicer.slice(mesh.view(), plane));
+        CHECK(CountingAllocator::allocations() == before);
+    }
+}
+
+TEST_CASE(bvh_split_again_allocates_nothing) {
+    Fixtures::Mesh mesh = Fixtures::icosphere(4);
+    Plane plane(Vector3(1, 2, 3).normalized(), 0.1);
+
+    Intersector::SplitResult split;
+    SlicerCore::load_mesh(mesh.view(), split.surface);
+    int vertex_count = split.surface.vertex_count();
+
+    TriangleBVH bvh;
+    bvh.build(split.surface);
+
+    for (int specialized = 0; specialized < 2; specialized++) {
+        Intersector::split_surface_by_plane(plane, split, bvh, specialized);
+        CHECK(split.intersection_points.size() > 0);
+
+        for (int i = 0; i < 3; i++) {
+            rewind(split, vertex_count);
+            uint64_t before = CountingAllocator::allocations();
+            Intersector::split_surface_by_plane(plane, split, bvh, specialized);
+            CHECK(CountingAllocator::allocations() == before);
+        }
+
+        rewind(split, vertex_count);
+    }
+}
+
+TEST_CASE(split_again_allocates_nothing) {
+    Fixtures::Mesh mesh = Fixtures::l_beam(4);
+    Plane plane(Vector3(0, 1, 0.2).normalized(), -1);
+
+    Intersector::SplitResult split;
+    SlicerCore::load_mesh(mesh.view(), split.surface);
+    int vertex_count = split.surface.vertex_count();
+
+    Intersector::split_surface_by_plane(plane, split);
+    for (int i = 0; i < 3; i++) {
+        rewind(split, vertex_count);
+        uint64_t before = CountingAllocator::allocations();
+        Intersector::split_surface_by_plane(plane, split);
+        CHECK(CountingAllocator::allocations() == before);
+    }
+}
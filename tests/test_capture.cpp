@@ -0,0 +1,60 @@
+#include "fixtures.h"
+#include "test_harness.h"
+#include "utils/slice_capture.h"
+
+#include <cstdio>
+
+namespace {
+    MeshBuffer buffer_of(const Fixtures::Mesh &mesh) {
+        MeshBuffer buffer;
+        buffer.format = Mesh::ARRAY_FORMAT_NORMAL | Mesh::ARRAY_FORMAT_TEX_UV;
+
+        int count = mesh.positions.size() / 3;
+        buffer.resize_vertices(count);
+        for (int i = 0; i < count; i++) {
+            buffer.vertices[i] = Vector3(mesh.positions[i * 3], mesh.positions[i * 3 + 1], mesh.positions[i * 3 + 2]);
+            buffer.normals[i] = Vector3(mesh.normals[i * 3], mesh.normals[i * 3 + 1], mesh.normals[i * 3 + 2]);
+            buffer.uvs[i] = Vector2(mesh.uvs[i * 2], mesh.uvs[i * 2 + 1]);
+        }
+
+        for (uint32_t i = 0; i < mesh.indices.size(); i++) {
+            buffer.indices.push_back(mesh.indices[i]);
+        }
+        return buffer;
+    }
+} // namespace
+
+TEST_CASE(capture_tells_meshes_apart_by_every_stream) {
+    const char *path = "slicer_test_capture.bin";
+    MeshBuffer box = buffer_of(Fixtures::box(Vector3(1, 1, 1), 2));
+
+    // Same positions and faces, only the uvs are different
+    MeshBuffer remapped = box;
+    remapped.uvs[0] = Vector2(0.5, 0.5);
+
+    LocalVector<const MeshBuffer *> surfaces;
+    surfaces.push_back(&box);
+
+    SliceCapture::Writer writer;
+    CHECK(writer.open(path));
+    uint32_t first = writer.add_mesh(surfaces);
+    CHECK(writer.add_mesh(surfaces) == first);
+
+    surfaces[0] = &remapped;
+    uint32_t second = writer.add_mesh(surfaces);
+    CHECK(second != first);
+
+    // Both surfaces as one mesh isn't either of them
+    surfaces.push_back(&box);
+    CHECK(writer.add_mesh(surfaces) != second);
+    writer.close();
+
+    SliceCapture::Capture capture;
+    CHECK(SliceCapture::read(path, capture));
+    CHECK(capture.meshes.size() == 3);
+    if (capture.meshes.size() > second) {
+        CHECK(capture.meshes[second][0].uvs[0] == Vector2(0.5, 0.5));
+    }
+
+    remove(path);
+}
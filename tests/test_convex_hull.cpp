@@ -0,0 +1,71 @@
+#include "fixtures.h"
+#include "test_harness.h"
+#include "utils/convex_hull.h"
+
+#include <random>
+
+namespace {
+    LocalVector<Vector3> points_of(const Fixtures::Mesh &mesh, Vector3 offset) {
+        LocalVector<Vector3> points;
+        for (uint32_t i = 0; i < mesh.positions.size(); i += 3) {
+            points.push_back(Vector3(mesh.positions[i], mesh.positions[i + 1], mesh.positions[i + 2]) + offset);
+        }
+        return points;
+    }
+
+    int hull_size(const LocalVector<Vector3> &points) {
+        ConvexHull::Workspace workspace;
+        LocalVector<int> hull;
+        if (!ConvexHull::compute(points, workspace, hull)) {
+            return -1;
+        }
+        return hull.size();
+    }
+} // namespace
+
+TEST_CASE(hull_of_a_box_is_its_corners) {
+    // Every other vertex is on a side or an edge, and in the way of the ones that count
+    CHECK(hull_size(points_of(Fixtures::box(Vector3(2, 1, 3), 4), Vector3())) == 8);
+}
+
+TEST_CASE(hull_of_a_box_far_from_the_origin) {
+    CHECK(hull_size(points_of(Fixtures::box(Vector3(0.2, 0.1, 0.3), 3), Vector3(500, -200, 100))) == 8);
+}
+
+TEST_CASE(hull_of_a_sphere_is_all_of_it) {
+    LocalVector<Vector3> points = points_of(Fixtures::icosphere(3), Vector3());
+    int vertex_count = points.size();
+
+    // None of which inside it should make it in
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<real_t> coordinate(-1, 1);
+    std::uniform_real_distribution<real_t> radius(0, 0.95);
+    for (int i = 0; i < 2000; i++) {
+        Vector3 point(coordinate(rng), coordinate(rng), coordinate(rng));
+        points.push_back(point.normalized() * radius(rng));
+    }
+
+    ConvexHull::Workspace workspace;
+    LocalVector<int> hull;
+    CHECK(ConvexHull::compute(points, workspace, hull));
+    CHECK((int)hull.size() == vertex_count);
+    for (uint32_t i = 0; i < hull.size(); i++) {
+        CHECK(hull[i] < vertex_count);
+    }
+}
+
+TEST_CASE(hull_of_a_torus_skips_its_inner_side) {
+    // Half of the sides of the tube face the hole, and only the outer rim is left
+    Fixtures::Mesh torus = Fixtures::torus(1, 0.3, 32, 12);
+    int size = hull_size(points_of(torus, Vector3()));
+    CHECK(size > 0);
+    CHECK(size < (int)torus.positions.size() / 3 * 2 / 3);
+}
+
+TEST_CASE(hull_of_flat_points) {
+    LocalVector<Vector3> points;
+    for (int i = 0; i < 10; i++) {
+        points.push_back(Vector3(i % 3, 2, i / 3));
+    }
+    CHECK(hull_size(points) == -1);
+}
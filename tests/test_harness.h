@@ -0,0 +1,46 @@
+#ifndef TEST_HARNESS_H
+#define TEST_HARNESS_H
+
+#include <cmath>
+#include <vector>
+
+/**
+ * Just enough of a test framework to run the core's tests without pulling one in. Every
+ * TEST_CASE registers itself with the runner in test_main.cpp, and a failed CHECK marks
+ * the case as failed and carries on with the rest of it
+*/
+namespace Tests {
+    struct Case {
+        const char *name;
+        void (*run)();
+    };
+
+    std::vector<Case> &cases();
+
+    struct Registration {
+        Registration(const char *name, void (*run)()) {
+            cases().push_back({ name, run });
+        }
+    };
+
+    /**
+     * Reports a failed check of the case that's running
+    */
+    void fail(const char *file, int line, const char *expression);
+} // Tests
+
+#define TEST_CASE(name)                                                \
+    static void name();                                                \
+    static Tests::Registration name##_registration(#name, &name);      \
+    static void name()
+
+#define CHECK(condition)                                     \
+    do {                                                     \
+        if (!(condition)) {                                  \
+            Tests::fail(__FILE__, __LINE__, #condition);     \
+        }                                                    \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tolerance) CHECK(std::abs((a) - (b)) <= (tolerance))
+
+#endif // TEST_HARNESS_H
@@ -0,0 +1,53 @@
+// Runs the tests of the standalone slicing core, built along with it:
+//
+//   scons core=yes
+//   bin/slicer_tests [name ...]
+//
+// Only the cases whose names contain one of the given names get run, all of them otherwise.
+// Exits with 1 if any check failed.
+
+#include "test_harness.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace Tests {
+    int failed_checks = 0;
+
+    std::vector<Case> &cases() {
+        static std::vector<Case> registered;
+        return registered;
+    }
+
+    void fail(const char *file, int line, const char *expression) {
+        fprintf(stderr, "  %s:%d: CHECK(%s) failed\n", file, line, expression);
+        failed_checks++;
+    }
+} // Tests
+
+int main(int argc, char **argv) {
+    int run = 0;
+    int failed = 0;
+
+    for (const Tests::Case &test : Tests::cases()) {
+        bool wanted = argc == 1;
+        for (int i = 1; i < argc; i++) {
+            wanted = wanted || strstr(test.name, argv[i]) != nullptr;
+        }
+        if (!wanted) {
+            continue;
+        }
+
+        int failed_before = Tests::failed_checks;
+        test.run();
+        run++;
+
+        bool passed = Tests::failed_checks == failed_before;
+        failed += !passed;
+        printf("%s %s\n", passed ? "pass" : "FAIL", test.name);
+        fflush(stdout);
+    }
+
+    printf("%d of %d tests passed\n", run - failed, run);
+    return failed > 0 || run == 0;
+}
@@ -0,0 +1,65 @@
+#include "fixtures.h"
+#include "test_harness.h"
+#include "utils/mass_properties.h"
+
+namespace {
+    MassProperties mass_of(const Fixtures::Mesh &mesh, Vector3 offset) {
+        MassProperties mass;
+        for (int i = 0; i < mesh.face_count(); i++) {
+            Vector3 corners[3];
+            for (int j = 0; j < 3; j++) {
+                int idx = mesh.indices[i * 3 + j];
+                corners[j] = Vector3(mesh.positions[idx * 3], mesh.positions[idx * 3 + 1], mesh.positions[idx * 3 + 2]) + offset;
+            }
+            mass.add_face(corners[0], corners[1], corners[2]);
+        }
+
+        mass.finish();
+        return mass;
+    }
+
+    /**
+     * Checks the mass of a box of the given size centered on offset against the closed form
+    */
+    void check_box(Vector3 size, Vector3 offset, double tolerance) {
+        MassProperties mass = mass_of(Fixtures::box(size, 2), offset);
+
+        double volume = size.x * size.y * size.z;
+        CHECK_NEAR(mass.volume, volume, volume * tolerance);
+
+        real_t largest = MAX(size.x, MAX(size.y, size.z));
+        CHECK(mass.center_of_mass.distance_to(offset) <= largest * tolerance);
+
+        double xx = volume * (size.y * size.y + size.z * size.z) / 12;
+        double yy = volume * (size.x * size.x + size.z * size.z) / 12;
+        double zz = volume * (size.x * size.x + size.y * size.y) / 12;
+        CHECK_NEAR(mass.inertia[0][0], xx, xx * tolerance * 10);
+        CHECK_NEAR(mass.inertia[1][1], yy, yy * tolerance * 10);
+        CHECK_NEAR(mass.inertia[2][2], zz, zz * tolerance * 10);
+    }
+} // namespace
+
+TEST_CASE(mass_of_a_box) {
+    check_box(Vector3(2, 1, 3), Vector3(), 1e-5);
+}
+
+TEST_CASE(mass_of_a_millimetre_box) {
+    // Well under any fixed tolerance a volume could have
+    check_box(Vector3(0.002, 0.001, 0.003), Vector3(), 1e-5);
+}
+
+TEST_CASE(mass_of_a_box_far_from_the_origin) {
+    check_box(Vector3(0.2, 0.1, 0.3), Vector3(50, -20, 10), 1e-3);
+}
+
+TEST_CASE(mass_of_a_flat_surface) {
+    Fixtures::Mesh flat;
+    int a = flat.add_vertex(Vector3(0, 0, 0), Vector3(0, 1, 0), Vector2());
+    int b = flat.add_vertex(Vector3(1, 0, 0), Vector3(0, 1, 0), Vector2());
+    int c = flat.add_vertex(Vector3(0, 0, 1), Vector3(0, 1, 0), Vector2());
+    flat.add_face(a, b, c);
+    flat.add_face(a, c, b);
+    MassProperties mass = mass_of(flat, Vector3(3, 2, 1));
+    CHECK(mass.volume == 0);
+    CHECK(mass.center_of_mass == Vector3());
+}
@@ -0,0 +1,49 @@
+#include "counting_allocator.h"
+#include "fixtures.h"
+#include "test_harness.h"
+
+#include <cstdio>
+
+namespace {
+    // The most a slice may have on the heap at once, per triangle of the mesh sliced, on top of
+    // the mesh itself. The fixtures carry positions, normals and uvs and currently peak at
+    // 100 to 125 bytes per triangle, depending on how much of them the plane crosses
+    const double MAX_PEAK_BYTES_PER_TRIANGLE = 160;
+
+    /**
+     * Slices the mesh with a fresh slicer and checks its heap peak against the bound, along
+     * with how well MemoryTracker's estimate of it holds up
+    */
+    void check_memory(const char *name, const Fixtures::Mesh &mesh, const real_t plane[4]) {
+        uint64_t before = CountingAllocator::live_bytes();
+        CountingAllocator::reset_peak();
+
+        SlicerCore::Slicer slicer;
+        CHECK(slicer.slice(mesh.view(), plane));
+
+        uint64_t peak = CountingAllocator::peak_bytes() - before;
+        uint64_t held = CountingAllocator::live_bytes() - before;
+        double peak_per_triangle = double(peak) / mesh.face_count();
+        printf("  %s: %d triangles, peaked at %.1f bytes per triangle\n", name, mesh.face_count(), peak_per_triangle);
+        CHECK(peak_per_triangle <= MAX_PEAK_BYTES_PER_TRIANGLE);
+
+        // Every buffer of the standalone core tells its capacity, so the estimate of what the
+        // slicer holds has to come out exact. It can only miss what the slice freed before
+        // it was done, which shouldn't be much
+        LocalVector<uint64_t> watermarks;
+        MemoryTracker tracker(watermarks);
+        slicer.track_memory(tracker);
+        CHECK(tracker.bytes == held);
+        CHECK(tracker.bytes >= peak * 0.95);
+    }
+} // namespace
+
+TEST_CASE(peak_bytes_per_triangle) {
+    Vector3 normal = Vector3(1, 2, 3).normalized();
+    const real_t tilted[4] = { normal.x, normal.y, normal.z, 0.1 };
+    const real_t flat[4] = { 0, 1, 0, 0.05 };
+
+    check_memory("icosphere", Fixtures::icosphere(5), tilted);
+    check_memory("torus", Fixtures::torus(1, 0.3, 256, 64), flat);
+    check_memory("box", Fixtures::box(Vector3(2, 1, 3), 64), tilted);
+}
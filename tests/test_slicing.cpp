@@ -0,0 +1,112 @@
+#include "fixtures.h"
+#include "test_harness.h"
+
+namespace {
+    /**
+     * Slices the mesh and checks what every slice through a closed mesh has to hold to: both
+     * halves closed, and their volumes adding up to that of the mesh
+    */
+    void check_slice(const Fixtures::Mesh &mesh, const real_t plane[4]) {
+        SlicerCore::Slicer slicer;
+        CHECK(slicer.slice(mesh.view(), plane));
+
+        const SlicerCore::HalfView &upper = slicer.get_upper();
+        const SlicerCore::HalfView &lower = slicer.get_lower();
+        CHECK(upper.surface.index_count > 0);
+        CHECK(lower.surface.index_count > 0);
+        CHECK(upper.cap.index_count > 0);
+        CHECK(lower.cap.index_count > 0);
+
+        CHECK(Fixtures::open_edges(upper) == 0);
+        CHECK(Fixtures::open_edges(lower) == 0);
+
+        // Wound the same way as the mesh, each half encloses a part of it rather than turning
+        // inside out
+        double original = Fixtures::volume(mesh.view());
+        double upper_volume = Fixtures::volume(upper);
+        double lower_volume = Fixtures::volume(lower);
+        CHECK(upper_volume * original > 0);
+        CHECK(lower_volume * original > 0);
+        CHECK_NEAR(upper_volume + lower_volume, original, std::abs(original) * 1e-4);
+    }
+
+    void check_missed(const Fixtures::Mesh &mesh, const real_t plane[4]) {
+        SlicerCore::Slicer slicer;
+        CHECK(!slicer.slice(mesh.view(), plane));
+        CHECK(slicer.get_upper().surface.vertex_count == 0);
+        CHECK(slicer.get_upper().cap.vertex_count == 0);
+        CHECK(slicer.get_lower().surface.vertex_count == 0);
+        CHECK(slicer.get_lower().cap.vertex_count == 0);
+    }
+} // namespace
+
+TEST_CASE(box_through_center) {
+    const real_t plane[4] = { 0, 1, 0, 0 };
+    check_slice(Fixtures::box(Vector3(2, 1, 3), 4), plane);
+}
+
+TEST_CASE(box_at_an_angle) {
+    Vector3 normal = Vector3(1, 2, -0.5).normalized();
+    const real_t plane[4] = { normal.x, normal.y, normal.z, 0.2 };
+    check_slice(Fixtures::box(Vector3(2, 1, 3), 3), plane);
+}
+
+TEST_CASE(box_along_a_grid_line) {
+    // Right through a row of vertexes, where the plane leaves cut segments instead of points
+    const real_t plane[4] = { 1, 0, 0, 0 };
+    check_slice(Fixtures::box(Vector3(2, 2, 2), 4), plane);
+}
+
+TEST_CASE(torus_across_its_hole) {
+    // Two separate loops in the cap, one for each side of the ring
+    const real_t plane[4] = { 0, 0, 1, 0.1 };
+    check_slice(Fixtures::torus(1, 0.3, 32, 12), plane);
+}
+
+TEST_CASE(torus_along_its_middle) {
+    // A ring inside a ring, which the cap has to leave the hole of open
+    const real_t plane[4] = { 0, 1, 0, 0.05 };
+    check_slice(Fixtures::torus(1, 0.3, 32, 12), plane);
+}
+
+TEST_CASE(small_torus_across_its_hole) {
+    // Millimetres across, where loops of the cap are smaller than what a fixed tolerance
+    // would take for noise
+    const real_t plane[4] = { 0, 0, 1, 0.0003 };
+    check_slice(Fixtures::torus(0.003, 0.0009, 32, 12), plane);
+}
+
+TEST_CASE(torus_through_vertex_rings) {
+    const real_t plane[4] = { 1, 0, 0, 0 };
+    check_slice(Fixtures::torus(1, 0.3, 32, 12), plane);
+}
+
+TEST_CASE(l_beam_across) {
+    const real_t plane[4] = { 0, 0, 1, 0.3 };
+    check_slice(Fixtures::l_beam(4), plane);
+}
+
+TEST_CASE(l_beam_along_its_length) {
+    // Cuts both arms of the L, so the cap comes out as two separate pieces
+    Vector3 normal = Vector3(0, 1, 0.2).normalized();
+    const real_t plane[4] = { normal.x, normal.y, normal.z, -1 };
+    check_slice(Fixtures::l_beam(4), plane);
+}
+
+TEST_CASE(empty_mesh) {
+    const real_t plane[4] = { 0, 1, 0, 0 };
+    check_missed(Fixtures::Mesh(), plane);
+}
+
+TEST_CASE(plane_misses_mesh) {
+    const real_t plane[4] = { 0, 1, 0, 5 };
+    check_missed(Fixtures::box(Vector3(1, 1, 1), 2), plane);
+    check_missed(Fixtures::torus(1, 0.3, 16, 8), plane);
+}
+
+TEST_CASE(plane_grazes_a_corner) {
+    // Touching the box at just the one vertex leaves nothing to cut
+    Vector3 normal = Vector3(1, 1, 1).normalized();
+    const real_t plane[4] = { normal.x, normal.y, normal.z, normal.dot(Vector3(0.5, 0.5, 0.5)) };
+    check_missed(Fixtures::box(Vector3(1, 1, 1), 2), plane);
+}